@@ -0,0 +1,111 @@
+/*
+Title: Point - Plane
+File Name: Benchmark.cpp
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+Headless benchmarks which run without opening a window. This file holds what
+every benchmark shares and the scaling sweep. The others are grouped by what
+they measure in BenchmarkMotion, BenchmarkSpatial, BenchmarkWorlds,
+BenchmarkQueries and BenchmarkMemory.
+*/
+
+#include "Benchmark.h"
+
+double SecondsSince(BenchmarkClock::time_point start)
+{
+	return std::chrono::duration<double>(BenchmarkClock::now() - start).count();
+}
+
+void ForEachScene(const SweepSettings &settings, const ScenarioSettings &scenario, const std::function<void(Scene &scene)> &body)
+{
+	for (size_t i = 0; i < settings.pointCounts.size(); i++)
+	{
+		for (size_t j = 0; j < settings.planeCounts.size(); j++)
+		{
+			ScenarioSettings sceneSettings = scenario;
+			sceneSettings.numPoints = settings.pointCounts[i];
+			sceneSettings.numPlanes = settings.planeCounts[j];
+
+			Scene scene;
+			GenerateScene(sceneSettings, scene);
+			body(scene);
+		}
+	}
+}
+
+SceneTiming TimeScene(Scene &scene, int numSteps, float dt)
+{
+	SceneTiming timing;
+	timing.classifySeconds = 0.0;
+	timing.stepSeconds = 0.0;
+	timing.numCollisions = 0;
+	timing.numSteps = numSteps;
+
+	SideBuffer sides;
+
+	//Run once untimed so the side buffer is allocated and the points are in cache
+	ClassifyScene(scene, pointAcceptanceRange, sides, nullptr);
+
+	for (int i = 0; i < numSteps; i++)
+	{
+		BenchmarkClock::time_point start = BenchmarkClock::now();
+		StepScene(scene, dt);
+		timing.stepSeconds += SecondsSince(start);
+
+		start = BenchmarkClock::now();
+		timing.numCollisions += ClassifyScene(scene, pointAcceptanceRange, sides, nullptr);
+		timing.classifySeconds += SecondsSince(start);
+	}
+
+	return timing;
+}
+
+void PrintTimingHeader(std::ostream &out)
+{
+	out << "points,planes,steps,classify_ms_per_step,step_ms_per_step,ns_per_pair,collisions_per_step" << std::endl;
+}
+
+void PrintSceneTiming(std::ostream &out, const Scene &scene, const SceneTiming &timing)
+{
+	double pairs = (double)scene.points.Size() * scene.planes.size() * timing.numSteps;
+	int steps = std::max(timing.numSteps, 1);
+
+	out << scene.points.Size() << ","
+		<< scene.planes.size() << ","
+		<< timing.numSteps << ","
+		<< timing.classifySeconds * 1000.0 / steps << ","
+		<< timing.stepSeconds * 1000.0 / steps << ","
+		<< (pairs > 0.0 ? timing.classifySeconds * 1e9 / pairs : 0.0) << ","
+		<< timing.numCollisions / steps << std::endl;
+}
+
+void RunScalingSweep(const SweepSettings &settings, std::ostream &out)
+{
+	PrintTimingHeader(out);
+
+	ScenarioSettings scenario = settings.scenario;
+	ForEachScene(settings, scenario, [&](Scene &scene)
+	{
+		SceneTiming timing = TimeScene(scene, settings.numSteps, settings.dt);
+		PrintSceneTiming(out, scene, timing);
+	});
+}
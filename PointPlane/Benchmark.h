@@ -0,0 +1,343 @@
+/*
+Title: Point - Plane
+File Name: Benchmark.h
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+Headless benchmarks which run without opening a window. The scaling sweep
+generates scenes over a range of point and plane counts, steps each of them
+and reports how long the collision tests took as comma separated values,
+ready to be plotted as scaling curves.
+
+The translation sweep keeps the points still and slides every plane along its
+normal, the way the WASD/CTRL/SHIFT keys move the selected plane, and compares
+the linear batch test against a sorted projection index, and against kinetic
+side tracking which only visits the points each step sweeps over.
+*/
+
+#ifndef _BENCHMARK_H
+#define _BENCHMARK_H
+
+#include "KineticSides.h"
+#include "DirectionIndex.h"
+#include "PointTree.h"
+#include "PointPackets.h"
+#include "CrossingScheduler.h"
+#include "Trajectory.h"
+#include "Shapes.h"
+#include "ConvexHull.h"
+#include "NearestPoints.h"
+#include "World.h"
+#include "SharedQueries.h"
+#include "Numa.h"
+#include <chrono>
+#include <functional>
+
+//Settings for a scaling sweep
+struct SweepSettings
+{
+	std::vector<int> pointCounts;
+	std::vector<int> planeCounts;
+
+	//Describes every scene in the sweep, apart from the point and plane counts
+	ScenarioSettings scenario;
+
+	//Number of timed steps per scene
+	int numSteps;
+	float dt;
+
+	SweepSettings()
+	{
+		int points[] = { 1000, 10000, 100000, 1000000 };
+		int planes[] = { 1, 4, 16, 64 };
+		pointCounts.assign(points, points + 4);
+		planeCounts.assign(planes, planes + 4);
+		numSteps = 10;
+		dt = 1.0f / 60.0f;
+	}
+};
+
+//The clock every benchmark is timed with
+typedef std::chrono::high_resolution_clock BenchmarkClock;
+
+///
+//Returns the seconds since a time read from BenchmarkClock
+double SecondsSince(BenchmarkClock::time_point start);
+
+///
+//Generates a scene for every combination of point and plane counts in a sweep and benchmarks it
+//
+//Parameters:
+//	settings: The sweep, whose point and plane counts are used
+//	scenario: Describes every scene apart from its point and plane counts
+//	body: Times one scene and prints its results
+void ForEachScene(const SweepSettings &settings, const ScenarioSettings &scenario, const std::function<void(Scene &scene)> &body);
+
+//Timings from running a scene
+struct SceneTiming
+{
+	double classifySeconds;		//Total time spent classifying points
+	double stepSeconds;			//Total time spent moving points
+	long long numCollisions;	//Colliding pairs summed over all steps
+	int numSteps;
+};
+
+///
+//Steps a scene and classifies it against its planes, timing both
+//
+//Parameters:
+//	scene: The scene to run
+//	numSteps: How many steps to run
+//	dt: The timestep in seconds
+//
+//Returns:
+//	The timings of the run
+SceneTiming TimeScene(Scene &scene, int numSteps, float dt);
+
+///
+//Prints the column names written by PrintSceneTiming
+void PrintTimingHeader(std::ostream &out);
+
+///
+//Prints one line of timings for a scene
+void PrintSceneTiming(std::ostream &out, const Scene &scene, const SceneTiming &timing);
+
+///
+//Runs every combination of point and plane counts and prints a line of timings for each
+//
+//Parameters:
+//	settings: The sweep to run
+//	out: Where the comma separated results are written
+void RunScalingSweep(const SweepSettings &settings, std::ostream &out);
+
+///
+//Slides the planes of each scene along their normals and times finding the colliding
+//points with the batch kernel, with a projection index and with kinetic side tracking
+//
+//Parameters:
+//	settings: The sweep to run. The scenario's motion is ignored, the points never move.
+//	stepDistance: How far the planes move each step
+//	out: Where the comma separated results are written
+void RunTranslationSweep(const SweepSettings &settings, float stepDistance, std::ostream &out);
+
+///
+//Rotates the planes of each scene about their centers and times finding the colliding
+//points with the batch kernel and with a direction quantized projection index
+//
+//Parameters:
+//	settings: The sweep to run. The scenario's motion is ignored, the points never move.
+//	angleStep: How far the planes rotate each step, in radians
+//	subdivisions: Geodesic sphere subdivisions used to build the direction index
+//	out: Where the comma separated results are written
+void RunRotationSweep(const SweepSettings &settings, float angleStep, int subdivisions, std::ostream &out);
+
+///
+//Moves the planes of each scene to random orientations and distances every step and times
+//finding the colliding points with the batch kernel and with a point tree
+//
+//Parameters:
+//	settings: The sweep to run. The scenario's motion is ignored, the points never move.
+//	pool: Threads used to build the tree and for batched queries
+//	out: Where the comma separated results are written
+void RunTreeSweep(const SweepSettings &settings, ThreadPool* pool, std::ostream &out);
+
+///
+//Splits the points of each scene into packets of nearby points and times classifying
+//them with the batch kernel and with packet bounds tested first
+//
+//Parameters:
+//	settings: The sweep to run. Packet bounds are refit every step while the points move.
+//	packetSize: Points per packet
+//	out: Where the comma separated results are written
+void RunPacketSweep(const SweepSettings &settings, int packetSize, std::ostream &out);
+
+///
+//Drifts the points of each scene and times stepping and classifying every frame against
+//jumping from one predicted crossing to the next
+//
+//Parameters:
+//	settings: The sweep to run. Points always drift and planes are always infinite.
+//	out: Where the comma separated results are written
+void RunEventSweep(const SweepSettings &settings, std::ostream &out);
+
+///
+//Generates random walk trajectories holding each point count's worth of samples and times
+//finding their crossings with the scene's planes on one thread and across a pool
+//
+//Parameters:
+//	settings: The sweep to run. Each point count is the total number of samples.
+//	samplesPerTrajectory: Length of each trajectory
+//	pool: Threads to split the trajectories between
+//	out: Where the comma separated results are written
+void RunTrajectorySweep(const SweepSettings &settings, int samplesPerTrajectory, ThreadPool* pool, std::ostream &out);
+
+///
+//Places shapes at the points of each scene and times classifying them against the planes
+//
+//Parameters:
+//	settings: The sweep to run
+//	types: The shape types to time
+//	out: Where the comma separated results are written
+void RunShapeSweep(const SweepSettings &settings, const std::vector<ShapeType> &types, std::ostream &out);
+
+///
+//Tests ellipsoid hulls of increasing vertex count against a plane which either rotates
+//smoothly or jumps to a random orientation, timing full scans against hill climbing
+//
+//Parameters:
+//	numQueries: Plane queries per hull
+//	angleStep: How far the smoothly rotating plane turns between queries, in radians
+//	seed: Seed for the random orientations
+//	out: Where the comma separated results are written
+void RunHullSweep(int numQueries, float angleStep, unsigned int seed, std::ostream &out);
+
+///
+//Finds the k points nearest to each plane of each scene, timing a full sort of every
+//distance against bounded heaps on one thread and across a pool
+//
+//Parameters:
+//	settings: The sweep to run
+//	k: How many points to find for each plane
+//	pool: Threads to split the points between
+//	out: Where the comma separated results are written
+void RunNearestSweep(const SweepSettings &settings, int k, ThreadPool* pool, std::ostream &out);
+
+///
+//Steps many independent worlds together on one pool, feeding each scripted input,
+//and reports how long every world's steps took and how much memory it holds
+//
+//Overview:
+//	Active world i owns a scene of (1 + i % 4) times the scenario's points, so the
+//	worlds are uneven and the pool has to balance them. Idle worlds are created
+//	but never stepped, the way a server holds sessions with no one connected.
+//
+//Parameters:
+//	settings: The scenario of the active worlds' scenes
+//	numWorlds: The number of active worlds
+//	numIdleWorlds: The number of worlds which are only held in memory
+//	numFrames: How many times every active world is stepped
+//	pool: The pool shared by every world
+//	out: Where the comma separated results are written
+void RunWorldSweep(const SweepSettings &settings, int numWorlds, int numIdleWorlds, int numFrames, ThreadPool* pool, std::ostream &out);
+
+///
+//Sends every scene to a query server in small queries, all sent before any answer is read,
+//and checks the answers against classifying the points locally
+//
+//Parameters:
+//	settings: The sweep to run
+//	socketPath: The file name of the server's socket
+//	queryPoints: The number of points in each query
+//	out: Where the comma separated results are written
+//
+//Returns:
+//	true if every scene was answered, false if the server could not be reached
+bool RunQuerySweep(const SweepSettings &settings, const std::string &socketPath, int queryPoints, std::ostream &out);
+
+///
+//Same as RunQuerySweep, but through a shared memory query server. The points are written
+//straight into the shared region and the answers are read from it where the server left them.
+//
+//Parameters:
+//	settings: The sweep to run
+//	regionName: The name of the server's shared memory region
+//	queryPoints: The number of points in each query
+//	out: Where the comma separated results are written
+//
+//Returns:
+//	true if every scene was answered, false if the server could not be reached
+bool RunSharedQuerySweep(const SweepSettings &settings, const std::string &regionName, int queryPoints, std::ostream &out);
+
+///
+//Classifies the points with every NUMA node working on a slice held in its own memory,
+//against one unpinned pool reading the arrays as they were generated, and reports each node
+//
+//Overview:
+//	The points stay still, so only the classification is timed. The flat pool is timed on
+//	each node's slice in turn, and the NUMA time of a node is how long its own threads took
+//	while every node worked at once. The "all" row compares the totals.
+//
+//Parameters:
+//	settings: The sweep to run
+//	pool: The flat pool to compare against
+//	out: Where the comma separated results are written
+void RunNumaSweep(const SweepSettings &settings, ThreadPool* pool, std::ostream &out);
+
+///
+//Classifies the points with the large arrays on ordinary, transparent huge and explicit
+//huge pages in turn, and reports the time and data TLB misses of each
+//
+//Overview:
+//	Each mode times a stream through every point, and a scatter which writes the sides
+//	in the order of a projection index, jumping around the result array. The TLB misses
+//	are per thousand points tested, or -1 where the system can't count them. huge_mb
+//	is how much of the arrays the system actually placed on huge pages.
+//
+//Parameters:
+//	settings: The sweep to run
+//	out: Where the comma separated results are written
+void RunPageSweep(const SweepSettings &settings, std::ostream &out);
+
+///
+//Classifies the points with the cached and the streaming kernel, and reports how long a
+//pass over 1MB of other data takes before and after each classification
+//
+//Overview:
+//	The pass over the other data stands in for the rest of the frame. hot_warm_us is the
+//	pass with that data fully cached, and hot_after_us the pass right after classifying,
+//	so the difference is what the classification pushed out of the caches.
+//
+//Parameters:
+//	settings: The sweep to run
+//	out: Where the comma separated results are written
+void RunStreamingSweep(const SweepSettings &settings, std::ostream &out);
+
+///
+//Gives the points and planes collision layers and compares testing every pair against
+//skipping the pairs whose layers don't interact, linearly, in packets and in a point tree
+//
+//Overview:
+//	The scene's --layers setting is used, or 8 layers if it has none. The packets are
+//	built over the points in the order they were generated, which keeps each layer in
+//	one run. results_match is 1 when every filtered test agrees with the unfiltered
+//	test on the pairs it didn't skip, and skips exactly the pairs it should.
+//
+//Parameters:
+//	settings: The sweep to run
+//	out: Where the comma separated results are written
+void RunLayerSweep(const SweepSettings &settings, std::ostream &out);
+
+///
+//Steps two worlds over the same scene, one testing every pair every step and one
+//reusing the cached results of pairs which haven't moved, and compares them
+//
+//Overview:
+//	The first plane slides along its normal every step and the others stay where they
+//	are, so with still points only the first plane's pairs change. results_match is 1
+//	when both worlds classified every pair the same way on every step.
+//
+//Parameters:
+//	settings: The sweep to run
+//	pool: Splits each world's planes between threads
+//	out: Where the comma separated results are written
+void RunPairCacheSweep(const SweepSettings &settings, ThreadPool* pool, std::ostream &out);
+
+#endif //_BENCHMARK_H
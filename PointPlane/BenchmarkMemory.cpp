@@ -0,0 +1,276 @@
+/*
+Title: Point - Plane
+File Name: BenchmarkMemory.cpp
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+Benchmarks of where the points live in memory: NUMA nodes, huge pages, and
+cached against streaming classification.
+*/
+
+#include "Benchmark.h"
+
+void RunNumaSweep(const SweepSettings &settings, ThreadPool* pool, std::ostream &out)
+{
+	std::vector<NumaNode> nodes = GetNumaNodes();
+	out << "points,planes,node,cpus,node_points,flat_ms,numa_ms,flat_mpoints_per_s,numa_mpoints_per_s,results_match" << std::endl;
+
+	ScenarioSettings scenario = settings.scenario;
+	ForEachScene(settings, scenario, [&](Scene &scene)
+	{
+		int numPoints = (int)scene.points.Size();
+
+		//The flat pool reads the scene's own arrays, wherever the main thread's writes put them
+		std::vector<signed char> flatSides(numPoints);
+		NumaPointSet numaPoints;
+		numaPoints.Build(nodes, scene.points);
+
+		size_t numPartitions = numaPoints.partitions.size();
+		std::vector<double> flatSeconds(numPartitions, 0.0);
+		std::vector<double> numaSeconds(numPartitions, 0.0);
+		std::vector<bool> match(numPartitions, true);
+		double flatTotal = 0.0;
+		double numaTotal = 0.0;
+
+		for (int step = 0; step < settings.numSteps; step++)
+		{
+			for (size_t p = 0; p < scene.planes.size(); p++)
+			{
+				const WorldPlane &plane = scene.planes[p];
+
+				//Time the flat pool on each node's slice in turn, so the slices can be compared
+				for (size_t n = 0; n < numPartitions; n++)
+				{
+					const NumaPartition &partition = *numaPoints.partitions[n];
+					BenchmarkClock::time_point start = BenchmarkClock::now();
+					ParallelRanges(pool, partition.count, 1 << 16, [&](int begin, int end)
+					{
+						begin += partition.begin;
+						end += partition.begin;
+						ClassifyPoints(plane, &scene.points.x[begin], &scene.points.y[begin], &scene.points.z[begin], end - begin, pointAcceptanceRange, &flatSides[begin]);
+					});
+					double seconds = SecondsSince(start);
+					flatSeconds[n] += seconds;
+					flatTotal += seconds;
+				}
+
+				BenchmarkClock::time_point start = BenchmarkClock::now();
+				numaPoints.Classify(plane, pointAcceptanceRange);
+				numaTotal += SecondsSince(start);
+
+				for (size_t n = 0; n < numPartitions; n++)
+				{
+					const NumaPartition &partition = *numaPoints.partitions[n];
+					numaSeconds[n] += partition.lastSeconds;
+					if (match[n])
+						match[n] = std::equal(partition.sides, partition.sides + partition.count, flatSides.begin() + partition.begin);
+				}
+			}
+		}
+
+		double numTests = (double)scene.planes.size() * settings.numSteps;
+		bool allMatch = true;
+		int totalCpus = 0;
+		for (size_t n = 0; n < numPartitions; n++)
+		{
+			const NumaPartition &partition = *numaPoints.partitions[n];
+			double points = (double)partition.count * numTests;
+			allMatch = allMatch && match[n];
+			totalCpus += (int)partition.node.cpus.size();
+
+			out << numPoints << ","
+				<< scene.planes.size() << ","
+				<< partition.node.id << ","
+				<< partition.node.cpus.size() << ","
+				<< partition.count << ","
+				<< flatSeconds[n] * 1000.0 << ","
+				<< numaSeconds[n] * 1000.0 << ","
+				<< (flatSeconds[n] > 0.0 ? points / flatSeconds[n] / 1e6 : 0.0) << ","
+				<< (numaSeconds[n] > 0.0 ? points / numaSeconds[n] / 1e6 : 0.0) << ","
+				<< (match[n] ? 1 : 0) << std::endl;
+		}
+
+		//Every node together, where the NUMA time is the wall time with all nodes working at once
+		double points = (double)numPoints * numTests;
+		out << numPoints << ","
+			<< scene.planes.size() << ","
+			<< "all,"
+			<< totalCpus << ","
+			<< numPoints << ","
+			<< flatTotal * 1000.0 << ","
+			<< numaTotal * 1000.0 << ","
+			<< (flatTotal > 0.0 ? points / flatTotal / 1e6 : 0.0) << ","
+			<< (numaTotal > 0.0 ? points / numaTotal / 1e6 : 0.0) << ","
+			<< (allMatch ? 1 : 0) << std::endl;
+	});
+}
+
+void RunPageSweep(const SweepSettings &settings, std::ostream &out)
+{
+	LargePageMode modes[] = { PAGES_NORMAL, PAGES_TRANSPARENT, PAGES_EXPLICIT };
+	LargePageMode startingMode = GetLargePages();
+
+	TlbMissCounter tlbMisses;
+	if (!tlbMisses.Open())
+		std::cout << "Can't count TLB misses here, they are reported as -1" << std::endl;
+
+	out << "pages,points,planes,buffer_mb,huge_mb,stream_ms,stream_tlb_misses_per_kpoint,scatter_ms,scatter_tlb_misses_per_kpoint" << std::endl;
+
+	for (size_t i = 0; i < settings.pointCounts.size(); i++)
+	{
+		for (size_t j = 0; j < settings.planeCounts.size(); j++)
+		{
+			for (int m = 0; m < 3; m++)
+			{
+				SetLargePages(modes[m]);
+
+				ScenarioSettings scenario = settings.scenario;
+				scenario.numPoints = settings.pointCounts[i];
+				scenario.numPlanes = settings.planeCounts[j];
+
+				Scene scene;
+				GenerateScene(scenario, scene);
+				int numPoints = (int)scene.points.Size();
+				if (scene.planes.empty()) continue;
+
+				ProjectionIndex index;
+				index.Build(scene.points, scene.planes[0].normal);
+
+				//Run once untimed so every page has been touched
+				SideBuffer sides;
+				ClassifyScene(scene, pointAcceptanceRange, sides, nullptr);
+
+				//Streaming reads every point in order
+				tlbMisses.Start();
+				BenchmarkClock::time_point start = BenchmarkClock::now();
+				for (int step = 0; step < settings.numSteps; step++)
+					ClassifyScene(scene, pointAcceptanceRange, sides, nullptr);
+				double streamSeconds = SecondsSince(start);
+				long long streamMisses = tlbMisses.Stop();
+
+				//Writing sides in sorted order jumps all over the result array,
+				//the access pattern which suffers most from small pages
+				tlbMisses.Start();
+				start = BenchmarkClock::now();
+				for (int step = 0; step < settings.numSteps; step++)
+				{
+					for (size_t p = 0; p < scene.planes.size(); p++)
+					{
+						int first = 0;
+						int last = 0;
+						index.BandRange(scene.planes[p].distance, pointAcceptanceRange, first, last);
+						signed char* planeSides = &sides[p * numPoints];
+						for (int n = 0; n < numPoints; n++)
+							planeSides[index.order[n]] = (signed char)ProjectionIndex::SideAt(n, first, last);
+					}
+				}
+				double scatterSeconds = SecondsSince(start);
+				long long scatterMisses = tlbMisses.Stop();
+
+				size_t bufferBytes = 3 * numPoints * sizeof(float) + sides.size() + numPoints * (sizeof(float) + sizeof(int));
+				size_t hugeBytes = HugePageBytes(scene.points.x.data()) + HugePageBytes(scene.points.y.data()) + HugePageBytes(scene.points.z.data())
+					+ HugePageBytes(sides.data()) + HugePageBytes(index.projections.data()) + HugePageBytes(index.order.data());
+
+				double kilopoints = (double)numPoints * scene.planes.size() * settings.numSteps / 1000.0;
+				out << LargePagesName(modes[m]) << ","
+					<< numPoints << ","
+					<< scene.planes.size() << ","
+					<< bufferBytes / (1024.0 * 1024.0) << ","
+					<< hugeBytes / (1024.0 * 1024.0) << ","
+					<< streamSeconds * 1000.0 << ","
+					<< (streamMisses >= 0 ? streamMisses / kilopoints : -1.0) << ","
+					<< scatterSeconds * 1000.0 << ","
+					<< (scatterMisses >= 0 ? scatterMisses / kilopoints : -1.0) << std::endl;
+			}
+		}
+	}
+
+	SetLargePages(startingMode);
+}
+
+void RunStreamingSweep(const SweepSettings &settings, std::ostream &out)
+{
+	ClassifyKernel kernels[] = { KERNEL_CACHED, KERNEL_STREAMING };
+	const char* kernelNames[] = { "cached", "streaming" };
+	ClassifyKernel startingKernel = GetClassifyKernel();
+
+	//Stands in for the data the rest of the frame works on, small enough to stay in the caches
+	std::vector<float> hotData((1 << 20) / sizeof(float), 1.0f);
+	float hotSum = 0.0f;
+	auto readHotData = [&]()
+	{
+		BenchmarkClock::time_point start = BenchmarkClock::now();
+		for (size_t n = 0; n < hotData.size(); n += 16)
+			hotSum += hotData[n];
+		return SecondsSince(start);
+	};
+
+	out << "kernel,points,planes,steps,classify_ms_per_step,mpoints_per_s,hot_warm_us,hot_after_us,results_match" << std::endl;
+
+	ScenarioSettings scenario = settings.scenario;
+	ForEachScene(settings, scenario, [&](Scene &scene)
+	{
+		SideBuffer expected;
+		SetClassifyKernel(KERNEL_CACHED);
+		ClassifyScene(scene, pointAcceptanceRange, expected, nullptr);
+
+		for (int k = 0; k < 2; k++)
+		{
+			SetClassifyKernel(kernels[k]);
+			SideBuffer sides;
+			ClassifyScene(scene, pointAcceptanceRange, sides, nullptr);
+
+			double classifySeconds = 0.0;
+			double warmSeconds = 0.0;
+			double afterSeconds = 0.0;
+			for (int step = 0; step < settings.numSteps; step++)
+			{
+				//Read twice, so the second read shows the data fully cached
+				readHotData();
+				warmSeconds += readHotData();
+
+				BenchmarkClock::time_point start = BenchmarkClock::now();
+				ClassifyScene(scene, pointAcceptanceRange, sides, nullptr);
+				classifySeconds += SecondsSince(start);
+
+				//How much of the data the classification pushed out of the caches
+				afterSeconds += readHotData();
+			}
+
+			int steps = std::max(settings.numSteps, 1);
+			double points = (double)scene.points.Size() * scene.planes.size() * settings.numSteps;
+			out << kernelNames[k] << ","
+				<< scene.points.Size() << ","
+				<< scene.planes.size() << ","
+				<< settings.numSteps << ","
+				<< classifySeconds * 1000.0 / steps << ","
+				<< (classifySeconds > 0.0 ? points / classifySeconds / 1e6 : 0.0) << ","
+				<< warmSeconds * 1e6 / steps << ","
+				<< afterSeconds * 1e6 / steps << ","
+				<< (sides == expected ? 1 : 0) << std::endl;
+		}
+	});
+
+	SetClassifyKernel(startingKernel);
+
+	//Keeps the reads of the hot data from being optimized away
+	if (hotSum < 0.0f) out << hotSum << std::endl;
+}
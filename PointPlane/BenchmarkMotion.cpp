@@ -0,0 +1,289 @@
+/*
+Title: Point - Plane
+File Name: BenchmarkMotion.cpp
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+Benchmarks of planes and points in motion: planes sliding and spinning through
+still points, points drifting through still planes and whole trajectories.
+*/
+
+#include "Benchmark.h"
+#include <cstring>
+
+//Times translating planes through one scene and prints a line of results
+static void TimeTranslation(const Scene &scene, int numSteps, float stepDistance, std::ostream &out)
+{
+	int numPoints = (int)scene.points.Size();
+	double buildSeconds = 0.0;
+	double linearSeconds = 0.0;
+	double indexedSeconds = 0.0;
+	double kineticSeconds = 0.0;
+	long long linearHits = 0;
+	long long indexedHits = 0;
+	long long sideChanges = 0;
+
+	ProjectionIndex index;
+	KineticSides kinetic;
+	std::vector<int> hits;
+	std::vector<SideEvent> events;
+
+	for (size_t i = 0; i < scene.planes.size(); i++)
+	{
+		WorldPlane plane = scene.planes[i];
+
+		BenchmarkClock::time_point start = BenchmarkClock::now();
+		index.Build(scene.points, plane.normal);
+		buildSeconds += SecondsSince(start);
+
+		//Start half way back so the plane sweeps through the middle of the points
+		plane.distance -= stepDistance * numSteps * 0.5f;
+		kinetic.Reset(index, plane.distance, pointAcceptanceRange);
+
+		for (int step = 0; step < numSteps; step++)
+		{
+			plane.distance += stepDistance;
+
+			start = BenchmarkClock::now();
+			linearHits += ClassifyPoints(plane, scene.points.x.data(), scene.points.y.data(), scene.points.z.data(), numPoints, pointAcceptanceRange, nullptr);
+			linearSeconds += SecondsSince(start);
+
+			start = BenchmarkClock::now();
+			indexedHits += index.QueryBand(plane, pointAcceptanceRange, hits);
+			indexedSeconds += SecondsSince(start);
+
+			start = BenchmarkClock::now();
+			sideChanges += kinetic.MoveTo(plane.distance, events);
+			kineticSeconds += SecondsSince(start);
+		}
+	}
+
+	int steps = std::max(numSteps, 1);
+	out << numPoints << ","
+		<< scene.planes.size() << ","
+		<< numSteps << ","
+		<< buildSeconds * 1000.0 << ","
+		<< linearSeconds * 1000.0 / steps << ","
+		<< indexedSeconds * 1000.0 / steps << ","
+		<< kineticSeconds * 1000.0 / steps << ","
+		<< linearHits / steps << ","
+		<< indexedHits / steps << ","
+		<< sideChanges / steps << std::endl;
+}
+
+void RunTranslationSweep(const SweepSettings &settings, float stepDistance, std::ostream &out)
+{
+	out << "points,planes,steps,index_build_ms,linear_ms_per_step,indexed_ms_per_step,kinetic_ms_per_step,linear_hits_per_step,indexed_hits_per_step,side_changes_per_step" << std::endl;
+
+	ScenarioSettings scenario = settings.scenario;
+	scenario.motion = MOTION_STATIC;
+	scenario.finitePlanes = false;
+	ForEachScene(settings, scenario, [&](Scene &scene)
+	{
+		TimeTranslation(scene, settings.numSteps, stepDistance, out);
+	});
+}
+
+//Times rotating planes through one scene and prints a line of results
+static void TimeRotation(const Scene &scene, int numSteps, float angleStep, int subdivisions, std::ostream &out)
+{
+	int numPoints = (int)scene.points.Size();
+	double linearSeconds = 0.0;
+	double indexedSeconds = 0.0;
+	long long linearHits = 0;
+	long long indexedHits = 0;
+	long long refined = 0;
+
+	//One index serves every plane, whatever its orientation
+	DirectionIndex index;
+	BenchmarkClock::time_point start = BenchmarkClock::now();
+	index.Build(scene.points, subdivisions);
+	double buildSeconds = SecondsSince(start);
+
+	std::vector<int> hits;
+
+	for (size_t i = 0; i < scene.planes.size(); i++)
+	{
+		WorldPlane plane = scene.planes[i];
+
+		//Spin about an axis lying in the plane, as dragging the mouse does
+		glm::mat3 rotation = glm::mat3(glm::rotate(glm::mat4(1.0f), angleStep, plane.tangent));
+
+		for (int step = 0; step < numSteps; step++)
+		{
+			plane.normal = rotation * plane.normal;
+			plane.distance = glm::dot(plane.normal, plane.center);
+
+			start = BenchmarkClock::now();
+			linearHits += ClassifyPoints(plane, scene.points.x.data(), scene.points.y.data(), scene.points.z.data(), numPoints, pointAcceptanceRange, nullptr);
+			linearSeconds += SecondsSince(start);
+
+			int numRefined = 0;
+			start = BenchmarkClock::now();
+			indexedHits += index.QueryBand(scene.points, plane, pointAcceptanceRange, hits, &numRefined);
+			indexedSeconds += SecondsSince(start);
+			refined += numRefined;
+		}
+	}
+
+	int steps = std::max(numSteps, 1);
+	out << numPoints << ","
+		<< scene.planes.size() << ","
+		<< numSteps << ","
+		<< index.orderings.size() << ","
+		<< buildSeconds * 1000.0 << ","
+		<< linearSeconds * 1000.0 / steps << ","
+		<< indexedSeconds * 1000.0 / steps << ","
+		<< linearHits / steps << ","
+		<< indexedHits / steps << ","
+		<< refined / steps << std::endl;
+}
+
+void RunRotationSweep(const SweepSettings &settings, float angleStep, int subdivisions, std::ostream &out)
+{
+	out << "points,planes,steps,directions,index_build_ms,linear_ms_per_step,indexed_ms_per_step,linear_hits_per_step,indexed_hits_per_step,refined_per_step" << std::endl;
+
+	ScenarioSettings scenario = settings.scenario;
+	scenario.motion = MOTION_STATIC;
+	scenario.finitePlanes = false;
+	ForEachScene(settings, scenario, [&](Scene &scene)
+	{
+		TimeRotation(scene, settings.numSteps, angleStep, subdivisions, out);
+	});
+}
+
+//Times event driven simulation of one scene and prints a line of results
+static void TimeEvents(Scene &scene, int numSteps, float dt, std::ostream &out)
+{
+	int numPoints = (int)scene.points.Size();
+	int numPlanes = (int)scene.planes.size();
+	double frameSeconds = 0.0;
+	double eventSeconds = 0.0;
+	long long frameHits = 0;
+	long long eventHits = 0;
+	long long numEvents = 0;
+
+	CrossingScheduler scheduler;
+	BenchmarkClock::time_point start = BenchmarkClock::now();
+	if (!scheduler.Reset(scene, pointAcceptanceRange)) return;
+	double resetSeconds = SecondsSince(start);
+
+	SideBuffer sides;
+
+	for (int step = 0; step < numSteps; step++)
+	{
+		start = BenchmarkClock::now();
+		StepScene(scene, dt);
+		frameHits += ClassifyScene(scene, pointAcceptanceRange, sides, nullptr);
+		frameSeconds += SecondsSince(start);
+
+		start = BenchmarkClock::now();
+		numEvents += scheduler.AdvanceTo((step + 1) * (double)dt, nullptr);
+		eventHits += scheduler.numColliding;
+		eventSeconds += SecondsSince(start);
+	}
+
+	//Check the tracked sides against the positions the scheduler ended up with.
+	//StepScene adds up its steps in a different order, so its points drift apart slightly.
+	PointSet positions;
+	scheduler.CurrentPositions(positions);
+	std::vector<signed char> planeSides(numPoints);
+	long long mismatches = 0;
+	for (int j = 0; j < numPlanes; j++)
+	{
+		ClassifyPoints(scene.planes[j], positions.x.data(), positions.y.data(), positions.z.data(), numPoints, pointAcceptanceRange, planeSides.data());
+		for (int i = 0; i < numPoints; i++)
+			mismatches += planeSides[i] != scheduler.SideOf(i, j);
+	}
+
+	int steps = std::max(numSteps, 1);
+	out << numPoints << ","
+		<< numPlanes << ","
+		<< numSteps << ","
+		<< resetSeconds * 1000.0 << ","
+		<< frameSeconds * 1000.0 / steps << ","
+		<< eventSeconds * 1000.0 / steps << ","
+		<< frameHits / steps << ","
+		<< eventHits / steps << ","
+		<< numEvents / steps << ","
+		<< mismatches << std::endl;
+}
+
+void RunEventSweep(const SweepSettings &settings, std::ostream &out)
+{
+	out << "points,planes,steps,schedule_ms,frame_ms_per_step,event_ms_per_step,frame_hits_per_step,event_hits_per_step,events_per_step,final_side_mismatches" << std::endl;
+
+	ScenarioSettings scenario = settings.scenario;
+	scenario.motion = MOTION_DRIFT;
+	scenario.finitePlanes = false;
+	ForEachScene(settings, scenario, [&](Scene &scene)
+	{
+		TimeEvents(scene, settings.numSteps, settings.dt, out);
+	});
+}
+
+void RunTrajectorySweep(const SweepSettings &settings, int samplesPerTrajectory, ThreadPool* pool, std::ostream &out)
+{
+	out << "samples,trajectories,planes,threads,serial_ms,parallel_ms,crossings,results_match" << std::endl;
+
+	samplesPerTrajectory = std::max(samplesPerTrajectory, 2);
+	std::vector<Trajectory> paths;
+	std::vector<TrajectoryCrossing> serialCrossings;
+	std::vector<TrajectoryCrossing> parallelCrossings;
+
+	for (size_t i = 0; i < settings.pointCounts.size(); i++)
+	{
+		int numPaths = std::max(settings.pointCounts[i] / samplesPerTrajectory, 1);
+		GenerateTrajectories(numPaths, samplesPerTrajectory, settings.scenario.extent, settings.dt, settings.scenario.seed, paths);
+
+		for (size_t j = 0; j < settings.planeCounts.size(); j++)
+		{
+			//Only the planes of the scene are needed
+			ScenarioSettings scenario = settings.scenario;
+			scenario.numPoints = 0;
+			scenario.numPlanes = settings.planeCounts[j];
+
+			Scene scene;
+			GenerateScene(scenario, scene);
+
+			BenchmarkClock::time_point start = BenchmarkClock::now();
+			FindAllCrossings(scene.planes, paths, pointAcceptanceRange, serialCrossings, nullptr);
+			double serialSeconds = SecondsSince(start);
+
+			start = BenchmarkClock::now();
+			FindAllCrossings(scene.planes, paths, pointAcceptanceRange, parallelCrossings, pool);
+			double parallelSeconds = SecondsSince(start);
+
+			bool match = serialCrossings.size() == parallelCrossings.size();
+			for (size_t k = 0; match && k < serialCrossings.size(); k++)
+				match = memcmp(&serialCrossings[k], &parallelCrossings[k], sizeof(TrajectoryCrossing)) == 0;
+
+			out << (long long)numPaths * samplesPerTrajectory << ","
+				<< numPaths << ","
+				<< scene.planes.size() << ","
+				<< (pool ? pool->NumThreads() : 1) << ","
+				<< serialSeconds * 1000.0 << ","
+				<< parallelSeconds * 1000.0 << ","
+				<< serialCrossings.size() << ","
+				<< (match ? 1 : 0) << std::endl;
+		}
+	}
+}
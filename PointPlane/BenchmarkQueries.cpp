@@ -0,0 +1,206 @@
+/*
+Title: Point - Plane
+File Name: BenchmarkQueries.cpp
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+Benchmarks of the query servers, sending the generated scenes over a socket
+or through shared memory and checking the answers.
+*/
+
+#include "Benchmark.h"
+#include <cstring>
+
+bool RunQuerySweep(const SweepSettings &settings, const std::string &socketPath, int queryPoints, std::ostream &out)
+{
+	QueryClient client;
+	if (!client.Connect(socketPath)) return false;
+
+	out << "points,planes,query_points,queries,ms,million_points_per_second,results_match" << std::endl;
+
+	queryPoints = std::max(queryPoints, 1);
+	SideBuffer localSides;
+	std::vector<signed char> answerSides;
+
+	for (size_t i = 0; i < settings.pointCounts.size(); i++)
+	{
+		for (size_t j = 0; j < settings.planeCounts.size(); j++)
+		{
+			ScenarioSettings scenario = settings.scenario;
+			scenario.numPoints = settings.pointCounts[i];
+			scenario.numPlanes = settings.planeCounts[j];
+			//Queries carry no collision layers
+			scenario.numLayers = 0;
+
+			Scene scene;
+			GenerateScene(scenario, scene);
+			int numPoints = (int)scene.points.Size();
+			int numQueries = (numPoints + queryPoints - 1) / queryPoints;
+
+			BenchmarkClock::time_point start = BenchmarkClock::now();
+
+			for (int q = 0; q < numQueries; q++)
+			{
+				int first = q * queryPoints;
+				int count = std::min(queryPoints, numPoints - first);
+				if (!client.SendQuery((unsigned int)q, scene.planes, &scene.points.x[first], &scene.points.y[first], &scene.points.z[first], count, pointAcceptanceRange))
+				{
+					std::cout << "Lost the connection to the query server" << std::endl;
+					return false;
+				}
+			}
+
+			//Answers are kept in query order, plane by plane, to compare with ClassifyScene
+			localSides.resize((size_t)numPoints * scene.planes.size());
+			bool match = true;
+			for (int q = 0; q < numQueries; q++)
+			{
+				AnswerHeader answer;
+				if (!client.ReceiveAnswer(answer, answerSides))
+				{
+					std::cout << "Lost the connection to the query server" << std::endl;
+					return false;
+				}
+				match = match && answer.id == (unsigned int)q;
+
+				int first = q * queryPoints;
+				for (unsigned int p = 0; p < answer.numPlanes; p++)
+					memcpy(&localSides[p * numPoints + first], &answerSides[p * answer.numPoints], answer.numPoints);
+			}
+
+			double seconds = SecondsSince(start);
+
+			SideBuffer expected;
+			ClassifyScene(scene, pointAcceptanceRange, expected, nullptr);
+			match = match && expected == localSides;
+
+			out << numPoints << ","
+				<< scene.planes.size() << ","
+				<< queryPoints << ","
+				<< numQueries << ","
+				<< seconds * 1000.0 << ","
+				<< numPoints * (double)scene.planes.size() / seconds / 1e6 << ","
+				<< (match ? 1 : 0) << std::endl;
+		}
+	}
+	return true;
+}
+
+bool RunSharedQuerySweep(const SweepSettings &settings, const std::string &regionName, int queryPoints, std::ostream &out)
+{
+	SharedQueryClient client;
+	if (!client.Attach(regionName)) return false;
+
+	out << "points,planes,query_points,queries,ms,million_points_per_second,results_match" << std::endl;
+
+	queryPoints = std::max(queryPoints, 1);
+	SideBuffer localSides;
+
+	for (size_t i = 0; i < settings.pointCounts.size(); i++)
+	{
+		for (size_t j = 0; j < settings.planeCounts.size(); j++)
+		{
+			ScenarioSettings scenario = settings.scenario;
+			scenario.numPoints = settings.pointCounts[i];
+			scenario.numPlanes = settings.planeCounts[j];
+			//Queries carry no collision layers
+			scenario.numLayers = 0;
+
+			Scene scene;
+			GenerateScene(scenario, scene);
+			int numPoints = (int)scene.points.Size();
+			int numPlanes = (int)scene.planes.size();
+			int numQueries = (numPoints + queryPoints - 1) / queryPoints;
+			localSides.resize((size_t)numPoints * numPlanes);
+			bool match = true;
+
+			//Collects one answer into the sides of the whole scene
+			auto collect = [&]() -> bool
+			{
+				SharedQuery* answer = client.WaitAnswer();
+				if (answer == nullptr)
+				{
+					std::cout << "The shared memory query server has stopped" << std::endl;
+					return false;
+				}
+
+				int first = (int)answer->id * queryPoints;
+				const signed char* sides = client.Sides(answer);
+				for (int p = 0; p < numPlanes; p++)
+					memcpy(&localSides[(size_t)p * numPoints + first], sides + (size_t)p * answer->numPoints, answer->numPoints);
+				client.Finish(answer);
+				return true;
+			};
+
+			BenchmarkClock::time_point start = BenchmarkClock::now();
+
+			for (int q = 0; q < numQueries; q++)
+			{
+				int first = q * queryPoints;
+				int count = std::min(queryPoints, numPoints - first);
+
+				//Collect answers until the channel has room for the next query
+				SharedQuery* query;
+				while ((query = client.BeginQuery((unsigned int)q, numPlanes, count, pointAcceptanceRange)) == nullptr)
+				{
+					if (client.NumInFlight() == 0)
+					{
+						std::cout << "A query of " << count << " points does not fit in the shared memory arena" << std::endl;
+						return false;
+					}
+					if (!collect()) return false;
+				}
+
+				QueryPlane* planes = client.Planes(query);
+				for (int p = 0; p < numPlanes; p++)
+				{
+					memcpy(planes[p].normal, &scene.planes[p].normal[0], sizeof(planes[p].normal));
+					memcpy(planes[p].center, &scene.planes[p].center[0], sizeof(planes[p].center));
+					planes[p].halfExtent = scene.planes[p].halfExtent;
+				}
+
+				float* points = client.Points(query);
+				memcpy(points, &scene.points.x[first], count * sizeof(float));
+				memcpy(points + count, &scene.points.y[first], count * sizeof(float));
+				memcpy(points + 2 * count, &scene.points.z[first], count * sizeof(float));
+				client.Submit(query);
+			}
+
+			while (client.NumInFlight() > 0)
+				if (!collect()) return false;
+
+			double seconds = SecondsSince(start);
+
+			SideBuffer expected;
+			ClassifyScene(scene, pointAcceptanceRange, expected, nullptr);
+			match = match && expected == localSides;
+
+			out << numPoints << ","
+				<< numPlanes << ","
+				<< queryPoints << ","
+				<< numQueries << ","
+				<< seconds * 1000.0 << ","
+				<< numPoints * (double)numPlanes / seconds / 1e6 << ","
+				<< (match ? 1 : 0) << std::endl;
+		}
+	}
+	return true;
+}
@@ -0,0 +1,430 @@
+/*
+Title: Point - Plane
+File Name: BenchmarkSpatial.cpp
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+Benchmarks of the spatial structures over the points, the point tree, packets
+and nearest point heaps, of shapes and convex hulls, and of collision layers.
+*/
+
+#include "Benchmark.h"
+#include <random>
+
+//Times querying a point tree with randomly placed planes and prints a line of results
+static void TimeTree(const Scene &scene, int numSteps, unsigned int seed, ThreadPool* pool, std::ostream &out)
+{
+	int numPoints = (int)scene.points.Size();
+	double linearSeconds = 0.0;
+	double treeSeconds = 0.0;
+	double batchSeconds = 0.0;
+	long long linearHits = 0;
+	long long treeHits = 0;
+	long long batchHits = 0;
+
+	PointTree tree;
+	BenchmarkClock::time_point start = BenchmarkClock::now();
+	tree.Build(scene.points, 64, pool);
+	double buildSeconds = SecondsSince(start);
+
+	std::mt19937 random(seed);
+	std::normal_distribution<float> direction;
+	std::uniform_real_distribution<float> offset(-0.5f * scene.extent, 0.5f * scene.extent);
+
+	std::vector<WorldPlane> planes = scene.planes;
+	std::vector<int> hits;
+	std::vector<std::vector<int>> batchHitLists;
+
+	for (int step = 0; step < numSteps; step++)
+	{
+		//Both the normal and the distance jump, so no ordering of the points stays useful
+		for (size_t i = 0; i < planes.size(); i++)
+		{
+			glm::vec3 normal = glm::normalize(glm::vec3(direction(random), direction(random), direction(random)));
+			glm::vec3 center = scene.planes[i].center + normal * offset(random);
+			float halfExtent = planes[i].halfExtent;
+			planes[i] = MakeWorldPlane(normal, center, halfExtent);
+		}
+
+		start = BenchmarkClock::now();
+		for (size_t i = 0; i < planes.size(); i++)
+			linearHits += ClassifyPoints(planes[i], scene.points.x.data(), scene.points.y.data(), scene.points.z.data(), numPoints, pointAcceptanceRange, nullptr);
+		linearSeconds += SecondsSince(start);
+
+		start = BenchmarkClock::now();
+		for (size_t i = 0; i < planes.size(); i++)
+			treeHits += tree.QueryBand(planes[i], pointAcceptanceRange, hits);
+		treeSeconds += SecondsSince(start);
+
+		start = BenchmarkClock::now();
+		batchHits += tree.QueryBands(planes, pointAcceptanceRange, batchHitLists, pool);
+		batchSeconds += SecondsSince(start);
+	}
+
+	int steps = std::max(numSteps, 1);
+	out << numPoints << ","
+		<< scene.planes.size() << ","
+		<< numSteps << ","
+		<< (pool ? pool->NumThreads() : 1) << ","
+		<< buildSeconds * 1000.0 << ","
+		<< linearSeconds * 1000.0 / steps << ","
+		<< treeSeconds * 1000.0 / steps << ","
+		<< batchSeconds * 1000.0 / steps << ","
+		<< linearHits / steps << ","
+		<< treeHits / steps << ","
+		<< batchHits / steps << std::endl;
+}
+
+void RunTreeSweep(const SweepSettings &settings, ThreadPool* pool, std::ostream &out)
+{
+	out << "points,planes,steps,threads,tree_build_ms,linear_ms_per_step,tree_ms_per_step,batch_ms_per_step,linear_hits_per_step,tree_hits_per_step,batch_hits_per_step" << std::endl;
+
+	ScenarioSettings scenario = settings.scenario;
+	scenario.motion = MOTION_STATIC;
+	ForEachScene(settings, scenario, [&](Scene &scene)
+	{
+		TimeTree(scene, settings.numSteps, scenario.seed, pool, out);
+	});
+}
+
+//Times classifying one scene in packets and prints a line of results
+static void TimePackets(Scene &scene, int numSteps, float dt, int packetSize, std::ostream &out)
+{
+	int numPoints = (int)scene.points.Size();
+	double linearSeconds = 0.0;
+	double refitSeconds = 0.0;
+	double packetSeconds = 0.0;
+	long long linearHits = 0;
+	long long packetHits = 0;
+	PacketStats stats;
+
+	OrderPointsSpatially(scene.points, packetSize);
+
+	PacketSet packets;
+	packets.Build(scene.points, packetSize);
+
+	std::vector<signed char> sides(numPoints);
+
+	for (int step = 0; step < numSteps; step++)
+	{
+		StepScene(scene, dt);
+
+		BenchmarkClock::time_point start = BenchmarkClock::now();
+		packets.Refit(scene.points);
+		refitSeconds += SecondsSince(start);
+
+		for (size_t i = 0; i < scene.planes.size(); i++)
+		{
+			start = BenchmarkClock::now();
+			linearHits += ClassifyPoints(scene.planes[i], scene.points.x.data(), scene.points.y.data(), scene.points.z.data(), numPoints, pointAcceptanceRange, sides.data());
+			linearSeconds += SecondsSince(start);
+
+			start = BenchmarkClock::now();
+			packetHits += ClassifyPackets(scene.planes[i], scene.points, packets, pointAcceptanceRange, sides.data(), &stats);
+			packetSeconds += SecondsSince(start);
+		}
+	}
+
+	int steps = std::max(numSteps, 1);
+	out << numPoints << ","
+		<< scene.planes.size() << ","
+		<< numSteps << ","
+		<< packetSize << ","
+		<< linearSeconds * 1000.0 / steps << ","
+		<< refitSeconds * 1000.0 / steps << ","
+		<< packetSeconds * 1000.0 / steps << ","
+		<< linearHits / steps << ","
+		<< packetHits / steps << ","
+		<< (stats.packetsBehind + stats.packetsFront + stats.packetsOn) / steps << ","
+		<< stats.packetsTested / steps << ","
+		<< stats.pointsTested / steps << std::endl;
+}
+
+void RunPacketSweep(const SweepSettings &settings, int packetSize, std::ostream &out)
+{
+	out << "points,planes,steps,packet_size,linear_ms_per_step,refit_ms_per_step,packet_ms_per_step,linear_hits_per_step,packet_hits_per_step,packets_culled_per_step,packets_tested_per_step,points_tested_per_step" << std::endl;
+
+	ScenarioSettings scenario = settings.scenario;
+	ForEachScene(settings, scenario, [&](Scene &scene)
+	{
+		TimePackets(scene, settings.numSteps, settings.dt, packetSize, out);
+	});
+}
+
+void RunNearestSweep(const SweepSettings &settings, int k, ThreadPool* pool, std::ostream &out)
+{
+	out << "points,planes,k,threads,sort_ms,serial_ms,parallel_ms,results_match" << std::endl;
+
+	std::vector<std::pair<float, int>> ranked;
+	std::vector<NearestPoint> serialNearest;
+	std::vector<NearestPoint> parallelNearest;
+
+	ScenarioSettings scenario = settings.scenario;
+	ForEachScene(settings, scenario, [&](Scene &scene)
+	{
+		int numPoints = (int)scene.points.Size();
+		int found = std::min(k, numPoints);
+
+		double sortSeconds = 0.0;
+		double serialSeconds = 0.0;
+		double parallelSeconds = 0.0;
+		bool match = true;
+
+		for (size_t p = 0; p < scene.planes.size(); p++)
+		{
+			const WorldPlane &plane = scene.planes[p];
+
+			//The simple way, rank every point and sort the best k
+			BenchmarkClock::time_point start = BenchmarkClock::now();
+			ranked.resize(numPoints);
+			for (int n = 0; n < numPoints; n++)
+			{
+				float distance = glm::dot(plane.normal, glm::vec3(scene.points.x[n], scene.points.y[n], scene.points.z[n])) - plane.distance;
+				ranked[n] = std::make_pair(fabs(distance), n);
+			}
+			std::partial_sort(ranked.begin(), ranked.begin() + found, ranked.end());
+			sortSeconds += SecondsSince(start);
+
+			start = BenchmarkClock::now();
+			FindNearestToPlane(plane, scene.points, k, DISTANCE_ABSOLUTE, serialNearest, nullptr);
+			serialSeconds += SecondsSince(start);
+
+			start = BenchmarkClock::now();
+			FindNearestToPlane(plane, scene.points, k, DISTANCE_ABSOLUTE, parallelNearest, pool);
+			parallelSeconds += SecondsSince(start);
+
+			for (int n = 0; n < found && match; n++)
+				match = serialNearest[n].point == ranked[n].second && parallelNearest[n].point == ranked[n].second;
+		}
+
+		out << numPoints << ","
+			<< scene.planes.size() << ","
+			<< k << ","
+			<< (pool ? pool->NumThreads() : 1) << ","
+			<< sortSeconds * 1000.0 << ","
+			<< serialSeconds * 1000.0 << ","
+			<< parallelSeconds * 1000.0 << ","
+			<< (match ? 1 : 0) << std::endl;
+	});
+}
+
+void RunShapeSweep(const SweepSettings &settings, const std::vector<ShapeType> &types, std::ostream &out)
+{
+	out << "shape,shapes,planes,steps,classify_ms_per_step,ns_per_pair,collisions_per_step" << std::endl;
+
+	std::vector<float> extents;
+	std::vector<signed char> sides;
+
+	for (size_t t = 0; t < types.size(); t++)
+	{
+		ScenarioSettings scenario = settings.scenario;
+		ForEachScene(settings, scenario, [&](Scene &scene)
+		{
+			ShapeSet shapes;
+			GenerateShapes(types[t], scene.points, 0.02f * scene.extent, scenario.seed, shapes);
+			int numShapes = (int)shapes.Size();
+			sides.resize(numShapes);
+
+			long long numCollisions = 0;
+			BenchmarkClock::time_point start = BenchmarkClock::now();
+			for (int step = 0; step < settings.numSteps; step++)
+			{
+				for (size_t k = 0; k < scene.planes.size(); k++)
+					numCollisions += ClassifyShapes(scene.planes[k], shapes, pointAcceptanceRange, extents, sides.data());
+			}
+			double seconds = SecondsSince(start);
+
+			int steps = std::max(settings.numSteps, 1);
+			double pairs = (double)numShapes * scene.planes.size() * steps;
+			out << ShapeTypeName(types[t]) << ","
+				<< numShapes << ","
+				<< scene.planes.size() << ","
+				<< settings.numSteps << ","
+				<< seconds * 1000.0 / steps << ","
+				<< (pairs > 0.0 ? seconds * 1e9 / pairs : 0.0) << ","
+				<< numCollisions / steps << std::endl;
+		});
+	}
+}
+
+void RunHullSweep(int numQueries, float angleStep, unsigned int seed, std::ostream &out)
+{
+	out << "vertices,motion,queries,scan_ns_per_query,climb_ns_per_query,steps_per_support,scans,mismatches" << std::endl;
+
+	std::mt19937 random(seed);
+	std::normal_distribution<float> direction;
+	glm::mat4 modelMatrix(1.0f);
+
+	for (int subdivisions = 1; subdivisions <= 6; subdivisions++)
+	{
+		//A squashed geodesic sphere is still convex, and has no two vertices alike
+		std::vector<glm::vec3> vertices;
+		std::vector<int> triangles;
+		GeodesicSphere(subdivisions, vertices, &triangles);
+		for (size_t i = 0; i < vertices.size(); i++)
+			vertices[i] *= glm::vec3(1.0f, 0.6f, 0.3f);
+
+		ConvexHull hull;
+		hull.Build(vertices, triangles);
+
+		for (int motion = 0; motion < 2; motion++)
+		{
+			bool smooth = motion == 0;
+
+			//Work out every plane first so only the queries are timed
+			std::vector<WorldPlane> planes(numQueries);
+			glm::vec3 normal(0.0f, 0.0f, 1.0f);
+			glm::mat3 rotation = glm::mat3(glm::rotate(glm::mat4(1.0f), angleStep, glm::normalize(glm::vec3(1.0f, 2.0f, 3.0f))));
+			for (int i = 0; i < numQueries; i++)
+			{
+				if (smooth) normal = rotation * normal;
+				else normal = glm::normalize(glm::vec3(direction(random), direction(random), direction(random)));
+				planes[i] = MakeWorldPlane(normal, normal * (0.5f * sinf(i * 0.01f)), 0.0f);
+			}
+
+			std::vector<float> scanDistances(numQueries * 2);
+			BenchmarkClock::time_point start = BenchmarkClock::now();
+			for (int i = 0; i < numQueries; i++)
+			{
+				int front = hull.SupportScan(planes[i].normal);
+				int back = hull.SupportScan(-planes[i].normal);
+				scanDistances[i * 2] = glm::dot(planes[i].normal, glm::vec3(hull.x[front], hull.y[front], hull.z[front])) - planes[i].distance;
+				scanDistances[i * 2 + 1] = glm::dot(planes[i].normal, glm::vec3(hull.x[back], hull.y[back], hull.z[back])) - planes[i].distance;
+			}
+			double scanSeconds = SecondsSince(start);
+
+			HullCollider collider;
+			collider.hull = &hull;
+			std::vector<float> climbDistances(numQueries * 2);
+			start = BenchmarkClock::now();
+			for (int i = 0; i < numQueries; i++)
+				collider.Classify(planes[i], modelMatrix, pointAcceptanceRange, &climbDistances[i * 2 + 1], &climbDistances[i * 2]);
+			double climbSeconds = SecondsSince(start);
+
+			int mismatches = 0;
+			for (int i = 0; i < numQueries * 2; i++)
+				mismatches += fabs(scanDistances[i] - climbDistances[i]) > 1e-5f;
+
+			int queries = std::max(numQueries, 1);
+			out << hull.Size() << ","
+				<< (smooth ? "smooth" : "random") << ","
+				<< numQueries << ","
+				<< scanSeconds * 1e9 / queries << ","
+				<< climbSeconds * 1e9 / queries << ","
+				<< (double)collider.numSteps / (2.0 * queries) << ","
+				<< collider.numScans << ","
+				<< mismatches << std::endl;
+		}
+	}
+}
+
+void RunLayerSweep(const SweepSettings &settings, std::ostream &out)
+{
+	out << "layers,points,planes,steps,unfiltered_ms_per_step,filtered_ms_per_step,packet_ms_per_step,tree_ms_per_step,pairs_tested_per_step,pairs_skipped_per_step,packets_skipped_per_step,unfiltered_hits_per_step,filtered_hits_per_step,results_match" << std::endl;
+
+	ScenarioSettings scenario = settings.scenario;
+	scenario.numLayers = scenario.numLayers > 0 ? scenario.numLayers : 8;
+	scenario.motion = MOTION_STATIC;
+	ForEachScene(settings, scenario, [&](Scene &scene)
+	{
+		int numPoints = (int)scene.points.Size();
+		const PointSet &points = scene.points;
+
+		PacketSet packets;
+		packets.Build(points, 1024);
+		PointTree tree;
+		tree.Build(points, 64, nullptr);
+
+		//Every pair tested, with the skipped pairs marked afterwards for comparison
+		SideBuffer expected((size_t)numPoints * scene.planes.size());
+		long long expectedHits = 0;
+		for (size_t p = 0; p < scene.planes.size(); p++)
+		{
+			signed char* planeSides = &expected[p * numPoints];
+			ClassifyPoints(scene.planes[p], points.x.data(), points.y.data(), points.z.data(), numPoints, pointAcceptanceRange, planeSides);
+			for (int n = 0; n < numPoints; n++)
+			{
+				if (!scene.planes[p].filter.Interacts(points.filters[n])) planeSides[n] = SIDE_IGNORED;
+				else if (planeSides[n] == SIDE_ON) expectedHits++;
+			}
+		}
+
+		double unfilteredSeconds = 0.0;
+		double filteredSeconds = 0.0;
+		double packetSeconds = 0.0;
+		double treeSeconds = 0.0;
+		long long unfilteredHits = 0;
+		long long filteredHits = 0;
+		long long numSkipped = 0;
+		PacketStats stats;
+		bool match = true;
+
+		SideBuffer sides;
+		SideBuffer unfilteredSides((size_t)numPoints * scene.planes.size());
+		SideBuffer packetSides((size_t)numPoints * scene.planes.size());
+		std::vector<int> hits;
+
+		for (int step = 0; step < settings.numSteps; step++)
+		{
+			BenchmarkClock::time_point start = BenchmarkClock::now();
+			for (size_t p = 0; p < scene.planes.size(); p++)
+				unfilteredHits += ClassifyPoints(scene.planes[p], points.x.data(), points.y.data(), points.z.data(), numPoints, pointAcceptanceRange, &unfilteredSides[p * numPoints]);
+			unfilteredSeconds += SecondsSince(start);
+
+			start = BenchmarkClock::now();
+			long long stepHits = ClassifyScene(scene, pointAcceptanceRange, sides, &numSkipped);
+			filteredSeconds += SecondsSince(start);
+			filteredHits += stepHits;
+			match = match && stepHits == expectedHits && sides == expected;
+
+			start = BenchmarkClock::now();
+			stepHits = 0;
+			for (size_t p = 0; p < scene.planes.size(); p++)
+				stepHits += ClassifyPackets(scene.planes[p], points, packets, pointAcceptanceRange, &packetSides[p * numPoints], &stats);
+			packetSeconds += SecondsSince(start);
+			match = match && stepHits == expectedHits && packetSides == expected;
+
+			start = BenchmarkClock::now();
+			stepHits = 0;
+			for (size_t p = 0; p < scene.planes.size(); p++)
+				stepHits += tree.QueryBand(scene.planes[p], pointAcceptanceRange, hits);
+			treeSeconds += SecondsSince(start);
+			match = match && stepHits == expectedHits;
+		}
+
+		int steps = std::max(settings.numSteps, 1);
+		long long numPairs = (long long)numPoints * scene.planes.size();
+		out << scenario.numLayers << ","
+			<< numPoints << ","
+			<< scene.planes.size() << ","
+			<< settings.numSteps << ","
+			<< unfilteredSeconds * 1000.0 / steps << ","
+			<< filteredSeconds * 1000.0 / steps << ","
+			<< packetSeconds * 1000.0 / steps << ","
+			<< treeSeconds * 1000.0 / steps << ","
+			<< numPairs - numSkipped / steps << ","
+			<< numSkipped / steps << ","
+			<< stats.packetsSkipped / steps << ","
+			<< unfilteredHits / steps << ","
+			<< filteredHits / steps << ","
+			<< (match ? 1 : 0) << std::endl;
+	});
+}
@@ -0,0 +1,179 @@
+/*
+Title: Point - Plane
+File Name: BenchmarkWorlds.cpp
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+Benchmarks of whole worlds: many worlds stepped on one pool, and a world
+reusing its pair cache against one testing every pair.
+*/
+
+#include "Benchmark.h"
+#include <random>
+
+void RunWorldSweep(const SweepSettings &settings, int numWorlds, int numIdleWorlds, int numFrames, ThreadPool* pool, std::ostream &out)
+{
+	int scriptedKeys[] = { GLFW_KEY_W, GLFW_KEY_A, GLFW_KEY_S, GLFW_KEY_D, GLFW_KEY_LEFT_CONTROL, GLFW_KEY_LEFT_SHIFT, GLFW_KEY_SPACE };
+	int numScriptedKeys = sizeof(scriptedKeys) / sizeof(scriptedKeys[0]);
+
+	std::vector<World*> worlds(numWorlds + numIdleWorlds);
+	std::vector<std::mt19937> inputs(numWorlds);
+	std::vector<double> cursorX(numWorlds, 0.0);
+	std::vector<double> cursorY(numWorlds, 0.0);
+	for (int i = 0; i < (int)worlds.size(); i++)
+	{
+		worlds[i] = new World();
+		if (i >= numWorlds) continue;
+
+		ScenarioSettings scenario = settings.scenario;
+		scenario.numPoints *= 1 + i % 4;
+		scenario.seed += i;
+
+		worlds[i]->scene = new Scene();
+		GenerateScene(scenario, *worlds[i]->scene);
+		inputs[i].seed(scenario.seed);
+	}
+
+	std::vector<double> frameSeconds(numFrames);
+	long long stealsBefore = pool ? pool->numSteals.load() : 0;
+
+	for (int frame = 0; frame < numFrames; frame++)
+	{
+		BenchmarkClock::time_point start = BenchmarkClock::now();
+
+		//Every world is stepped once per frame, so no world can fall behind the others
+		ParallelRanges(pool, numWorlds, 1, [&](int begin, int end)
+		{
+			for (int i = begin; i < end; i++)
+			{
+				//Tap a movement key now and then, and drag the mouse in bursts
+				std::mt19937 &input = inputs[i];
+				if (input() % 8 == 0)
+					worlds[i]->ProcessKey(scriptedKeys[input() % numScriptedKeys], GLFW_PRESS);
+				if (input() % 60 == 0)
+					worlds[i]->ProcessMouseButton(GLFW_MOUSE_BUTTON_LEFT, worlds[i]->isMousePressed ? GLFW_RELEASE : GLFW_PRESS, cursorX[i], cursorY[i]);
+				cursorX[i] += (double)(input() % 11) - 5.0;
+				cursorY[i] += (double)(input() % 11) - 5.0;
+
+				worlds[i]->Step(cursorX[i], cursorY[i], settings.dt, pool);
+			}
+		});
+
+		frameSeconds[frame] = SecondsSince(start);
+	}
+
+	out << "world,points,planes,steps,mean_us,p50_us,p99_us,max_us,collisions,bytes" << std::endl;
+	size_t activeBytes = 0;
+	for (int i = 0; i < numWorlds; i++)
+	{
+		const World &world = *worlds[i];
+		const WorldStats &stats = world.stats;
+		activeBytes += world.MemoryUsed();
+
+		out << i << ","
+			<< world.scene->points.Size() << ","
+			<< world.scene->planes.size() << ","
+			<< stats.numSteps << ","
+			<< stats.MeanTime() / 1000.0 << ","
+			<< (stats.stepTimes ? stats.stepTimes->ValueAtPercentile(50.0) : 0) / 1000.0 << ","
+			<< (stats.stepTimes ? stats.stepTimes->ValueAtPercentile(99.0) : 0) / 1000.0 << ","
+			<< stats.maxTime / 1000.0 << ","
+			<< world.sceneCollisions << ","
+			<< world.MemoryUsed() << std::endl;
+	}
+
+	size_t idleBytes = 0;
+	for (int i = numWorlds; i < (int)worlds.size(); i++)
+		idleBytes += worlds[i]->MemoryUsed();
+
+	double meanFrame = 0.0;
+	double maxFrame = 0.0;
+	for (int frame = 0; frame < numFrames; frame++)
+	{
+		meanFrame += frameSeconds[frame] / numFrames;
+		maxFrame = std::max(maxFrame, frameSeconds[frame]);
+	}
+
+	out << std::endl;
+	out << "worlds,idle_worlds,threads,frames,frame_mean_ms,frame_max_ms,steals,bytes_per_active_world,bytes_per_idle_world" << std::endl;
+	out << numWorlds << ","
+		<< numIdleWorlds << ","
+		<< (pool ? pool->NumThreads() : 1) << ","
+		<< numFrames << ","
+		<< meanFrame * 1000.0 << ","
+		<< maxFrame * 1000.0 << ","
+		<< (pool ? pool->numSteals.load() - stealsBefore : 0) << ","
+		<< (numWorlds > 0 ? activeBytes / numWorlds : 0) << ","
+		<< (numIdleWorlds > 0 ? idleBytes / numIdleWorlds : 0) << std::endl;
+
+	for (size_t i = 0; i < worlds.size(); i++)
+		delete worlds[i];
+}
+
+void RunPairCacheSweep(const SweepSettings &settings, ThreadPool* pool, std::ostream &out)
+{
+	out << "motion,points,planes,steps,cold_ms_per_step,warm_ms_per_step,pairs_reused_per_step,results_match" << std::endl;
+	const char* motionNames[] = { "static", "drift", "orbit" };
+
+	for (size_t i = 0; i < settings.pointCounts.size(); i++)
+	{
+		for (size_t j = 0; j < settings.planeCounts.size(); j++)
+		{
+			ScenarioSettings scenario = settings.scenario;
+			scenario.numPoints = settings.pointCounts[i];
+			scenario.numPlanes = settings.planeCounts[j];
+
+			World cold;
+			World warm;
+			cold.warmStart = false;
+			cold.scene = new Scene();
+			warm.scene = new Scene();
+			GenerateScene(scenario, *cold.scene);
+			GenerateScene(scenario, *warm.scene);
+
+			bool match = true;
+			for (int step = 0; step < settings.numSteps; step++)
+			{
+				//Slide the first plane back and forth through the points
+				float slide = (step % 16 < 8 ? 0.25f : -0.25f) * pointAcceptanceRange;
+				WorldPlane &coldPlane = cold.scene->planes[0];
+				WorldPlane &warmPlane = warm.scene->planes[0];
+				coldPlane.center += coldPlane.normal * slide;
+				coldPlane.distance = glm::dot(coldPlane.normal, coldPlane.center);
+				warmPlane = coldPlane;
+
+				cold.Step(0.0, 0.0, settings.dt, pool);
+				warm.Step(0.0, 0.0, settings.dt, pool);
+				match = match && cold.sceneCollisions == warm.sceneCollisions && cold.sceneSides == warm.sceneSides;
+			}
+
+			int steps = std::max(settings.numSteps, 1);
+			out << motionNames[scenario.motion] << ","
+				<< scenario.numPoints << ","
+				<< scenario.numPlanes << ","
+				<< settings.numSteps << ","
+				<< cold.stats.MeanTime() / 1e6 << ","
+				<< warm.stats.MeanTime() / 1e6 << ","
+				<< warm.pairsReused / steps << ","
+				<< (match ? 1 : 0) << std::endl;
+		}
+	}
+}
@@ -0,0 +1,408 @@
+/*
+Title: Point - Plane
+File Name: Collision.cpp
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+The point - plane collision tests.
+*/
+
+#include "Collision.h"
+#include "Telemetry.h"
+#include <atomic>
+
+//x64 always has SSE2, and 32 bit MSVC builds have it with /arch:SSE2 or later
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define COLLISION_SSE2
+#include <emmintrin.h>
+#endif
+
+static std::atomic<int> classifyKernel(KERNEL_CACHED);
+
+bool TestCollision(const Plane &pCollider, const glm::mat4 &pModelMatrix, glm::vec3 point)
+{
+	//See pointAcceptanceRange for why points within this range count as colliding
+	float acceptanceRange = pointAcceptanceRange;
+
+	//Step 1: Get the plane normal in world space
+	glm::vec3 worldNormal = glm::vec3(pModelMatrix * glm::vec4(pCollider.normal, 0.0f));
+
+	//Step 2: Translate the plane and the point to a system where the plane is the origin
+	glm::vec3 planePos = glm::vec3(pModelMatrix[3][0], pModelMatrix[3][1], pModelMatrix[3][2]);
+	point -= planePos;
+
+	//Step 3: Take the dot product of the point and the plane normal
+	if (fabs(glm::dot(point, worldNormal)) <= FLT_EPSILON + acceptanceRange) return true;
+
+	return false;
+}
+
+WorldPlane MakeWorldPlane(glm::vec3 normal, glm::vec3 center, float halfExtent)
+{
+	WorldPlane plane;
+	plane.normal = normal;
+	plane.center = center;
+	plane.distance = glm::dot(normal, center);
+	plane.halfExtent = halfExtent;
+
+	//Pick any two axes lying in the plane
+	glm::vec3 axis = fabs(normal.x) < 0.9f ? glm::vec3(1.0f, 0.0f, 0.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+	plane.tangent = glm::normalize(glm::cross(normal, axis));
+	plane.bitangent = glm::cross(normal, plane.tangent);
+
+	return plane;
+}
+
+WorldPlane MakeWorldPlane(const Plane &pCollider, const glm::mat4 &pModelMatrix)
+{
+	//Same as steps 1 and 2 of TestCollision, but done once instead of per point
+	glm::vec3 worldNormal = glm::vec3(pModelMatrix * glm::vec4(pCollider.normal, 0.0f));
+	glm::vec3 planePos = glm::vec3(pModelMatrix[3][0], pModelMatrix[3][1], pModelMatrix[3][2]);
+
+	return MakeWorldPlane(worldNormal, planePos, 0.0f);
+}
+
+//The loop of ClassifyPoints, which leaves the points and sides in the caches
+static int ClassifyPointsCached(const WorldPlane &plane, const float* x, const float* y, const float* z, int count, float acceptanceRange, signed char* sides)
+{
+	float nx = plane.normal.x, ny = plane.normal.y, nz = plane.normal.z;
+	float d = plane.distance;
+	float range = FLT_EPSILON + acceptanceRange;
+	int numColliding = 0;
+
+	if (plane.halfExtent <= 0.0f)
+	{
+		for (int i = 0; i < count; i++)
+		{
+			float dist = nx * x[i] + ny * y[i] + nz * z[i] - d;
+			int on = fabs(dist) <= range;
+			numColliding += on;
+			if (sides) sides[i] = (signed char)(on ? SIDE_ON : (dist > 0.0f ? SIDE_FRONT : SIDE_BEHIND));
+		}
+	}
+	else
+	{
+		//Finite planes also need the point to lie within the bounds of the plane
+		float cx = plane.center.x, cy = plane.center.y, cz = plane.center.z;
+		float tx = plane.tangent.x, ty = plane.tangent.y, tz = plane.tangent.z;
+		float bx = plane.bitangent.x, by = plane.bitangent.y, bz = plane.bitangent.z;
+		float h = plane.halfExtent;
+
+		for (int i = 0; i < count; i++)
+		{
+			float px = x[i] - cx, py = y[i] - cy, pz = z[i] - cz;
+			float dist = nx * px + ny * py + nz * pz;
+			float u = tx * px + ty * py + tz * pz;
+			float v = bx * px + by * py + bz * pz;
+			int on = fabs(dist) <= range && fabs(u) <= h && fabs(v) <= h;
+			numColliding += on;
+			if (sides) sides[i] = (signed char)(on ? SIDE_ON : (dist > 0.0f ? SIDE_FRONT : SIDE_BEHIND));
+		}
+	}
+
+	return numColliding;
+}
+
+int ClassifyPoints(const WorldPlane &plane, const float* x, const float* y, const float* z, int count, float acceptanceRange, signed char* sides)
+{
+	if (count >= streamingMinimum && classifyKernel.load(std::memory_order_relaxed) == KERNEL_STREAMING)
+		return ClassifyPointsStreaming(plane, x, y, z, count, acceptanceRange, sides);
+
+	int numColliding = ClassifyPointsCached(plane, x, y, z, count, acceptanceRange, sides);
+	telemetry->RecordPoints(count, numColliding);
+	return numColliding;
+}
+
+void SetClassifyKernel(ClassifyKernel kernel)
+{
+	classifyKernel = kernel;
+}
+
+ClassifyKernel GetClassifyKernel()
+{
+	return (ClassifyKernel)classifyKernel.load();
+}
+
+bool ParseClassifyKernel(const std::string &name, ClassifyKernel &kernel)
+{
+	if (name == "cached") kernel = KERNEL_CACHED;
+	else if (name == "streaming") kernel = KERNEL_STREAMING;
+	else return false;
+	return true;
+}
+
+#ifdef COLLISION_SSE2
+//Points prefetched ahead of the ones being classified. Each array is read about 2KB
+//ahead, far enough to cover the time a line takes to arrive from memory, and near
+//enough that it is still in L1 when the loop reaches it.
+static const int streamingPrefetchDistance = 512;
+
+//The number of bits set in each 4 bit mask
+static const int maskBits[16] = { 0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4 };
+
+//A world space plane with every value repeated across a vector
+struct SsePlane
+{
+	__m128 nx, ny, nz, d;
+	__m128 cx, cy, cz;
+	__m128 tx, ty, tz;
+	__m128 bx, by, bz;
+	__m128 range, halfExtent;
+	bool finite;
+};
+
+//Turns the signed distances of four points and whether they are on the plane into their sides as 32 bit integers
+static inline __m128i SidesOf(__m128 dist, __m128 on)
+{
+	//Front is 1 and behind is -1, so the side is -1 - 2 * (dist > 0), cleared where the point is on the plane
+	__m128i front = _mm_castps_si128(_mm_cmpgt_ps(dist, _mm_setzero_ps()));
+	__m128i side = _mm_sub_epi32(_mm_set1_epi32(-1), _mm_add_epi32(front, front));
+	return _mm_andnot_si128(_mm_castps_si128(on), side);
+}
+
+//Classifies four points the same way as ClassifyPointsCached, returning their sides as 32 bit integers
+static inline __m128i ClassifyFour(const SsePlane &plane, const float* x, const float* y, const float* z, int &numColliding)
+{
+	const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+	__m128 px = _mm_loadu_ps(x);
+	__m128 py = _mm_loadu_ps(y);
+	__m128 pz = _mm_loadu_ps(z);
+	__m128 dist;
+	__m128 on;
+
+	//The sums are in the same order as the scalar loop, so the results match it exactly
+	if (!plane.finite)
+	{
+		dist = _mm_sub_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(plane.nx, px), _mm_mul_ps(plane.ny, py)), _mm_mul_ps(plane.nz, pz)), plane.d);
+		on = _mm_cmple_ps(_mm_and_ps(dist, absMask), plane.range);
+	}
+	else
+	{
+		px = _mm_sub_ps(px, plane.cx);
+		py = _mm_sub_ps(py, plane.cy);
+		pz = _mm_sub_ps(pz, plane.cz);
+		dist = _mm_add_ps(_mm_add_ps(_mm_mul_ps(plane.nx, px), _mm_mul_ps(plane.ny, py)), _mm_mul_ps(plane.nz, pz));
+		__m128 u = _mm_add_ps(_mm_add_ps(_mm_mul_ps(plane.tx, px), _mm_mul_ps(plane.ty, py)), _mm_mul_ps(plane.tz, pz));
+		__m128 v = _mm_add_ps(_mm_add_ps(_mm_mul_ps(plane.bx, px), _mm_mul_ps(plane.by, py)), _mm_mul_ps(plane.bz, pz));
+		on = _mm_and_ps(_mm_cmple_ps(_mm_and_ps(dist, absMask), plane.range),
+			_mm_and_ps(_mm_cmple_ps(_mm_and_ps(u, absMask), plane.halfExtent), _mm_cmple_ps(_mm_and_ps(v, absMask), plane.halfExtent)));
+	}
+	numColliding += maskBits[_mm_movemask_ps(on)];
+	return SidesOf(dist, on);
+}
+
+//Repeats the values of a plane across vectors
+static void LoadSsePlane(const WorldPlane &plane, float acceptanceRange, SsePlane &wide)
+{
+	wide.nx = _mm_set1_ps(plane.normal.x);
+	wide.ny = _mm_set1_ps(plane.normal.y);
+	wide.nz = _mm_set1_ps(plane.normal.z);
+	wide.d = _mm_set1_ps(plane.distance);
+	wide.cx = _mm_set1_ps(plane.center.x);
+	wide.cy = _mm_set1_ps(plane.center.y);
+	wide.cz = _mm_set1_ps(plane.center.z);
+	wide.tx = _mm_set1_ps(plane.tangent.x);
+	wide.ty = _mm_set1_ps(plane.tangent.y);
+	wide.tz = _mm_set1_ps(plane.tangent.z);
+	wide.bx = _mm_set1_ps(plane.bitangent.x);
+	wide.by = _mm_set1_ps(plane.bitangent.y);
+	wide.bz = _mm_set1_ps(plane.bitangent.z);
+	wide.range = _mm_set1_ps(FLT_EPSILON + acceptanceRange);
+	wide.halfExtent = _mm_set1_ps(plane.halfExtent);
+	wide.finite = plane.halfExtent > 0.0f;
+}
+#endif
+
+int ClassifyPointsStreaming(const WorldPlane &plane, const float* x, const float* y, const float* z, int count, float acceptanceRange, signed char* sides)
+{
+#ifdef COLLISION_SSE2
+	SsePlane wide;
+	LoadSsePlane(plane, acceptanceRange, wide);
+
+	//Streaming stores must be 16 byte aligned, so the sides before the first boundary are written normally
+	int head = sides ? (int)((16 - ((size_t)sides & 15)) & 15) : 0;
+	head = std::min(head, count);
+	int numColliding = ClassifyPointsCached(plane, x, y, z, head, acceptanceRange, sides);
+
+	//One cache line of each coordinate per iteration
+	int i = head;
+	for (; i + 16 <= count; i += 16)
+	{
+		_mm_prefetch((const char*)(x + i + streamingPrefetchDistance), _MM_HINT_NTA);
+		_mm_prefetch((const char*)(y + i + streamingPrefetchDistance), _MM_HINT_NTA);
+		_mm_prefetch((const char*)(z + i + streamingPrefetchDistance), _MM_HINT_NTA);
+
+		__m128i sides0 = ClassifyFour(wide, x + i, y + i, z + i, numColliding);
+		__m128i sides1 = ClassifyFour(wide, x + i + 4, y + i + 4, z + i + 4, numColliding);
+		__m128i sides2 = ClassifyFour(wide, x + i + 8, y + i + 8, z + i + 8, numColliding);
+		__m128i sides3 = ClassifyFour(wide, x + i + 12, y + i + 12, z + i + 12, numColliding);
+
+		if (sides)
+		{
+			__m128i packed = _mm_packs_epi16(_mm_packs_epi32(sides0, sides1), _mm_packs_epi32(sides2, sides3));
+			_mm_stream_si128((__m128i*)(sides + i), packed);
+		}
+	}
+
+	//Streaming stores are weakly ordered, so they must be finished before anyone reads the sides
+	_mm_sfence();
+
+	numColliding += ClassifyPointsCached(plane, x + i, y + i, z + i, count - i, acceptanceRange, sides ? sides + i : nullptr);
+#else
+	int numColliding = ClassifyPointsCached(plane, x, y, z, count, acceptanceRange, sides);
+#endif
+
+	telemetry->RecordPoints(count, numColliding);
+	return numColliding;
+}
+
+//The loop of ClassifyExtents without vectors, also used for the points left over by the vector loop
+static int ClassifyExtentsScalar(const WorldPlane &plane, const float* x, const float* y, const float* z,
+	const float* normalExtents, const float* tangentExtents, const float* bitangentExtents,
+	int count, float acceptanceRange, signed char* sides)
+{
+	float nx = plane.normal.x, ny = plane.normal.y, nz = plane.normal.z;
+	float d = plane.distance;
+	float range = FLT_EPSILON + acceptanceRange;
+	int numColliding = 0;
+
+	if (plane.halfExtent <= 0.0f)
+	{
+		for (int i = 0; i < count; i++)
+		{
+			float dist = nx * x[i] + ny * y[i] + nz * z[i] - d;
+			int on = fabs(dist) <= range + normalExtents[i];
+			numColliding += on;
+			if (sides) sides[i] = (signed char)(on ? SIDE_ON : (dist > 0.0f ? SIDE_FRONT : SIDE_BEHIND));
+		}
+	}
+	else
+	{
+		float cx = plane.center.x, cy = plane.center.y, cz = plane.center.z;
+		float tx = plane.tangent.x, ty = plane.tangent.y, tz = plane.tangent.z;
+		float bx = plane.bitangent.x, by = plane.bitangent.y, bz = plane.bitangent.z;
+		float h = plane.halfExtent;
+
+		for (int i = 0; i < count; i++)
+		{
+			float px = x[i] - cx, py = y[i] - cy, pz = z[i] - cz;
+			float dist = nx * px + ny * py + nz * pz;
+			float u = tx * px + ty * py + tz * pz;
+			float v = bx * px + by * py + bz * pz;
+			int on = fabs(dist) <= range + normalExtents[i] && fabs(u) <= h + tangentExtents[i] && fabs(v) <= h + bitangentExtents[i];
+			numColliding += on;
+			if (sides) sides[i] = (signed char)(on ? SIDE_ON : (dist > 0.0f ? SIDE_FRONT : SIDE_BEHIND));
+		}
+	}
+
+	return numColliding;
+}
+
+#ifdef COLLISION_SSE2
+//Classifies four shapes the same way as ClassifyExtentsScalar, returning their sides as 32 bit integers
+static inline __m128i ClassifyFourExtents(const SsePlane &plane, const float* x, const float* y, const float* z,
+	const float* normalExtents, const float* tangentExtents, const float* bitangentExtents, int &numColliding)
+{
+	const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+	__m128 px = _mm_loadu_ps(x);
+	__m128 py = _mm_loadu_ps(y);
+	__m128 pz = _mm_loadu_ps(z);
+	__m128 reach = _mm_add_ps(plane.range, _mm_loadu_ps(normalExtents));
+	__m128 dist;
+	__m128 on;
+
+	if (!plane.finite)
+	{
+		dist = _mm_sub_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(plane.nx, px), _mm_mul_ps(plane.ny, py)), _mm_mul_ps(plane.nz, pz)), plane.d);
+		on = _mm_cmple_ps(_mm_and_ps(dist, absMask), reach);
+	}
+	else
+	{
+		px = _mm_sub_ps(px, plane.cx);
+		py = _mm_sub_ps(py, plane.cy);
+		pz = _mm_sub_ps(pz, plane.cz);
+		dist = _mm_add_ps(_mm_add_ps(_mm_mul_ps(plane.nx, px), _mm_mul_ps(plane.ny, py)), _mm_mul_ps(plane.nz, pz));
+		__m128 u = _mm_add_ps(_mm_add_ps(_mm_mul_ps(plane.tx, px), _mm_mul_ps(plane.ty, py)), _mm_mul_ps(plane.tz, pz));
+		__m128 v = _mm_add_ps(_mm_add_ps(_mm_mul_ps(plane.bx, px), _mm_mul_ps(plane.by, py)), _mm_mul_ps(plane.bz, pz));
+		__m128 uReach = _mm_add_ps(plane.halfExtent, _mm_loadu_ps(tangentExtents));
+		__m128 vReach = _mm_add_ps(plane.halfExtent, _mm_loadu_ps(bitangentExtents));
+		on = _mm_and_ps(_mm_cmple_ps(_mm_and_ps(dist, absMask), reach),
+			_mm_and_ps(_mm_cmple_ps(_mm_and_ps(u, absMask), uReach), _mm_cmple_ps(_mm_and_ps(v, absMask), vReach)));
+	}
+	numColliding += maskBits[_mm_movemask_ps(on)];
+	return SidesOf(dist, on);
+}
+#endif
+
+int ClassifyExtents(const WorldPlane &plane, const float* x, const float* y, const float* z,
+	const float* normalExtents, const float* tangentExtents, const float* bitangentExtents,
+	int count, float acceptanceRange, signed char* sides)
+{
+#ifdef COLLISION_SSE2
+	SsePlane wide;
+	LoadSsePlane(plane, acceptanceRange, wide);
+	bool streaming = count >= streamingMinimum && classifyKernel.load(std::memory_order_relaxed) == KERNEL_STREAMING;
+
+	//Streaming stores must be 16 byte aligned, so the sides before the first boundary are written normally
+	int head = streaming && sides ? (int)((16 - ((size_t)sides & 15)) & 15) : 0;
+	head = std::min(head, count);
+	int numColliding = ClassifyExtentsScalar(plane, x, y, z, normalExtents, tangentExtents, bitangentExtents, head, acceptanceRange, sides);
+
+	int i = head;
+	for (; i + 16 <= count; i += 16)
+	{
+		if (streaming)
+		{
+			_mm_prefetch((const char*)(x + i + streamingPrefetchDistance), _MM_HINT_NTA);
+			_mm_prefetch((const char*)(y + i + streamingPrefetchDistance), _MM_HINT_NTA);
+			_mm_prefetch((const char*)(z + i + streamingPrefetchDistance), _MM_HINT_NTA);
+			_mm_prefetch((const char*)(normalExtents + i + streamingPrefetchDistance), _MM_HINT_NTA);
+		}
+
+		__m128i packed[4];
+		for (int j = 0; j < 4; j++)
+		{
+			int k = i + j * 4;
+			packed[j] = ClassifyFourExtents(wide, x + k, y + k, z + k, normalExtents + k,
+				wide.finite ? tangentExtents + k : nullptr, wide.finite ? bitangentExtents + k : nullptr, numColliding);
+		}
+
+		if (sides)
+		{
+			__m128i bytes = _mm_packs_epi16(_mm_packs_epi32(packed[0], packed[1]), _mm_packs_epi32(packed[2], packed[3]));
+			if (streaming) _mm_stream_si128((__m128i*)(sides + i), bytes);
+			else _mm_storeu_si128((__m128i*)(sides + i), bytes);
+		}
+	}
+
+	//Streaming stores are weakly ordered, so they must be finished before anyone reads the sides
+	if (streaming) _mm_sfence();
+
+	numColliding += ClassifyExtentsScalar(plane, x + i, y + i, z + i, normalExtents + i,
+		tangentExtents ? tangentExtents + i : nullptr, bitangentExtents ? bitangentExtents + i : nullptr,
+		count - i, acceptanceRange, sides ? sides + i : nullptr);
+#else
+	int numColliding = ClassifyExtentsScalar(plane, x, y, z, normalExtents, tangentExtents, bitangentExtents, count, acceptanceRange, sides);
+#endif
+
+	telemetry->RecordPoints(count, numColliding);
+	return numColliding;
+}
@@ -0,0 +1,286 @@
+/*
+Title: Point - Plane
+File Name: Collision.h
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+The point - plane collision tests. TestCollision checks a single point against
+a plane collider and its model matrix. The batch kernels check many points at once
+against a plane which has already been moved into world space, with the points
+stored as separate arrays of x, y and z coordinates. The shape kernel extends
+the same test to convex shapes by how far each one reaches towards the plane.
+*/
+
+#ifndef _COLLISION_H
+#define _COLLISION_H
+
+//Only the math library, so the kernels build without OpenGL
+#include <iostream>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include "glm\glm.hpp"
+#include "glm\gtc\matrix_transform.hpp"
+#include "glm\gtc\type_ptr.hpp"
+#include "glm\gtc\quaternion.hpp"
+#include "glm\gtx\quaternion.hpp"
+
+//Points represent ifinitesimal volumes and are supposed to indicate exact positions instead.
+//Therefore, because a point would theoretically have no volume (or the smallest measurable amount)
+//it is very difficult for a point to exactly intersect a plane (which is infinitely thin).
+//
+//The point being drawn on the screen is a much larger representation of the point which actually exists in that space.
+//To make the representation of the point accurately display the intersection of the point
+//and the plane, we must accept all non-collisions within a certain range.
+//This range we will call our acceptance range. It is a number I made up that makes our representation of a point
+//appear to be more accurately colliding with our plane. This should be set (Or not set) depending on your application.
+const float pointAcceptanceRange = 0.002f;
+
+//A plane collider struct
+struct Plane
+{
+	glm::vec3 normal;
+
+	///
+	//Generates a plane with a normal pointing down the X axis
+	Plane()
+	{
+		normal = glm::vec3(1.0f, 0.0f, 0.0f);
+	}
+
+	///
+	//Generates a plane with a given normal
+	Plane(glm::vec3 norm)
+	{
+		normal = norm;
+	}
+};
+
+//A body is on the collision layers set in its layer bits, and collides with the layers
+//set in its mask. Debug markers on their own layer can then be kept off the floor planes.
+const unsigned int LAYER_DEFAULT = 1u;
+const unsigned int LAYERS_ALL = 0xFFFFFFFFu;
+
+//The collision layers of a body
+struct CollisionFilter
+{
+	unsigned int layer;
+	unsigned int mask;
+
+	CollisionFilter()
+	{
+		layer = LAYER_DEFAULT;
+		mask = LAYERS_ALL;
+	}
+
+	CollisionFilter(unsigned int bodyLayer, unsigned int bodyMask)
+	{
+		layer = bodyLayer;
+		mask = bodyMask;
+	}
+
+	///
+	//Returns true if two bodies should be tested against each other,
+	//which they are when each one's mask holds a layer of the other
+	bool Interacts(const CollisionFilter &other) const
+	{
+		return (layer & other.mask) != 0 && (other.layer & mask) != 0;
+	}
+};
+
+//A plane in world space, cached so that it can be tested against many points.
+//A point p lies on the plane when dot(normal, p) == distance.
+struct WorldPlane
+{
+	glm::vec3 normal;
+	float distance;
+
+	//Finite planes only accept points whose projection falls within halfExtent
+	//of the center along both the tangent and the bitangent. Infinite planes have a halfExtent of 0.
+	glm::vec3 center;
+	glm::vec3 tangent;
+	glm::vec3 bitangent;
+	float halfExtent;
+
+	CollisionFilter filter;
+
+	WorldPlane()
+	{
+		normal = glm::vec3(1.0f, 0.0f, 0.0f);
+		distance = 0.0f;
+		center = glm::vec3(0.0f);
+		tangent = glm::vec3(0.0f, 1.0f, 0.0f);
+		bitangent = glm::vec3(0.0f, 0.0f, 1.0f);
+		halfExtent = 0.0f;
+	}
+};
+
+//The result of classifying a point against a plane
+enum PlaneSide
+{
+	SIDE_BEHIND = -1,
+	SIDE_ON = 0,
+	SIDE_FRONT = 1,
+	SIDE_IGNORED = 2	//Never tested, as the collision layers of the pair don't interact
+};
+
+///
+//Tests for collisions between a point and a plane
+//
+//Overview:
+//	This algorithm tests collisions between a point and a plane by using the
+//	mathematical definition of a plane. First, we get the normal of the plane in world space.
+//	Then we must shift both objects such that the plane is at the origin of the coordinate system.
+//	Finally, we can perform a dot product of the point with the normal. If the dot product is zero
+//	then we have a collision.
+//
+//Parameters:
+//	pCollider: The plane's collider
+//	pModelMatrix: The plane's model to world transformation matrix
+//	point: The point in worldspace
+//
+//Returns:
+//	true if a collision is detected, else false
+bool TestCollision(const Plane &pCollider, const glm::mat4 &pModelMatrix, glm::vec3 point);
+
+///
+//Moves a plane collider into world space so it can be tested against many points
+//
+//Parameters:
+//	pCollider: The plane's collider
+//	pModelMatrix: The plane's model to world transformation matrix
+//
+//Returns:
+//	The infinite world space plane
+WorldPlane MakeWorldPlane(const Plane &pCollider, const glm::mat4 &pModelMatrix);
+
+///
+//Builds a world space plane from a normal and a point on the plane
+//
+//Parameters:
+//	normal: The plane normal
+//	center: A point on the plane, and the center of finite planes
+//	halfExtent: Half the width of a finite plane, or 0 for an infinite plane
+//
+//Returns:
+//	The world space plane
+WorldPlane MakeWorldPlane(glm::vec3 normal, glm::vec3 center, float halfExtent);
+
+///
+//Classifies a batch of points against a world space plane
+//
+//Overview:
+//	This is the same test as TestCollision, but the plane has already been moved into
+//	world space, so each point costs a single dot product. The points are given as
+//	separate coordinate arrays so the loop reads memory in order.
+//
+//Parameters:
+//	plane: The world space plane
+//	x, y, z: The point coordinates
+//	count: The number of points
+//	acceptanceRange: Points this close to the plane are considered colliding
+//	sides: Filled with the PlaneSide of each point, may be nullptr
+//
+//Returns:
+//	The number of points colliding with the plane
+int ClassifyPoints(const WorldPlane &plane, const float* x, const float* y, const float* z, int count, float acceptanceRange, signed char* sides);
+
+//The loops ClassifyPoints can run on large batches
+enum ClassifyKernel
+{
+	KERNEL_CACHED,		//Plain loads and stores, which leave the points and sides in the caches
+	KERNEL_STREAMING	//Prefetches ahead of the points and writes the sides around the caches
+};
+
+//Batches smaller than this always run the cached kernel, since their sides are usually read again soon
+const int streamingMinimum = 1 << 14;
+
+///
+//Sets the kernel ClassifyPoints and ClassifyExtents run on batches of at least streamingMinimum points
+void SetClassifyKernel(ClassifyKernel kernel);
+
+///
+//Returns the kernel ClassifyPoints and ClassifyExtents run on large batches
+ClassifyKernel GetClassifyKernel();
+
+///
+//Parses the name of a kernel: cached or streaming
+//
+//Returns:
+//	true if the name was recognized
+bool ParseClassifyKernel(const std::string &name, ClassifyKernel &kernel);
+
+///
+//Classifies a batch of points the same way as ClassifyPoints, without filling the caches with them
+//
+//Overview:
+//	A batch test reads every point once and writes every side once, so keeping either
+//	in the caches only pushes out the data the rest of the frame is working on. This
+//	loop prefetches the points a fixed distance ahead with a non-temporal hint, so they
+//	pass through without settling in the outer caches, and writes the sides with
+//	non-temporal stores, which go straight to memory. The results are the same as
+//	ClassifyPoints. Processors without SSE2 run the cached loop instead.
+//
+//Parameters:
+//	plane: The world space plane
+//	x, y, z: The point coordinates
+//	count: The number of points
+//	acceptanceRange: Points this close to the plane are considered colliding
+//	sides: Filled with the PlaneSide of each point, may be nullptr
+//
+//Returns:
+//	The number of points colliding with the plane
+int ClassifyPointsStreaming(const WorldPlane &plane, const float* x, const float* y, const float* z, int count, float acceptanceRange, signed char* sides);
+
+///
+//Classifies a batch of convex shapes against a world space plane
+//
+//Overview:
+//	A convex shape collides with a plane when the signed distance of its center is
+//	no further from zero than the shape reaches along the normal (its support extent).
+//	Spheres, boxes and capsules only differ in how that extent is found, so they all
+//	share this kernel. A point reaches nowhere, and with extents of 0 this is ClassifyPoints.
+//	Against a finite plane the center must also lie within halfExtent of the plane's
+//	center, widened by how far the shape reaches along the tangent and bitangent.
+//	That finite test is conservative: each axis is widened on its own, so it never
+//	misses a shape which touches the plane, but a shape near an edge or corner whose
+//	reach along the normal and along the plane come from different parts of it can be
+//	reported SIDE_ON without touching the plane. Infinite planes are tested exactly.
+//	Four shapes are tested at once where SSE2 is available, and the streaming kernel
+//	is used the same way as in ClassifyPoints.
+//
+//Parameters:
+//	plane: The world space plane
+//	x, y, z: The shape centers
+//	normalExtents: How far each shape reaches along the plane normal
+//	tangentExtents, bitangentExtents: How far each shape reaches along the tangent and
+//		bitangent. Only read for finite planes, may be nullptr for infinite ones.
+//	count: The number of shapes
+//	acceptanceRange: Shapes this close to the plane are considered colliding
+//	sides: Filled with the PlaneSide of each shape, may be nullptr
+//
+//Returns:
+//	The number of shapes colliding with the plane
+int ClassifyExtents(const WorldPlane &plane, const float* x, const float* y, const float* z,
+	const float* normalExtents, const float* tangentExtents, const float* bitangentExtents,
+	int count, float acceptanceRange, signed char* sides);
+
+#endif //_COLLISION_H
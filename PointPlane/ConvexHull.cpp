@@ -0,0 +1,210 @@
+/*
+Title: Point - Plane
+File Name: ConvexHull.cpp
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+Convex hull colliders tested against planes.
+*/
+
+#include "ConvexHull.h"
+
+//x64 always has SSE2, and 32 bit MSVC builds have it with /arch:SSE2 or later
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CONVEX_HULL_SSE2
+#include <emmintrin.h>
+#endif
+
+void ConvexHull::Build(const std::vector<glm::vec3> &vertices, const std::vector<int> &triangles)
+{
+	int count = (int)vertices.size();
+	x.resize(count);
+	y.resize(count);
+	z.resize(count);
+	for (int i = 0; i < count; i++)
+	{
+		x[i] = vertices[i].x;
+		y[i] = vertices[i].y;
+		z[i] = vertices[i].z;
+	}
+
+	//Collect both directions of every edge, then sort so each vertex's neighbours are together
+	std::vector<std::pair<int, int>> edges;
+	edges.reserve(triangles.size() * 2);
+	for (size_t i = 0; i + 2 < triangles.size(); i += 3)
+	{
+		for (int j = 0; j < 3; j++)
+		{
+			int a = triangles[i + j], b = triangles[i + (j + 1) % 3];
+			edges.push_back(std::make_pair(a, b));
+			edges.push_back(std::make_pair(b, a));
+		}
+	}
+	std::sort(edges.begin(), edges.end());
+	edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+	neighborStart.assign(count + 1, 0);
+	neighbors.resize(edges.size());
+	for (size_t i = 0; i < edges.size(); i++)
+	{
+		neighborStart[edges[i].first + 1]++;
+		neighbors[i] = edges[i].second;
+	}
+	for (int i = 0; i < count; i++)
+		neighborStart[i + 1] += neighborStart[i];
+}
+
+int ConvexHull::SupportScan(glm::vec3 direction) const
+{
+	int count = (int)Size();
+	float dx = direction.x, dy = direction.y, dz = direction.z;
+
+	int best = 0;
+	float bestDistance = -FLT_MAX;
+	int i = 0;
+
+#ifdef CONVEX_HULL_SSE2
+	if (count >= 4)
+	{
+		//Each lane keeps the furthest of every fourth vertex. Lanes only move on to a vertex
+		//strictly further along, so each keeps the first of its equally far vertices.
+		__m128 wideX = _mm_set1_ps(dx), wideY = _mm_set1_ps(dy), wideZ = _mm_set1_ps(dz);
+		__m128 laneDistance = _mm_set1_ps(-FLT_MAX);
+		__m128i laneIndex = _mm_setzero_si128();
+		__m128i index = _mm_setr_epi32(0, 1, 2, 3);
+		const __m128i four = _mm_set1_epi32(4);
+		for (; i + 4 <= count; i += 4)
+		{
+			__m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(wideX, _mm_loadu_ps(&x[i])), _mm_mul_ps(wideY, _mm_loadu_ps(&y[i]))), _mm_mul_ps(wideZ, _mm_loadu_ps(&z[i])));
+			__m128 further = _mm_cmpgt_ps(distance, laneDistance);
+			__m128i furtherIndex = _mm_castps_si128(further);
+			laneDistance = _mm_max_ps(distance, laneDistance);
+			laneIndex = _mm_or_si128(_mm_and_si128(furtherIndex, index), _mm_andnot_si128(furtherIndex, laneIndex));
+			index = _mm_add_epi32(index, four);
+		}
+
+		//The furthest lane wins, and of equally far lanes the one with the first vertex
+		float distances[4];
+		int indices[4];
+		_mm_storeu_ps(distances, laneDistance);
+		_mm_storeu_si128((__m128i*)indices, laneIndex);
+		best = indices[0];
+		bestDistance = distances[0];
+		for (int lane = 1; lane < 4; lane++)
+		{
+			if (distances[lane] > bestDistance || (distances[lane] == bestDistance && indices[lane] < best))
+			{
+				bestDistance = distances[lane];
+				best = indices[lane];
+			}
+		}
+	}
+#endif
+
+	//The vertices left over, or every vertex without SSE2
+	for (; i < count; i++)
+	{
+		float distance = dx * x[i] + dy * y[i] + dz * z[i];
+		if (distance > bestDistance)
+		{
+			bestDistance = distance;
+			best = i;
+		}
+	}
+	return best;
+}
+
+int ConvexHull::SupportClimb(glm::vec3 direction, int start, int maxSteps, int* numSteps) const
+{
+	float dx = direction.x, dy = direction.y, dz = direction.z;
+
+	int current = start;
+	float currentDistance = dx * x[current] + dy * y[current] + dz * z[current];
+
+	for (int step = 0; step < maxSteps; step++)
+	{
+		//Move to the neighbour furthest along, if any is further than here
+		int next = current;
+		float nextDistance = currentDistance;
+		for (int i = neighborStart[current]; i < neighborStart[current + 1]; i++)
+		{
+			int n = neighbors[i];
+			float distance = dx * x[n] + dy * y[n] + dz * z[n];
+			if (distance > nextDistance)
+			{
+				nextDistance = distance;
+				next = n;
+			}
+		}
+
+		if (next == current)
+		{
+			if (numSteps) *numSteps = step;
+			return current;
+		}
+		current = next;
+		currentDistance = nextDistance;
+	}
+
+	if (numSteps) *numSteps = maxSteps;
+	return -1;
+}
+
+int HullCollider::Support(glm::vec3 direction, int &last)
+{
+	int steps = 0;
+	int budget = maxClimbSteps > 0 ? maxClimbSteps : (int)hull->Size() / 8 + 8;
+	int support = hull->neighbors.empty() ? -1 : hull->SupportClimb(direction, last, budget, &steps);
+	numSteps += steps;
+
+	if (support < 0)
+	{
+		support = hull->SupportScan(direction);
+		numScans++;
+	}
+
+	last = support;
+	return support;
+}
+
+PlaneSide HullCollider::Classify(const WorldPlane &plane, const glm::mat4 &modelMatrix, float acceptanceRange, float* minDistance, float* maxDistance)
+{
+	numQueries++;
+
+	//dot(n, M * v) = dot(transpose(M) * n, v) + dot(n, translation), so the
+	//hull's vertices are searched along the normal moved into local space
+	glm::vec3 localNormal = glm::transpose(glm::mat3(modelMatrix)) * plane.normal;
+	float offset = glm::dot(plane.normal, glm::vec3(modelMatrix[3])) - plane.distance;
+
+	int front = Support(localNormal, lastFront);
+	int back = Support(-localNormal, lastBack);
+
+	const ConvexHull &h = *hull;
+	float maxDist = glm::dot(localNormal, glm::vec3(h.x[front], h.y[front], h.z[front])) + offset;
+	float minDist = glm::dot(localNormal, glm::vec3(h.x[back], h.y[back], h.z[back])) + offset;
+	if (minDistance) *minDistance = minDist;
+	if (maxDistance) *maxDistance = maxDist;
+
+	float range = FLT_EPSILON + acceptanceRange;
+	if (minDist > range) return SIDE_FRONT;
+	if (maxDist < -range) return SIDE_BEHIND;
+	return SIDE_ON;
+}
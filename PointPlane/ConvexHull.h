@@ -0,0 +1,139 @@
+/*
+Title: Point - Plane
+File Name: ConvexHull.h
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+Convex hull colliders tested against planes.
+
+A convex hull collides with a plane when its vertices are not all on the
+same side, so only the vertex furthest along the normal and the vertex
+furthest against it (the support vertices) need to be checked.
+
+Finding a support vertex by testing every vertex costs O(V). On a convex
+hull the distance along a direction has no local maximum other than the
+global one, so starting from any vertex and repeatedly stepping to a
+neighbour which is further along always ends at the support vertex. When a
+plane rotates a little each frame, the support vertex is a neighbour or two
+from last frame's, so starting from it makes most queries a handful of
+steps. If a climb takes too many steps, every vertex is scanned instead.
+*/
+
+#ifndef _CONVEX_HULL_H
+#define _CONVEX_HULL_H
+
+#include "Collision.h"
+
+struct ConvexHull
+{
+	//Vertices in the hull's local space
+	std::vector<float> x, y, z;
+
+	//The neighbours of vertex i are neighbors[neighborStart[i]] up to neighbors[neighborStart[i + 1]]
+	std::vector<int> neighborStart;
+	std::vector<int> neighbors;
+
+	size_t Size() const
+	{
+		return x.size();
+	}
+
+	///
+	//Builds the hull and its vertex adjacency from a closed convex triangle mesh
+	//
+	//Parameters:
+	//	vertices: The vertices, which must all lie on the hull
+	//	triangles: Three vertex indices per face
+	void Build(const std::vector<glm::vec3> &vertices, const std::vector<int> &triangles);
+
+	///
+	//Finds the vertex furthest along a direction by testing every vertex, four at a time where SSE2 is available.
+	//Of equally far vertices the first is returned.
+	int SupportScan(glm::vec3 direction) const;
+
+	///
+	//Finds the vertex furthest along a direction by walking the adjacency
+	//
+	//Parameters:
+	//	direction: The direction to search along
+	//	start: The vertex to start from
+	//	maxSteps: Most steps to take before giving up
+	//	numSteps: Set to the number of steps taken, may be nullptr
+	//
+	//Returns:
+	//	The support vertex, or -1 if it wasn't reached within maxSteps
+	int SupportClimb(glm::vec3 direction, int start, int maxSteps, int* numSteps) const;
+};
+
+//Tests one convex hull against planes, remembering its support vertices between queries
+struct HullCollider
+{
+	const ConvexHull* hull;
+
+	//Support vertices found by the last query, where the next climbs start
+	int lastFront;
+	int lastBack;
+
+	//Climbs which take more steps than this fall back to scanning every vertex.
+	//0 allows an eighth of the vertex count, as a step tests about six neighbours
+	//and a scan becomes the cheaper choice at around that many.
+	int maxClimbSteps;
+
+	//Work done so far
+	long long numQueries;
+	long long numSteps;
+	long long numScans;
+
+	HullCollider()
+	{
+		hull = nullptr;
+		lastFront = 0;
+		lastBack = 0;
+		maxClimbSteps = 0;
+		numQueries = 0;
+		numSteps = 0;
+		numScans = 0;
+	}
+
+	///
+	//Finds the vertex furthest along a direction, starting from a previous answer
+	//
+	//Parameters:
+	//	direction: The direction in the hull's local space
+	//	last: The previous support vertex along about the same direction, updated with the answer
+	int Support(glm::vec3 direction, int &last);
+
+	///
+	//Classifies the hull against a plane
+	//
+	//Parameters:
+	//	plane: The world space plane. Finite planes are treated as infinite.
+	//	modelMatrix: The hull's model to world transformation matrix
+	//	acceptanceRange: Hulls this close to the plane are considered colliding
+	//	minDistance, maxDistance: If not nullptr, set to the signed distances of the
+	//		support vertices against and along the normal
+	//
+	//Returns:
+	//	SIDE_ON if the hull touches the plane, else the side the whole hull is on
+	PlaneSide Classify(const WorldPlane &plane, const glm::mat4 &modelMatrix, float acceptanceRange, float* minDistance, float* maxDistance);
+};
+
+#endif //_CONVEX_HULL_H
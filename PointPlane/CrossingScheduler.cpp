@@ -0,0 +1,258 @@
+/*
+Title: Point - Plane
+File Name: CrossingScheduler.cpp
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+Event driven simulation of drifting points against still planes.
+*/
+
+#include "CrossingScheduler.h"
+#include <cfloat>
+#include <climits>
+
+bool CrossingScheduler::Reset(const Scene &scene, float range)
+{
+	for (size_t i = 0; i < scene.planes.size(); i++)
+	{
+		if (scene.planes[i].halfExtent > 0.0f)
+		{
+			std::cout << "Crossing times can only be predicted for infinite planes" << std::endl;
+			return false;
+		}
+	}
+	if (scene.motion == MOTION_ORBIT)
+	{
+		std::cout << "Crossing times can only be predicted for points with constant velocity" << std::endl;
+		return false;
+	}
+
+	//Every point has an event for each plane and one for wrapping, and the queue indexes them with an int
+	long long numIds = (long long)scene.points.Size() * ((long long)scene.planes.size() + 1);
+	if (numIds > INT_MAX)
+	{
+		std::cout << "Too many points and planes to schedule: " << numIds << " events" << std::endl;
+		return false;
+	}
+
+	planes = scene.planes;
+	points = scene.points;
+	acceptanceRange = range;
+	extent = scene.motion == MOTION_DRIFT ? scene.extent : 0.0f;
+	now = 0.0;
+	numColliding = 0;
+	numEvents = 0;
+
+	int numPoints = (int)points.Size();
+	int numPlanes = (int)planes.size();
+	baseTimes.assign(numPoints, 0.0);
+	sides.resize((size_t)numPoints * numPlanes);
+	queue.Reset((int)numIds);
+
+	for (int i = 0; i < numPoints; i++)
+	{
+		//Generated points may start outside the scene, StepScene wraps them on the first step
+		if (extent > 0.0f)
+		{
+			float* position[3] = { &points.x[i], &points.y[i], &points.z[i] };
+			for (int k = 0; k < 3; k++)
+			{
+				if (*position[k] > extent) *position[k] -= 2.0f * extent;
+				else if (*position[k] < -extent) *position[k] += 2.0f * extent;
+			}
+		}
+
+		for (int j = 0; j < numPlanes; j++)
+		{
+			signed char &side = sides[(size_t)i * numPlanes + j];
+			numColliding += ClassifyPoints(planes[j], &points.x[i], &points.y[i], &points.z[i], 1, acceptanceRange, &side);
+			Predict(i, j);
+		}
+		PredictWrap(i);
+	}
+
+	return true;
+}
+
+void CrossingScheduler::Rebase(int point)
+{
+	float dt = (float)(now - baseTimes[point]);
+	points.x[point] += points.vx[point] * dt;
+	points.y[point] += points.vy[point] * dt;
+	points.z[point] += points.vz[point] * dt;
+	baseTimes[point] = now;
+}
+
+void CrossingScheduler::Predict(int point, int plane)
+{
+	int numPlanes = (int)planes.size();
+	int id = point * (numPlanes + 1) + plane;
+	const WorldPlane &p = planes[plane];
+
+	float speed = glm::dot(p.normal, glm::vec3(points.vx[point], points.vy[point], points.vz[point]));
+	float dist = p.normal.x * points.x[point] + p.normal.y * points.y[point] + p.normal.z * points.z[point] - p.distance;
+	float range = FLT_EPSILON + acceptanceRange;
+
+	//Which edge of the range the point reaches next, if it ever does
+	float edge;
+	signed char side = sides[(size_t)point * numPlanes + plane];
+	if (side == SIDE_ON && speed != 0.0f) edge = speed > 0.0f ? range : -range;
+	else if (side == SIDE_FRONT && speed < 0.0f) edge = range;
+	else if (side == SIDE_BEHIND && speed > 0.0f) edge = -range;
+	else
+	{
+		queue.Remove(id);
+		return;
+	}
+
+	double time = baseTimes[point] + (double)(edge - dist) / speed;
+	queue.Set(id, std::max(time, now));
+}
+
+//Returns the time until a point reaches the edge of the scene, and which axis it reaches it on
+static double TimeToWrap(const PointSet &points, int point, float extent, int &axis)
+{
+	float position[3] = { points.x[point], points.y[point], points.z[point] };
+	float velocity[3] = { points.vx[point], points.vy[point], points.vz[point] };
+
+	double soonest = DBL_MAX;
+	axis = -1;
+	for (int i = 0; i < 3; i++)
+	{
+		if (velocity[i] == 0.0f) continue;
+
+		double time = (double)((velocity[i] > 0.0f ? extent : -extent) - position[i]) / velocity[i];
+		if (time < soonest)
+		{
+			soonest = time;
+			axis = i;
+		}
+	}
+	return soonest;
+}
+
+void CrossingScheduler::PredictWrap(int point)
+{
+	int id = point * ((int)planes.size() + 1) + (int)planes.size();
+
+	int axis;
+	double time = TimeToWrap(points, point, extent, axis);
+	if (extent <= 0.0f || axis < 0)
+	{
+		queue.Remove(id);
+		return;
+	}
+
+	queue.Set(id, std::max(baseTimes[point] + time, now));
+}
+
+void CrossingScheduler::Reclassify(int point, std::vector<CrossingEvent>* events)
+{
+	int numPlanes = (int)planes.size();
+	for (int j = 0; j < numPlanes; j++)
+	{
+		signed char &side = sides[(size_t)point * numPlanes + j];
+		signed char from = side;
+		ClassifyPoints(planes[j], &points.x[point], &points.y[point], &points.z[point], 1, acceptanceRange, &side);
+		if (side == from) continue;
+
+		numColliding += (side == SIDE_ON) - (from == SIDE_ON);
+		if (events)
+		{
+			CrossingEvent event = { now, point, j, from, side };
+			events->push_back(event);
+		}
+	}
+}
+
+int CrossingScheduler::AdvanceTo(double time, std::vector<CrossingEvent>* events)
+{
+	int numPlanes = (int)planes.size();
+	int numRun = 0;
+
+	while (!queue.Empty() && queue.TopKey() <= time)
+	{
+		int id = queue.Top();
+		int point = id / (numPlanes + 1);
+		int plane = id % (numPlanes + 1);
+		now = std::max(now, queue.TopKey());
+		numRun++;
+
+		if (plane == numPlanes)
+		{
+			//Find the axis before moving, the move itself may land a hair short of the edge
+			int axis;
+			TimeToWrap(points, point, extent, axis);
+			Rebase(point);
+
+			float* position[3] = { &points.x[point], &points.y[point], &points.z[point] };
+			float velocity[3] = { points.vx[point], points.vy[point], points.vz[point] };
+			for (int i = 0; i < 3; i++)
+			{
+				if (i == axis) *position[i] = velocity[i] > 0.0f ? -extent : extent;
+				else if (*position[i] > extent) *position[i] -= 2.0f * extent;
+				else if (*position[i] < -extent) *position[i] += 2.0f * extent;
+			}
+
+			Reclassify(point, events);
+			for (int j = 0; j < numPlanes; j++)
+				Predict(point, j);
+			PredictWrap(point);
+		}
+		else
+		{
+			//The point reached an edge of the range, so it moves one side along
+			signed char &side = sides[(size_t)point * numPlanes + plane];
+			signed char from = side;
+			float speed = glm::dot(planes[plane].normal, glm::vec3(points.vx[point], points.vy[point], points.vz[point]));
+
+			if (side == SIDE_ON) side = (signed char)(speed > 0.0f ? SIDE_FRONT : SIDE_BEHIND);
+			else side = SIDE_ON;
+
+			numColliding += (side == SIDE_ON) - (from == SIDE_ON);
+			if (events)
+			{
+				CrossingEvent event = { now, point, plane, from, side };
+				events->push_back(event);
+			}
+
+			Predict(point, plane);
+		}
+	}
+
+	numEvents += numRun;
+	now = std::max(now, time);
+	return numRun;
+}
+
+void CrossingScheduler::CurrentPositions(PointSet &out) const
+{
+	out = points;
+
+	int count = (int)points.Size();
+	for (int i = 0; i < count; i++)
+	{
+		float dt = (float)(now - baseTimes[i]);
+		out.x[i] += points.vx[i] * dt;
+		out.y[i] += points.vy[i] * dt;
+		out.z[i] += points.vz[i] * dt;
+	}
+}
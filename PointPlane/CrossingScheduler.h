@@ -0,0 +1,138 @@
+/*
+Title: Point - Plane
+File Name: CrossingScheduler.h
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+Event driven simulation of drifting points against still planes.
+
+A point moving with constant velocity v has signed distance
+	s(t) = s0 + dot(n, v) * (t - t0)
+from a plane, so the time at which it next enters or leaves the acceptance
+range can be solved for directly instead of found by testing every frame.
+Every point - plane pair has its next crossing time in an indexed heap, and
+every point also has the time at which it next wraps around the edge of the
+scene. Advancing the simulation pops events in time order until the heap's
+earliest event is in the future, so a frame in which nothing crosses costs
+one look at the top of the heap.
+
+Points aren't moved every frame either. Each keeps its position at the time
+of its last event, and is only brought forward when an event of its own
+happens. A crossing only changes the side of one pair, so only that pair is
+predicted again. A wrap teleports the point, so all of its pairs are.
+*/
+
+#ifndef _CROSSING_SCHEDULER_H
+#define _CROSSING_SCHEDULER_H
+
+#include "Scene.h"
+#include "IndexedHeap.h"
+
+//A point changing side of a plane at a predicted time
+struct CrossingEvent
+{
+	double time;
+	int point;
+	int plane;
+	signed char from;	//The PlaneSide before the crossing
+	signed char to;		//The PlaneSide after the crossing
+};
+
+struct CrossingScheduler
+{
+	//The planes, which must be infinite and never move
+	std::vector<WorldPlane> planes;
+
+	//Position of every point at its base time, and its velocity
+	PointSet points;
+	std::vector<double> baseTimes;
+
+	//The current PlaneSide of every pair, all the planes of a point together
+	std::vector<signed char> sides;
+
+	//Next event of every pair, id point * (planes + 1) + plane. The id with
+	//plane == planes.size() is the point's next wrap around the scene's edge.
+	IndexedHeap queue;
+
+	float acceptanceRange;
+	float extent;	//Points wrap to stay within [-extent, extent], 0 for no wrapping
+	double now;
+	long long numColliding;
+	long long numEvents;
+
+	CrossingScheduler()
+	{
+		acceptanceRange = pointAcceptanceRange;
+		extent = 0.0f;
+		now = 0.0;
+		numColliding = 0;
+		numEvents = 0;
+	}
+
+	///
+	//Classifies every pair and predicts its first event
+	//
+	//Parameters:
+	//	scene: The scene to simulate. Its points drift with their velocities and
+	//		wrap at the scene's extent, as StepScene moves MOTION_DRIFT scenes.
+	//	range: Points this close to a plane are considered colliding
+	//
+	//Returns:
+	//	false if the scene has a finite plane, which crossing times aren't predicted for
+	bool Reset(const Scene &scene, float range);
+
+	///
+	//Runs every event up to a time
+	//
+	//Parameters:
+	//	time: The time to advance to, in seconds since Reset
+	//	events: If not nullptr, every side change is added to it in time order
+	//
+	//Returns:
+	//	The number of events run, crossings and wraps
+	int AdvanceTo(double time, std::vector<CrossingEvent>* events);
+
+	///
+	//Returns the current PlaneSide of a pair
+	PlaneSide SideOf(int point, int plane) const
+	{
+		return (PlaneSide)sides[(size_t)point * planes.size() + plane];
+	}
+
+	///
+	//Fills a point set with the position of every point at the current time
+	void CurrentPositions(PointSet &out) const;
+
+private:
+	//Moves a point to the current time
+	void Rebase(int point);
+
+	//Predicts and queues the next crossing of a pair, from the point's base position
+	void Predict(int point, int plane);
+
+	//Predicts and queues the next wrap of a point
+	void PredictWrap(int point);
+
+	//Classifies every plane of a point again after it wraps
+	void Reclassify(int point, std::vector<CrossingEvent>* events);
+};
+
+#endif //_CROSSING_SCHEDULER_H
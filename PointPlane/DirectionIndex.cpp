@@ -0,0 +1,198 @@
+/*
+Title: Point - Plane
+File Name: DirectionIndex.cpp
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+Projection indices for many directions, so planes which rotate can still be
+queried without testing every point.
+*/
+
+#include "DirectionIndex.h"
+#include <map>
+
+//Returns the index of the vertex halfway between two vertices, adding it if needed
+static int Midpoint(int a, int b, std::vector<glm::vec3> &vertices, std::map<std::pair<int, int>, int> &midpoints)
+{
+	std::pair<int, int> edge(std::min(a, b), std::max(a, b));
+	std::map<std::pair<int, int>, int>::iterator found = midpoints.find(edge);
+	if (found != midpoints.end()) return found->second;
+
+	vertices.push_back(glm::normalize(vertices[a] + vertices[b]));
+	int index = (int)vertices.size() - 1;
+	midpoints[edge] = index;
+	return index;
+}
+
+void GeodesicSphere(int subdivisions, std::vector<glm::vec3> &vertices, std::vector<int>* faceList)
+{
+	//Start with an icosahedron
+	float t = (1.0f + sqrtf(5.0f)) * 0.5f;
+	glm::vec3 corners[12] =
+	{
+		glm::vec3(-1, t, 0), glm::vec3(1, t, 0), glm::vec3(-1, -t, 0), glm::vec3(1, -t, 0),
+		glm::vec3(0, -1, t), glm::vec3(0, 1, t), glm::vec3(0, -1, -t), glm::vec3(0, 1, -t),
+		glm::vec3(t, 0, -1), glm::vec3(t, 0, 1), glm::vec3(-t, 0, -1), glm::vec3(-t, 0, 1)
+	};
+	int faces[20][3] =
+	{
+		{ 0, 11, 5 }, { 0, 5, 1 }, { 0, 1, 7 }, { 0, 7, 10 }, { 0, 10, 11 },
+		{ 1, 5, 9 }, { 5, 11, 4 }, { 11, 10, 2 }, { 10, 7, 6 }, { 7, 1, 8 },
+		{ 3, 9, 4 }, { 3, 4, 2 }, { 3, 2, 6 }, { 3, 6, 8 }, { 3, 8, 9 },
+		{ 4, 9, 5 }, { 2, 4, 11 }, { 6, 2, 10 }, { 8, 6, 7 }, { 9, 8, 1 }
+	};
+
+	vertices.clear();
+	for (int i = 0; i < 12; i++)
+		vertices.push_back(glm::normalize(corners[i]));
+
+	std::vector<int> triangles(&faces[0][0], &faces[0][0] + 60);
+
+	//Split every triangle into four
+	for (int level = 0; level < subdivisions; level++)
+	{
+		std::map<std::pair<int, int>, int> midpoints;
+		std::vector<int> split;
+		for (size_t i = 0; i < triangles.size(); i += 3)
+		{
+			int a = triangles[i], b = triangles[i + 1], c = triangles[i + 2];
+			int ab = Midpoint(a, b, vertices, midpoints);
+			int bc = Midpoint(b, c, vertices, midpoints);
+			int ca = Midpoint(c, a, vertices, midpoints);
+
+			int children[12] = { a, ab, ca, b, bc, ab, c, ca, bc, ab, bc, ca };
+			split.insert(split.end(), children, children + 12);
+		}
+		triangles.swap(split);
+	}
+
+	if (faceList) faceList->swap(triangles);
+}
+
+//Returns true for exactly one of each pair of opposite directions
+static bool InUpperHemisphere(glm::vec3 v)
+{
+	const float tolerance = 1e-6f;
+	if (v.z > tolerance) return true;
+	if (v.z < -tolerance) return false;
+	if (v.y > tolerance) return true;
+	if (v.y < -tolerance) return false;
+	return v.x > 0.0f;
+}
+
+void DirectionIndex::Build(const PointSet &points, int subdivisions)
+{
+	int count = (int)points.Size();
+
+	//Bounding sphere around the center of the bounding box
+	glm::vec3 low(FLT_MAX), high(-FLT_MAX);
+	for (int i = 0; i < count; i++)
+	{
+		glm::vec3 p(points.x[i], points.y[i], points.z[i]);
+		low = glm::min(low, p);
+		high = glm::max(high, p);
+	}
+	center = count > 0 ? (low + high) * 0.5f : glm::vec3(0.0f);
+
+	float radiusSquared = 0.0f;
+	for (int i = 0; i < count; i++)
+	{
+		glm::vec3 offset = glm::vec3(points.x[i], points.y[i], points.z[i]) - center;
+		radiusSquared = std::max(radiusSquared, glm::dot(offset, offset));
+	}
+	radius = sqrtf(radiusSquared);
+
+	//Sort the points along each direction
+	std::vector<glm::vec3> directions;
+	GeodesicSphere(subdivisions, directions, nullptr);
+
+	orderings.clear();
+	for (size_t i = 0; i < directions.size(); i++)
+	{
+		if (!InUpperHemisphere(directions[i])) continue;
+		orderings.push_back(ProjectionIndex());
+		orderings.back().Build(points, directions[i]);
+	}
+}
+
+int DirectionIndex::NearestDirection(glm::vec3 normal, bool &flipped) const
+{
+	int nearest = 0;
+	float best = -1.0f;
+	flipped = false;
+
+	for (size_t i = 0; i < orderings.size(); i++)
+	{
+		float alignment = glm::dot(normal, orderings[i].normal);
+		if (fabs(alignment) > best)
+		{
+			best = fabs(alignment);
+			nearest = (int)i;
+			flipped = alignment < 0.0f;
+		}
+	}
+	return nearest;
+}
+
+int DirectionIndex::QueryBand(const PointSet &points, const WorldPlane &plane, float acceptanceRange, std::vector<int> &hits, int* numRefined) const
+{
+	hits.clear();
+	if (orderings.empty()) return 0;
+
+	bool flipped;
+	const ProjectionIndex &ordering = orderings[NearestDirection(plane.normal, flipped)];
+	glm::vec3 u = flipped ? -ordering.normal : ordering.normal;
+
+	//dot(n, p) = dot(u, p) + shift +/- error for every point
+	glm::vec3 difference = plane.normal - u;
+	float shift = glm::dot(difference, center);
+	float error = glm::length(difference) * radius;
+
+	//Widen the slab a little more for rounding in the stored projections
+	float range = FLT_EPSILON + acceptanceRange;
+	float rounding = 8.0f * FLT_EPSILON * (fabs(plane.distance) + glm::length(center) + radius + 1.0f);
+	float low = plane.distance - shift - range - error - rounding;
+	float high = plane.distance - shift + range + error + rounding;
+
+	//The stored projections are along the ordering's normal, which is -u when flipped
+	if (flipped)
+	{
+		float swap = low;
+		low = -high;
+		high = -swap;
+	}
+
+	int first = (int)(std::lower_bound(ordering.projections.begin(), ordering.projections.end(), low) - ordering.projections.begin());
+	int last = (int)(std::upper_bound(ordering.projections.begin() + first, ordering.projections.end(), high) - ordering.projections.begin());
+
+	//Test the uncertain slab exactly, the same way ClassifyPoints does
+	float nx = plane.normal.x, ny = plane.normal.y, nz = plane.normal.z;
+	float d = plane.distance;
+	for (int i = first; i < last; i++)
+	{
+		int p = ordering.order[i];
+		float dist = nx * points.x[p] + ny * points.y[p] + nz * points.z[p] - d;
+		if (fabs(dist) <= range) hits.push_back(p);
+	}
+
+	if (numRefined) *numRefined = last - first;
+	return (int)hits.size();
+}
@@ -0,0 +1,109 @@
+/*
+Title: Point - Plane
+File Name: DirectionIndex.h
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+Projection indices for many directions, so planes which rotate can still be
+queried without testing every point.
+
+A ProjectionIndex only answers queries for planes with exactly its normal, and
+rotating a plane with the mouse changes the normal every frame. This index
+builds one ProjectionIndex for each vertex of a geodesic sphere (an icosahedron
+whose triangles are repeatedly split in four), and answers a query for any
+normal n with the ordering of the closest direction u.
+
+For a point p the two projections differ by dot(n - u, p). Splitting p into the
+center c of the points plus an offset of at most radius R from it gives
+	dot(n, p) = dot(u, p) + dot(n - u, c) +/- |n - u| * R
+so every point colliding with the plane lies within a slab of the u ordering
+which is only |n - u| * R wider than the acceptance range. Points before the
+slab are certainly behind the plane, points after it are certainly in front,
+and only the points inside the slab are tested exactly.
+*/
+
+#ifndef _DIRECTION_INDEX_H
+#define _DIRECTION_INDEX_H
+
+#include "ProjectionIndex.h"
+
+struct DirectionIndex
+{
+	//One ordering per direction. Only one of each pair of opposite directions
+	//is kept, since the ordering along -u is the ordering along u reversed.
+	std::vector<ProjectionIndex> orderings;
+
+	//Bounding sphere of the points
+	glm::vec3 center;
+	float radius;
+
+	DirectionIndex()
+	{
+		center = glm::vec3(0.0f);
+		radius = 0.0f;
+	}
+
+	///
+	//Builds an ordering of the points for every direction of a geodesic sphere
+	//
+	//Parameters:
+	//	points: The points to index
+	//	subdivisions: How many times the icosahedron is subdivided. Each level
+	//		roughly quadruples the directions and halves the slab width.
+	//		0 gives 6 directions, 1 gives 21, 2 gives 81 and 3 gives 321.
+	void Build(const PointSet &points, int subdivisions);
+
+	///
+	//Finds the indexed direction closest to a normal
+	//
+	//Parameters:
+	//	normal: The plane normal
+	//	flipped: Set to true if the closest direction points the opposite way of the normal
+	//
+	//Returns:
+	//	The index of the closest ordering
+	int NearestDirection(glm::vec3 normal, bool &flipped) const;
+
+	///
+	//Finds the points colliding with an infinite plane of any orientation
+	//
+	//Parameters:
+	//	points: The same points the index was built from
+	//	plane: The plane to test
+	//	acceptanceRange: Points this close to the plane are considered colliding
+	//	hits: Filled with the indices of the colliding points
+	//	numRefined: If not nullptr, set to the number of points which had to be tested exactly
+	//
+	//Returns:
+	//	The number of colliding points
+	int QueryBand(const PointSet &points, const WorldPlane &plane, float acceptanceRange, std::vector<int> &hits, int* numRefined) const;
+};
+
+///
+//Generates the unit vertices of a geodesic sphere
+//
+//Parameters:
+//	subdivisions: How many times the faces of the starting icosahedron are split in four
+//	vertices: Filled with the vertices
+//	triangles: If not nullptr, filled with three vertex indices per face
+void GeodesicSphere(int subdivisions, std::vector<glm::vec3> &vertices, std::vector<int>* triangles);
+
+#endif //_DIRECTION_INDEX_H
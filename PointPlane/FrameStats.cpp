@@ -0,0 +1,234 @@
+/*
+Title: Point - Plane
+File Name: FrameStats.cpp
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+Frame time statistics.
+
+The counts array of a histogram is laid out so that the first 2^(subBucketBits)
+entries count the values 0, 1, 2, ... exactly. After that each further block of
+2^(subBucketBits - 1) entries covers twice the range of the block before it,
+at half the resolution.
+*/
+
+#include "FrameStats.h"
+#include <sstream>
+#include <iomanip>
+
+//Nanoseconds per millisecond
+static const double nanosecondsPerMs = 1000000.0;
+
+//Returns the position of the highest set bit of a positive value
+static int HighestBit(unsigned long long value)
+{
+	int bit = 0;
+	if (value >> 32) { value >>= 32; bit += 32; }
+	if (value >> 16) { value >>= 16; bit += 16; }
+	if (value >> 8) { value >>= 8; bit += 8; }
+	if (value >> 4) { value >>= 4; bit += 4; }
+	if (value >> 2) { value >>= 2; bit += 2; }
+	if (value >> 1) { bit += 1; }
+	return bit;
+}
+
+#pragma region Histogram
+
+HdrHistogram::HdrHistogram(long long highestTrackableValue, int subBucketBits)
+{
+	subBucketHalfBits = subBucketBits - 1;
+	subBucketMask = (1LL << subBucketBits) - 1;
+	highestValue = highestTrackableValue;
+
+	//Add buckets until the highest value fits
+	int numBuckets = 1;
+	long long smallestUntrackable = 1LL << subBucketBits;
+	while (smallestUntrackable <= highestValue)
+	{
+		smallestUntrackable <<= 1;
+		numBuckets++;
+	}
+
+	counts.assign((size_t)(numBuckets + 1) << subBucketHalfBits, 0);
+	Reset();
+}
+
+void HdrHistogram::Reset()
+{
+	std::fill(counts.begin(), counts.end(), 0);
+	totalCount = 0;
+	minValue = 0;
+	maxValue = 0;
+	sum = 0.0;
+}
+
+int HdrHistogram::IndexOf(long long value) const
+{
+	int bucket = HighestBit((unsigned long long)(value | subBucketMask)) - subBucketHalfBits;
+	long long subBucket = value >> bucket;
+	return (int)(((long long)bucket << subBucketHalfBits) + subBucket);
+}
+
+long long HdrHistogram::LowestValueAt(int index) const
+{
+	int bucket = (index >> subBucketHalfBits) - 1;
+	long long subBucket = (index & ((1 << subBucketHalfBits) - 1)) + (1LL << subBucketHalfBits);
+	if (bucket < 0)
+	{
+		subBucket -= 1LL << subBucketHalfBits;
+		bucket = 0;
+	}
+	return subBucket << bucket;
+}
+
+long long HdrHistogram::HighestValueAt(int index) const
+{
+	return LowestValueAt(index + 1) - 1;
+}
+
+void HdrHistogram::Record(long long value)
+{
+	if (value < 0) value = 0;
+	if (value > highestValue) value = highestValue;
+
+	counts[IndexOf(value)]++;
+
+	if (totalCount == 0 || value < minValue) minValue = value;
+	if (value > maxValue) maxValue = value;
+	totalCount++;
+	sum += (double)value;
+}
+
+long long HdrHistogram::ValueAtPercentile(double percentile) const
+{
+	if (totalCount == 0) return 0;
+
+	long long target = (long long)ceil(percentile / 100.0 * totalCount);
+	if (target < 1) target = 1;
+
+	long long seen = 0;
+	for (size_t i = 0; i < counts.size(); i++)
+	{
+		seen += counts[i];
+		if (seen >= target) return std::min(HighestValueAt((int)i), maxValue);
+	}
+	return maxValue;
+}
+
+void HdrHistogram::Print(std::ostream &out, double unitScale) const
+{
+	out << std::setw(14) << "Value" << std::setw(14) << "Percentile" << std::setw(14) << "Count" << std::endl;
+
+	long long seen = 0;
+	for (size_t i = 0; i < counts.size(); i++)
+	{
+		if (counts[i] == 0) continue;
+		seen += counts[i];
+		out << std::setw(14) << std::fixed << std::setprecision(4) << std::min(HighestValueAt((int)i), maxValue) / unitScale
+			<< std::setw(14) << std::setprecision(4) << 100.0 * seen / totalCount
+			<< std::setw(14) << counts[i] << std::endl;
+	}
+
+	out << std::defaultfloat;
+	out << "#[Mean = " << Mean() / unitScale << ", Min = " << minValue / unitScale << ", Max = " << maxValue / unitScale
+		<< ", Count = " << totalCount << "]" << std::endl;
+}
+
+#pragma endregion Histogram
+
+#pragma region Frame_stats
+
+//Frames longer than a minute are clamped
+static const long long longestFrame = 60LL * 1000 * 1000 * 1000;
+
+FrameStats::FrameStats()
+	: update(longestFrame), render(longestFrame), swap(longestFrame), frame(longestFrame)
+{
+}
+
+void FrameStats::Record(float updateSeconds, float renderSeconds, float swapSeconds)
+{
+	update.Record((long long)(updateSeconds * 1e9));
+	render.Record((long long)(renderSeconds * 1e9));
+	swap.Record((long long)(swapSeconds * 1e9));
+	frame.Record((long long)((updateSeconds + renderSeconds + swapSeconds) * 1e9));
+}
+
+void PrintPercentiles(std::ostream &out, const char* name, const HdrHistogram &histogram)
+{
+	out << name << ": p50 " << histogram.ValueAtPercentile(50.0) / nanosecondsPerMs
+		<< " ms, p95 " << histogram.ValueAtPercentile(95.0) / nanosecondsPerMs
+		<< " ms, p99 " << histogram.ValueAtPercentile(99.0) / nanosecondsPerMs
+		<< " ms, max " << histogram.maxValue / nanosecondsPerMs << " ms" << std::endl;
+}
+
+void FrameStats::PrintSummary(std::ostream &out) const
+{
+	out << "Frames: " << frame.totalCount << std::endl;
+	PrintPercentiles(out, "update()", update);
+	PrintPercentiles(out, "renderScene()", render);
+	PrintPercentiles(out, "swap", swap);
+	PrintPercentiles(out, "frame", frame);
+}
+
+bool FrameStats::Dump(const std::string &fileName) const
+{
+	std::ofstream file(fileName, std::ios::out);
+	if (!file.good())
+	{
+		std::cout << "Can't write file: " << fileName.data() << std::endl;
+		return false;
+	}
+
+	const char* names[] = { "update()", "renderScene()", "swap", "frame" };
+	const HdrHistogram* histograms[] = { &update, &render, &swap, &frame };
+	for (int i = 0; i < 4; i++)
+	{
+		file << "# " << names[i] << " (ms)" << std::endl;
+		histograms[i]->Print(file, nanosecondsPerMs);
+		file << std::endl;
+	}
+
+	file.close();
+	return true;
+}
+
+std::string OverlayLine(const char* name, const HdrHistogram &histogram)
+{
+	std::ostringstream line;
+	line << std::fixed << std::setprecision(2) << name
+		<< " P50 " << histogram.ValueAtPercentile(50.0) / nanosecondsPerMs
+		<< " P95 " << histogram.ValueAtPercentile(95.0) / nanosecondsPerMs
+		<< " P99 " << histogram.ValueAtPercentile(99.0) / nanosecondsPerMs
+		<< " MAX " << histogram.maxValue / nanosecondsPerMs;
+	return line.str();
+}
+
+void FrameStats::OverlayLines(std::vector<std::string> &lines) const
+{
+	lines.clear();
+	lines.push_back(OverlayLine("UPD", update));
+	lines.push_back(OverlayLine("REN", render));
+	lines.push_back(OverlayLine("SWP", swap));
+	lines.push_back(OverlayLine("FRM", frame));
+}
+
+#pragma endregion Frame_stats
@@ -0,0 +1,145 @@
+/*
+Title: Point - Plane
+File Name: FrameStats.h
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+Frame time statistics. Durations are recorded into high dynamic range (HDR)
+histograms: buckets double in width, and each bucket is split into a fixed
+number of sub buckets, so every value is stored with the same relative
+precision from nanoseconds up to minutes. The memory used is fixed when the
+histogram is created, so recording a value never allocates.
+*/
+
+#ifndef _FRAME_STATS_H
+#define _FRAME_STATS_H
+
+#include "GLIncludes.h"
+
+//A histogram with constant relative precision over a large range of values
+struct HdrHistogram
+{
+	//Each power of two range is split into 2^subBucketHalfBits sub buckets
+	int subBucketHalfBits;
+	long long subBucketMask;
+	long long highestValue;
+
+	std::vector<long long> counts;
+	long long totalCount;
+	long long minValue;
+	long long maxValue;
+	double sum;
+
+	///
+	//Creates a histogram
+	//
+	//Parameters:
+	//	highestTrackableValue: The largest value which can be recorded, larger values are clamped
+	//	subBucketBits: log2 of the sub buckets per power of two, 8 gives better than 1% precision
+	HdrHistogram(long long highestTrackableValue, int subBucketBits = 8);
+
+	///
+	//Adds a value to the histogram. Negative values are recorded as 0.
+	void Record(long long value);
+
+	///
+	//Empties the histogram
+	void Reset();
+
+	///
+	//Returns the smallest value which at least the given percentage of recorded values are less than or equal to
+	//
+	//Parameters:
+	//	percentile: From 0 to 100
+	long long ValueAtPercentile(double percentile) const;
+
+	double Mean() const
+	{
+		return totalCount > 0 ? sum / totalCount : 0.0;
+	}
+
+	///
+	//Prints every non empty bucket along with the percentile it reaches
+	//
+	//Parameters:
+	//	out: The stream to print to
+	//	unitScale: Values are divided by this before printing
+	void Print(std::ostream &out, double unitScale) const;
+
+	//Converts between values and positions in the counts array
+	int IndexOf(long long value) const;
+	long long LowestValueAt(int index) const;
+	long long HighestValueAt(int index) const;
+};
+
+//Histograms of the time spent in each stage of a frame, recorded in nanoseconds
+struct FrameStats
+{
+	HdrHistogram update;
+	HdrHistogram render;
+	HdrHistogram swap;
+	HdrHistogram frame;
+
+	FrameStats();
+
+	///
+	//Records the durations of one frame
+	//
+	//Parameters:
+	//	updateSeconds: Time spent in update()
+	//	renderSeconds: Time spent in renderScene()
+	//	swapSeconds: Time spent swapping buffers
+	void Record(float updateSeconds, float renderSeconds, float swapSeconds);
+
+	///
+	//Prints the p50/p95/p99/max of each stage in milliseconds
+	void PrintSummary(std::ostream &out) const;
+
+	///
+	//Writes the full histogram of every stage to a file
+	//
+	//Returns:
+	//	true if the file was written, else false
+	bool Dump(const std::string &fileName) const;
+
+	///
+	//Builds the lines of text shown by the in window overlay
+	void OverlayLines(std::vector<std::string> &lines) const;
+};
+
+///
+//Prints the p50/p95/p99/max of a histogram of nanoseconds, in milliseconds
+//
+//Parameters:
+//	out: The stream to print to
+//	name: Printed in front of the values
+//	histogram: The histogram to summarize
+void PrintPercentiles(std::ostream &out, const char* name, const HdrHistogram &histogram);
+
+///
+//Builds a line of overlay text with the p50/p95/p99/max of a histogram of nanoseconds
+//
+//Parameters:
+//	name: Printed in front of the values
+//	histogram: The histogram to summarize
+std::string OverlayLine(const char* name, const HdrHistogram &histogram);
+
+#endif //_FRAME_STATS_H
@@ -52,6 +52,14 @@ recalculates when the object's orientation changes, simply uncomment the rotate
 #include "glm\gtc\quaternion.hpp"
 #include "glm\gtx\quaternion.hpp"
 
+//The vertex layout used by every mesh: a position followed by a color
+struct Vertex
+{
+	float
+		x, y, z,
+		r, g, b, a;
+};
+
 // We create a VertexFormat struct, which defines how the data passed into the shader code wil be formatted
 struct VertexFormat
 {
@@ -0,0 +1,102 @@
+/*
+Title: Point - Plane
+File Name: IndexedHeap.cpp
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+A binary min heap of integer ids whose keys can be changed.
+*/
+
+#include "IndexedHeap.h"
+
+void IndexedHeap::Reset(int numIds)
+{
+	heap.clear();
+	slots.assign(numIds, -1);
+	keys.assign(numIds, 0.0);
+}
+
+void IndexedHeap::Set(int id, double key)
+{
+	int slot = slots[id];
+	if (slot < 0)
+	{
+		keys[id] = key;
+		heap.push_back(id);
+		slots[id] = (int)heap.size() - 1;
+		SiftUp((int)heap.size() - 1);
+		return;
+	}
+
+	double oldKey = keys[id];
+	keys[id] = key;
+	if (key < oldKey) SiftUp(slot);
+	else SiftDown(slot);
+}
+
+void IndexedHeap::Remove(int id)
+{
+	int slot = slots[id];
+	if (slot < 0) return;
+
+	//Move the last id into the hole and let it settle
+	int last = heap.back();
+	heap.pop_back();
+	slots[id] = -1;
+	if (last == id) return;
+
+	Place(slot, last);
+	SiftUp(slot);
+	SiftDown(slots[last]);
+}
+
+void IndexedHeap::SiftUp(int slot)
+{
+	int id = heap[slot];
+	double key = keys[id];
+
+	while (slot > 0)
+	{
+		int parent = (slot - 1) / 2;
+		if (keys[heap[parent]] <= key) break;
+		Place(slot, heap[parent]);
+		slot = parent;
+	}
+	Place(slot, id);
+}
+
+void IndexedHeap::SiftDown(int slot)
+{
+	int id = heap[slot];
+	double key = keys[id];
+	int count = (int)heap.size();
+
+	for (;;)
+	{
+		int child = slot * 2 + 1;
+		if (child >= count) break;
+		if (child + 1 < count && keys[heap[child + 1]] < keys[heap[child]]) child++;
+		if (keys[heap[child]] >= key) break;
+		Place(slot, heap[child]);
+		slot = child;
+	}
+	Place(slot, id);
+}
@@ -0,0 +1,99 @@
+/*
+Title: Point - Plane
+File Name: IndexedHeap.h
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+A binary min heap of integer ids which also remembers where each id is
+stored, so the key of any id can be changed or the id removed in O(log N)
+without searching for it. std::priority_queue can only pop the top.
+*/
+
+#ifndef _INDEXED_HEAP_H
+#define _INDEXED_HEAP_H
+
+#include <vector>
+
+struct IndexedHeap
+{
+	//Ids ordered as a binary heap, smallest key first
+	std::vector<int> heap;
+
+	//Position of each id in the heap, or -1 if it isn't in the heap
+	std::vector<int> slots;
+
+	//Key of each id
+	std::vector<double> keys;
+
+	///
+	//Empties the heap and makes room for ids in [0, numIds)
+	void Reset(int numIds);
+
+	bool Empty() const
+	{
+		return heap.empty();
+	}
+
+	bool Contains(int id) const
+	{
+		return slots[id] >= 0;
+	}
+
+	///
+	//Returns the id with the smallest key. The heap must not be empty.
+	int Top() const
+	{
+		return heap[0];
+	}
+
+	///
+	//Returns the smallest key. The heap must not be empty.
+	double TopKey() const
+	{
+		return keys[heap[0]];
+	}
+
+	///
+	//Inserts an id, or changes its key if it is already in the heap
+	void Set(int id, double key);
+
+	///
+	//Removes an id if it is in the heap
+	void Remove(int id);
+
+	///
+	//Removes the id with the smallest key
+	void Pop()
+	{
+		Remove(heap[0]);
+	}
+
+private:
+	void SiftUp(int slot);
+	void SiftDown(int slot);
+	void Place(int slot, int id)
+	{
+		heap[slot] = id;
+		slots[id] = slot;
+	}
+};
+
+#endif //_INDEXED_HEAP_H
@@ -0,0 +1,151 @@
+/*
+Title: Point - Plane
+File Name: InputLog.cpp
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+Recording and replaying of user input. A log file is a small header
+holding the number of recorded frames and events, followed by the events
+themselves written as one array.
+*/
+
+#include "InputLog.h"
+
+//Identifies an input log file ("PPIN")
+static const unsigned int inputLogMagic = 0x4E495050;
+static const unsigned int inputLogVersion = 1;
+
+struct InputLogHeader
+{
+	unsigned int magic;
+	unsigned int version;
+	unsigned int numFrames;
+	unsigned int numEvents;
+};
+
+bool InputLog::Save(const std::string &fileName) const
+{
+	std::ofstream file(fileName, std::ios::out | std::ios::binary);
+	if (!file.good())
+	{
+		std::cout << "Can't write file: " << fileName.data() << std::endl;
+		return false;
+	}
+
+	InputLogHeader header;
+	header.magic = inputLogMagic;
+	header.version = inputLogVersion;
+	header.numFrames = numFrames;
+	header.numEvents = (unsigned int)events.size();
+
+	file.write((const char*)&header, sizeof(header));
+	file.write((const char*)events.data(), events.size() * sizeof(InputEvent));
+
+	bool written = file.good();
+	file.close();
+	return written;
+}
+
+bool InputLog::Load(const std::string &fileName)
+{
+	std::ifstream file(fileName, std::ios::in | std::ios::binary);
+	if (!file.good())
+	{
+		std::cout << "Can't read file: " << fileName.data() << std::endl;
+		return false;
+	}
+
+	InputLogHeader header;
+	file.read((char*)&header, sizeof(header));
+	if (!file.good() || header.magic != inputLogMagic || header.version != inputLogVersion)
+	{
+		std::cout << "Not an input log: " << fileName.data() << std::endl;
+		return false;
+	}
+
+	//The count comes from the file, so check the events are really there before making room for them
+	std::streamoff start = file.tellg();
+	file.seekg(0, std::ios::end);
+	std::streamoff remaining = file.tellg() - start;
+	file.seekg(start, std::ios::beg);
+	if (remaining < 0 || (unsigned long long)remaining / sizeof(InputEvent) < header.numEvents)
+	{
+		std::cout << "Input log is truncated: " << fileName.data() << std::endl;
+		return false;
+	}
+
+	events.resize(header.numEvents);
+	file.read((char*)events.data(), events.size() * sizeof(InputEvent));
+	if (!file.good())
+	{
+		std::cout << "Input log is truncated: " << fileName.data() << std::endl;
+		return false;
+	}
+	file.close();
+
+	numFrames = header.numFrames;
+	nextEvent = 0;
+	return true;
+}
+
+//Prints min/avg/max of one stage in milliseconds
+static void PrintStage(const char* name, const std::vector<float> &times)
+{
+	if (times.empty()) return;
+
+	float total = 0.0f;
+	float minTime = times[0];
+	float maxTime = times[0];
+	for (size_t i = 0; i < times.size(); i++)
+	{
+		total += times[i];
+		minTime = std::min(minTime, times[i]);
+		maxTime = std::max(maxTime, times[i]);
+	}
+
+	std::cout << name << ": min " << minTime * 1000.0f << " ms, avg " << total * 1000.0f / times.size()
+		<< " ms, max " << maxTime * 1000.0f << " ms, total " << total << " s" << std::endl;
+}
+
+void FrameTimings::PrintSummary() const
+{
+	std::cout << "Frames: " << update.size() << std::endl;
+	PrintStage("update()", update);
+	PrintStage("renderScene()", render);
+	PrintStage("swap", swap);
+}
+
+bool FrameTimings::SaveCSV(const std::string &fileName) const
+{
+	std::ofstream file(fileName, std::ios::out);
+	if (!file.good())
+	{
+		std::cout << "Can't write file: " << fileName.data() << std::endl;
+		return false;
+	}
+
+	file << "frame,update,render,swap\n";
+	for (size_t i = 0; i < update.size(); i++)
+		file << i << "," << update[i] << "," << render[i] << "," << swap[i] << "\n";
+
+	file.close();
+	return true;
+}
@@ -0,0 +1,156 @@
+/*
+Title: Point - Plane
+File Name: InputLog.h
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+Recording and replaying of user input. Every key press, mouse click and
+cursor movement which reaches the simulation is stored along with the frame
+that consumed it and the time it happened. Replaying a log feeds the events
+back in on exactly the same frames, so two builds of the program can be run
+on an identical workload and their timings and final states compared.
+*/
+
+#ifndef _INPUT_LOG_H
+#define _INPUT_LOG_H
+
+#include "GLIncludes.h"
+#include <chrono>
+
+//The kinds of input which can be recorded
+enum InputEventType
+{
+	INPUT_KEY = 0,
+	INPUT_MOUSE_BUTTON = 1,
+	INPUT_CURSOR = 2
+};
+
+//A single recorded input event
+struct InputEvent
+{
+	unsigned int frame;		//The frame whose update consumes this event
+	float time;				//Seconds since recording began
+	unsigned char type;		//One of InputEventType
+	unsigned char action;	//GLFW_PRESS, GLFW_RELEASE or GLFW_REPEAT
+	short code;				//The key or mouse button
+	float x, y;				//Cursor position for mouse and cursor events
+};
+
+//A sequence of input events which can be saved, loaded and replayed
+struct InputLog
+{
+	std::vector<InputEvent> events;
+
+	//The number of frames the recording lasted
+	unsigned int numFrames;
+
+	//Index of the next event to replay
+	size_t nextEvent;
+
+	InputLog()
+	{
+		numFrames = 0;
+		nextEvent = 0;
+	}
+
+	///
+	//Appends an event to the log
+	//
+	//Parameters:
+	//	frame: The frame whose update consumes this event
+	//	time: Seconds since recording began
+	//	type: One of InputEventType
+	//	action: GLFW_PRESS, GLFW_RELEASE or GLFW_REPEAT
+	//	code: The key or mouse button
+	//	x: Cursor x position
+	//	y: Cursor y position
+	void Record(unsigned int frame, float time, InputEventType type, int action, int code, double x, double y)
+	{
+		InputEvent e;
+		e.frame = frame;
+		e.time = time;
+		e.type = (unsigned char)type;
+		e.action = (unsigned char)action;
+		e.code = (short)code;
+		e.x = (float)x;
+		e.y = (float)y;
+		events.push_back(e);
+	}
+
+	///
+	//Returns the next event belonging to a frame, or nullptr once the
+	//events of that frame have all been replayed
+	//
+	//Parameters:
+	//	frame: The frame being replayed
+	const InputEvent* NextEvent(unsigned int frame)
+	{
+		if (nextEvent >= events.size() || events[nextEvent].frame > frame) return nullptr;
+		return &events[nextEvent++];
+	}
+
+	///
+	//Writes the log to a binary file
+	//
+	//Returns:
+	//	true if the log was written, else false
+	bool Save(const std::string &fileName) const;
+
+	///
+	//Reads a log written by Save
+	//
+	//Returns:
+	//	true if the log was read, else false
+	bool Load(const std::string &fileName);
+};
+
+//Per frame durations, in seconds, of each stage of the main loop
+struct FrameTimings
+{
+	std::vector<float> update;
+	std::vector<float> render;
+	std::vector<float> swap;
+
+	///
+	//Prints the minimum, average and maximum time of each stage
+	void PrintSummary() const;
+
+	///
+	//Writes one line per frame to a csv file
+	//
+	//Returns:
+	//	true if the file was written, else false
+	bool SaveCSV(const std::string &fileName) const;
+};
+
+//Returns the number of seconds elapsed between two clock readings
+inline float SecondsBetween(std::chrono::high_resolution_clock::time_point start, std::chrono::high_resolution_clock::time_point end)
+{
+	return std::chrono::duration<float>(end - start).count();
+}
+
+//Returns the number of nanoseconds elapsed between two clock readings
+inline unsigned long long NanosecondsBetween(std::chrono::high_resolution_clock::time_point start, std::chrono::high_resolution_clock::time_point end)
+{
+	return (unsigned long long)std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+}
+
+#endif //_INPUT_LOG_H
@@ -0,0 +1,86 @@
+/*
+Title: Point - Plane
+File Name: KineticSides.cpp
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+Keeps track of which side of a moving plane every point of a still point set is on.
+*/
+
+#include "KineticSides.h"
+
+void KineticSides::Reset(const ProjectionIndex &pointIndex, float startDistance, float range)
+{
+	index = &pointIndex;
+	distance = startDistance;
+	acceptanceRange = range;
+
+	index->BandRange(distance, acceptanceRange, first, last);
+
+	int count = (int)index->order.size();
+	sides.resize(count);
+	for (int i = 0; i < count; i++)
+		sides[index->order[i]] = (signed char)ProjectionIndex::SideAt(i, first, last);
+}
+
+int KineticSides::MoveTo(float newDistance, std::vector<SideEvent> &events)
+{
+	events.clear();
+
+	int newFirst, newLast;
+	index->BandRange(newDistance, acceptanceRange, newFirst, newLast);
+
+	//Only the sorted positions between the old and new edges of the run can change side
+	int lowStart = std::min(first, newFirst);
+	int lowEnd = std::max(first, newFirst);
+	int highStart = std::min(last, newLast);
+	int highEnd = std::max(last, newLast);
+
+	//When the plane jumps further than the width of the run, the two stretches overlap
+	if (highStart < lowEnd) highStart = lowEnd;
+
+	for (int pass = 0; pass < 2; pass++)
+	{
+		int start = pass == 0 ? lowStart : highStart;
+		int end = pass == 0 ? lowEnd : highEnd;
+
+		for (int i = start; i < end; i++)
+		{
+			signed char from = (signed char)ProjectionIndex::SideAt(i, first, last);
+			signed char to = (signed char)ProjectionIndex::SideAt(i, newFirst, newLast);
+			if (from == to) continue;
+
+			SideEvent e;
+			e.point = index->order[i];
+			e.from = from;
+			e.to = to;
+			events.push_back(e);
+
+			sides[e.point] = to;
+		}
+	}
+
+	first = newFirst;
+	last = newLast;
+	distance = newDistance;
+
+	return (int)events.size();
+}
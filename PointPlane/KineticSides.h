@@ -0,0 +1,99 @@
+/*
+Title: Point - Plane
+File Name: KineticSides.h
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+Keeps track of which side of a moving plane every point of a still point set
+is on, without testing every point each step.
+
+In the sorted order of a ProjectionIndex the points behind the plane, on it and
+in front of it form three runs. When the plane slides along its normal only the
+edges of those runs move, so only the points between the old and new edges can
+change side. Those are exactly the points the plane swept over, and each one is
+reported as an event, so a step costs time proportional to the points crossed.
+*/
+
+#ifndef _KINETIC_SIDES_H
+#define _KINETIC_SIDES_H
+
+#include "ProjectionIndex.h"
+
+//A point changing side as the plane moves
+struct SideEvent
+{
+	int point;
+	signed char from;	//The PlaneSide before the move
+	signed char to;		//The PlaneSide after the move
+};
+
+struct KineticSides
+{
+	const ProjectionIndex* index;
+
+	//The current PlaneSide of every point, by point index
+	std::vector<signed char> sides;
+
+	//The current run of colliding points in sorted order
+	int first;
+	int last;
+
+	float distance;
+	float acceptanceRange;
+
+	KineticSides()
+	{
+		index = nullptr;
+		first = 0;
+		last = 0;
+		distance = 0.0f;
+		acceptanceRange = pointAcceptanceRange;
+	}
+
+	///
+	//Classifies every point against the starting position of the plane
+	//
+	//Parameters:
+	//	pointIndex: The index of the still points, built with the plane's normal
+	//	startDistance: The plane's starting distance along the normal
+	//	range: Points this close to the plane are considered colliding
+	void Reset(const ProjectionIndex &pointIndex, float startDistance, float range);
+
+	///
+	//Moves the plane along its normal and updates the points it swept over
+	//
+	//Parameters:
+	//	newDistance: The plane's new distance along the normal
+	//	events: Filled with every point which changed side
+	//
+	//Returns:
+	//	The number of points which changed side
+	int MoveTo(float newDistance, std::vector<SideEvent> &events);
+
+	///
+	//Returns the number of points currently colliding with the plane
+	int NumColliding() const
+	{
+		return last - first;
+	}
+};
+
+#endif //_KINETIC_SIDES_H
@@ -0,0 +1,342 @@
+/*
+Title: Point - Plane
+File Name: LargePages.cpp
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+Lets the big point, index and result arrays live on 2MB pages.
+*/
+
+#include "LargePages.h"
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <cstring>
+#include <cstdlib>
+#include <cstdio>
+#include <atomic>
+#include <algorithm>
+#include <mutex>
+#include <unordered_map>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#elif defined(__linux__)
+#include <sys/mman.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+//Where the memory of an array came from
+enum BlockKind
+{
+	BLOCK_HEAP,
+	BLOCK_MAPPED,		//Ordinary pages mapped on their own, possibly turned into transparent huge pages
+	BLOCK_HUGE			//Explicit huge pages
+};
+
+//An array on its own mapping. These are kept in a table by address rather than in
+//front of the array, so an array of whole huge pages needs no page more, and the
+//array starts on the page boundary.
+struct LargeBlock
+{
+	size_t mapped;
+	size_t bytes;		//The size of the array itself
+	int kind;
+};
+
+//Alignment of arrays from the heap, a cache line
+static const size_t heapAlignment = 64;
+
+//Every mapped array, by address. Arrays not in it came from the heap.
+//The table is never destroyed, so arrays in static objects can still be freed at exit.
+struct BlockTable
+{
+	std::mutex mutex;
+	std::unordered_map<const void*, LargeBlock> blocks;
+};
+
+static BlockTable* Blocks()
+{
+	static BlockTable* table = new BlockTable();
+	return table;
+}
+
+//Finds the mapped block of an array, returning false if it came from the heap
+static bool FindBlock(const void* memory, LargeBlock &block)
+{
+	BlockTable* table = Blocks();
+	std::lock_guard<std::mutex> lock(table->mutex);
+	std::unordered_map<const void*, LargeBlock>::const_iterator found = table->blocks.find(memory);
+	if (found == table->blocks.end()) return false;
+	block = found->second;
+	return true;
+}
+
+static std::atomic<int> largePageMode(PAGES_NORMAL);
+
+//Each fallback is only reported once
+static std::atomic<bool> warnedExplicit(false);
+static std::atomic<bool> warnedTransparent(false);
+
+static size_t RoundUp(size_t bytes, size_t multiple)
+{
+	return (bytes + multiple - 1) / multiple * multiple;
+}
+
+void SetLargePages(LargePageMode mode)
+{
+	largePageMode = mode;
+}
+
+LargePageMode GetLargePages()
+{
+	return (LargePageMode)largePageMode.load();
+}
+
+bool ParseLargePages(const char* name, LargePageMode &mode)
+{
+	if (strcmp(name, "off") == 0) mode = PAGES_NORMAL;
+	else if (strcmp(name, "transparent") == 0) mode = PAGES_TRANSPARENT;
+	else if (strcmp(name, "explicit") == 0) mode = PAGES_EXPLICIT;
+	else return false;
+	return true;
+}
+
+const char* LargePagesName(LargePageMode mode)
+{
+	switch (mode)
+	{
+	case PAGES_TRANSPARENT: return "transparent";
+	case PAGES_EXPLICIT: return "explicit";
+	default: return "off";
+	}
+}
+
+//Maps memory on huge pages, returning nullptr and leaving kind as it was if it can't
+static void* MapLarge(size_t bytes, LargePageMode mode, size_t &mapped, int &kind)
+{
+#ifdef _WIN32
+	if (mode == PAGES_EXPLICIT)
+	{
+		//Large pages need the "Lock pages in memory" privilege, which few accounts have
+		size_t pageSize = GetLargePageMinimum();
+		if (pageSize > 0)
+		{
+			mapped = RoundUp(bytes, pageSize);
+			void* base = VirtualAlloc(nullptr, mapped, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+			if (base != nullptr)
+			{
+				kind = BLOCK_HUGE;
+				return base;
+			}
+		}
+		if (!warnedExplicit.exchange(true))
+			std::cout << "Can't allocate large pages (error " << GetLastError() << "), using ordinary pages" << std::endl;
+	}
+	else if (!warnedTransparent.exchange(true))
+		std::cout << "Windows has no transparent huge pages, using ordinary pages" << std::endl;
+	return nullptr;
+#elif defined(__linux__)
+	if (mode == PAGES_EXPLICIT)
+	{
+		mapped = RoundUp(bytes, largePageSize);
+		void* base = mmap(nullptr, mapped, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+		if (base != MAP_FAILED)
+		{
+			kind = BLOCK_HUGE;
+			return base;
+		}
+		if (!warnedExplicit.exchange(true))
+			std::cout << "Can't map explicit huge pages (" << strerror(errno) << "), using transparent huge pages" << std::endl;
+	}
+
+	//Huge pages only cover 2MB aligned ranges, so map one page extra and trim it to alignment
+	mapped = RoundUp(bytes, largePageSize);
+	char* reserved = (char*)mmap(nullptr, mapped + largePageSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (reserved == (char*)MAP_FAILED) return nullptr;
+
+	char* base = (char*)RoundUp((size_t)reserved, largePageSize);
+	if (base > reserved) munmap(reserved, base - reserved);
+	munmap(base + mapped, reserved + largePageSize - base);
+
+	if (madvise(base, mapped, MADV_HUGEPAGE) != 0 && !warnedTransparent.exchange(true))
+		std::cout << "Can't ask for transparent huge pages (" << strerror(errno) << "), using ordinary pages" << std::endl;
+	kind = BLOCK_MAPPED;
+	return base;
+#else
+	(void)bytes;
+	(void)mode;
+	(void)mapped;
+	(void)kind;
+	return nullptr;
+#endif
+}
+
+//Allocates cache line aligned memory from the heap
+static void* AllocateHeap(size_t bytes)
+{
+	bytes = std::max(bytes, (size_t)1);
+#ifdef _WIN32
+	void* memory = _aligned_malloc(bytes, heapAlignment);
+#else
+	void* memory = nullptr;
+	if (posix_memalign(&memory, heapAlignment, bytes) != 0) memory = nullptr;
+#endif
+	if (memory == nullptr) throw std::bad_alloc();
+	return memory;
+}
+
+static void FreeHeap(void* memory)
+{
+#ifdef _WIN32
+	_aligned_free(memory);
+#else
+	free(memory);
+#endif
+}
+
+void* AllocateLarge(size_t bytes)
+{
+	LargePageMode mode = GetLargePages();
+	if (mode == PAGES_NORMAL || bytes < largePageSize)
+		return AllocateHeap(bytes);
+
+	LargeBlock block;
+	block.bytes = bytes;
+	block.mapped = bytes;
+	block.kind = BLOCK_HEAP;
+	void* base = MapLarge(bytes, mode, block.mapped, block.kind);
+	if (base == nullptr)
+		return AllocateHeap(bytes);
+
+	BlockTable* table = Blocks();
+	std::lock_guard<std::mutex> lock(table->mutex);
+	table->blocks[base] = block;
+	return base;
+}
+
+void FreeLarge(void* memory)
+{
+	if (memory == nullptr) return;
+
+	LargeBlock block;
+	{
+		BlockTable* table = Blocks();
+		std::lock_guard<std::mutex> lock(table->mutex);
+		std::unordered_map<const void*, LargeBlock>::iterator found = table->blocks.find(memory);
+		if (found == table->blocks.end())
+		{
+			FreeHeap(memory);
+			return;
+		}
+		block = found->second;
+		table->blocks.erase(found);
+	}
+
+#ifdef _WIN32
+	VirtualFree(memory, 0, MEM_RELEASE);
+#elif defined(__linux__)
+	munmap(memory, block.mapped);
+#endif
+}
+
+size_t HugePageBytes(const void* memory)
+{
+	LargeBlock block;
+	if (memory == nullptr || !FindBlock(memory, block)) return 0;
+	if (block.kind == BLOCK_HUGE) return block.bytes;
+
+#ifdef __linux__
+	//The kernel counts transparent huge pages per mapping. Neighbouring blocks may be
+	//merged into one mapping, so the count is capped at the size of this block.
+	std::ifstream smaps("/proc/self/smaps");
+	std::string line;
+	size_t address = (size_t)memory;
+	bool inMapping = false;
+	while (std::getline(smaps, line))
+	{
+		unsigned long long start = 0;
+		unsigned long long end = 0;
+		unsigned long long kilobytes = 0;
+		if (sscanf(line.c_str(), "%llx-%llx ", &start, &end) == 2 && line.find(':') > line.find(' '))
+			inMapping = address >= start && address < end;
+		else if (inMapping && sscanf(line.c_str(), "AnonHugePages: %llu kB", &kilobytes) == 1)
+			return std::min((size_t)kilobytes * 1024, block.bytes);
+	}
+#endif
+	return 0;
+}
+
+bool TlbMissCounter::Open()
+{
+	Close();
+
+#ifdef __linux__
+	//Load misses only, as not every processor counts store misses
+	perf_event_attr attributes;
+	memset(&attributes, 0, sizeof(attributes));
+	attributes.type = PERF_TYPE_HW_CACHE;
+	attributes.size = sizeof(attributes);
+	attributes.config = PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+	attributes.disabled = 1;
+	attributes.exclude_kernel = 1;
+	attributes.exclude_hv = 1;
+	handle = (int)syscall(SYS_perf_event_open, &attributes, 0, -1, -1, 0);
+#endif
+
+	return handle >= 0;
+}
+
+void TlbMissCounter::Start()
+{
+#ifdef __linux__
+	if (handle < 0) return;
+	ioctl(handle, PERF_EVENT_IOC_RESET, 0);
+	ioctl(handle, PERF_EVENT_IOC_ENABLE, 0);
+#endif
+}
+
+long long TlbMissCounter::Stop()
+{
+#ifdef __linux__
+	if (handle < 0) return -1;
+	ioctl(handle, PERF_EVENT_IOC_DISABLE, 0);
+	long long count = 0;
+	if (read(handle, &count, sizeof(count)) != sizeof(count)) return -1;
+	return count;
+#else
+	return -1;
+#endif
+}
+
+void TlbMissCounter::Close()
+{
+#ifdef __linux__
+	if (handle >= 0) close(handle);
+#endif
+	handle = -1;
+}
@@ -0,0 +1,178 @@
+/*
+Title: Point - Plane
+File Name: LargePages.h
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+Lets the big point, index and result arrays live on 2MB pages.
+
+Every page of memory a thread touches needs an entry in the TLB. With 4KB pages
+a few hundred megabytes of points need far more entries than the TLB holds, so a
+pass over them keeps missing it and walking the page tables. On 2MB pages the
+same arrays need 512 times fewer entries.
+
+Arrays of at least 2MB can be placed on explicit huge pages (MAP_HUGETLB, which
+needs pages reserved by the administrator), or on transparent huge pages the
+kernel builds on its own once asked with madvise(MADV_HUGEPAGE). If explicit
+pages can't be had the allocator falls back to transparent pages, and from
+there to ordinary pages, so the chosen mode never makes an allocation fail.
+Smaller arrays always come from the heap.
+*/
+
+#ifndef _LARGE_PAGES_H
+#define _LARGE_PAGES_H
+
+#include <vector>
+#include <cstddef>
+#include <new>
+
+enum LargePageMode
+{
+	PAGES_NORMAL,		//Ordinary pages from the heap
+	PAGES_TRANSPARENT,	//Ask the kernel to back the memory with huge pages when it can
+	PAGES_EXPLICIT		//Map reserved huge pages, falling back to transparent ones
+};
+
+//Arrays smaller than this come from the heap whatever the mode
+const size_t largePageSize = 2 << 20;
+
+///
+//Sets the kind of pages later large arrays are placed on. Arrays already allocated keep theirs.
+void SetLargePages(LargePageMode mode);
+
+///
+//Returns the kind of pages new large arrays are placed on
+LargePageMode GetLargePages();
+
+///
+//Parses the name of a page mode: off, transparent or explicit
+//
+//Returns:
+//	true if the name was recognized
+bool ParseLargePages(const char* name, LargePageMode &mode);
+
+///
+//Returns the name of a page mode
+const char* LargePagesName(LargePageMode mode);
+
+///
+//Allocates memory for an array, on huge pages if the current mode asks for them
+//
+//Parameters:
+//	bytes: The size of the array
+//
+//Returns:
+//	The memory, aligned to a cache line, or to a huge page when it is on huge pages.
+//	Throws std::bad_alloc if there is none, like operator new.
+void* AllocateLarge(size_t bytes);
+
+///
+//Frees memory from AllocateLarge
+void FreeLarge(void* memory);
+
+///
+//Returns how many bytes of the block holding an array are actually on huge pages
+//
+//Overview:
+//	Transparent huge pages are only a request, so this reads back from the system
+//	what was granted. Systems which can't tell give 0.
+size_t HugePageBytes(const void* memory);
+
+//A standard allocator handing out memory from AllocateLarge
+template <class T>
+struct LargePageAllocator
+{
+	typedef T value_type;
+
+	LargePageAllocator() {}
+
+	template <class U>
+	LargePageAllocator(const LargePageAllocator<U> &) {}
+
+	T* allocate(size_t count)
+	{
+		return (T*)AllocateLarge(count * sizeof(T));
+	}
+
+	void deallocate(T* memory, size_t)
+	{
+		FreeLarge(memory);
+	}
+
+	template <class U>
+	bool operator==(const LargePageAllocator<U> &) const
+	{
+		return true;
+	}
+
+	template <class U>
+	bool operator!=(const LargePageAllocator<U> &) const
+	{
+		return false;
+	}
+};
+
+//Arrays which grow with the number of points
+typedef std::vector<float, LargePageAllocator<float>> FloatBuffer;
+typedef std::vector<int, LargePageAllocator<int>> IndexBuffer;
+typedef std::vector<signed char, LargePageAllocator<signed char>> SideBuffer;
+
+//Counts the data TLB misses of the calling thread, where the system exposes them
+struct TlbMissCounter
+{
+	int handle;
+
+	TlbMissCounter()
+	{
+		handle = -1;
+	}
+
+	~TlbMissCounter()
+	{
+		Close();
+	}
+
+	///
+	//Opens the counter
+	//
+	//Returns:
+	//	true if the system can count TLB misses for us
+	bool Open();
+
+	///
+	//Starts counting from zero
+	void Start();
+
+	///
+	//Stops counting
+	//
+	//Returns:
+	//	The misses since Start, or -1 if the counter isn't open
+	long long Stop();
+
+	void Close();
+
+private:
+	TlbMissCounter(const TlbMissCounter &);
+	TlbMissCounter &operator=(const TlbMissCounter &);
+};
+
+#endif //_LARGE_PAGES_H
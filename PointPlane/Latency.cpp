@@ -0,0 +1,166 @@
+/*
+Title: Point - Plane
+File Name: Latency.cpp
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+Measures input to photon latency.
+*/
+
+#include "Latency.h"
+#include <chrono>
+
+//Longest a frame is waited on before giving up, in nanoseconds
+static const GLuint64 fenceTimeout = 1000000000;
+
+//Latencies longer than ten seconds are clamped
+static const long long longestLatency = 10LL * 1000 * 1000 * 1000;
+
+LatencyTracker::LatencyTracker()
+	: latency(longestLatency)
+{
+	pendingInput = -1;
+	frameInput = -1;
+	gpuToCpuOffset = 0;
+	maxFramesInFlight = 0;
+	framesThrottled = 0;
+	available = false;
+}
+
+long long LatencyTracker::Now()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void LatencyTracker::Init()
+{
+	//Older contexts have neither, and calling through GLEW's null pointers would crash
+	available = GLEW_VERSION_3_3 || (GLEW_ARB_sync && GLEW_ARB_timer_query);
+	if (!available) return;
+
+	//Wait for the GPU to be idle, so the timestamp it reports is the current time
+	glFinish();
+
+	GLint64 gpuTime = 0;
+	glGetInteger64v(GL_TIMESTAMP, &gpuTime);
+	gpuToCpuOffset = Now() - gpuTime;
+}
+
+void LatencyTracker::Shutdown()
+{
+	for (size_t i = 0; i < inFlight.size(); i++)
+	{
+		glDeleteSync(inFlight[i].fence);
+		freeQueries.push_back(inFlight[i].query);
+	}
+	inFlight.clear();
+
+	if (!freeQueries.empty())
+		glDeleteQueries((GLsizei)freeQueries.size(), freeQueries.data());
+	freeQueries.clear();
+}
+
+void LatencyTracker::OnInput()
+{
+	//Only the earliest input matters, later ones are reflected by the same frame
+	if (pendingInput < 0) pendingInput = Now();
+}
+
+void LatencyTracker::BeginFrame()
+{
+	if (!available) return;
+
+	//Collect whatever has finished
+	Poll(false);
+
+	//Keep the CPU from running too far ahead of the GPU
+	if (maxFramesInFlight > 0 && (int)inFlight.size() >= maxFramesInFlight)
+	{
+		framesThrottled++;
+		while ((int)inFlight.size() >= maxFramesInFlight)
+			Poll(true);
+	}
+
+	frameInput = pendingInput;
+	pendingInput = -1;
+}
+
+void LatencyTracker::EndFrame()
+{
+	if (!available) return;
+
+	FrameInFlight frame;
+	if (freeQueries.empty())
+	{
+		GLuint query;
+		glGenQueries(1, &query);
+		freeQueries.push_back(query);
+	}
+	frame.query = freeQueries.back();
+	freeQueries.pop_back();
+
+	glQueryCounter(frame.query, GL_TIMESTAMP);
+	frame.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	frame.inputTime = frameInput;
+	inFlight.push_back(frame);
+
+	frameInput = -1;
+}
+
+void LatencyTracker::Poll(bool wait)
+{
+	while (!inFlight.empty())
+	{
+		FrameInFlight &frame = inFlight.front();
+
+		GLenum status = glClientWaitSync(frame.fence, GL_SYNC_FLUSH_COMMANDS_BIT, wait ? fenceTimeout : 0);
+		if (status == GL_TIMEOUT_EXPIRED && !wait) return;
+
+		if (status != GL_WAIT_FAILED && status != GL_TIMEOUT_EXPIRED && frame.inputTime >= 0)
+		{
+			GLuint64 gpuTime = 0;
+			glGetQueryObjectui64v(frame.query, GL_QUERY_RESULT, &gpuTime);
+			latency.Record((long long)gpuTime + gpuToCpuOffset - frame.inputTime);
+		}
+
+		glDeleteSync(frame.fence);
+		freeQueries.push_back(frame.query);
+		inFlight.pop_front();
+
+		//Only one frame is waited for at a time
+		if (wait) return;
+	}
+}
+
+void LatencyTracker::PrintSummary(std::ostream &out) const
+{
+	if (!available)
+	{
+		out << "Input to photon latency is unavailable, the GL context has no fences or timestamp queries" << std::endl;
+		return;
+	}
+
+	out << "Input to photon latency over " << latency.totalCount << " inputs";
+	if (maxFramesInFlight > 0)
+		out << " (at most " << maxFramesInFlight << " frames in flight, " << framesThrottled << " frames throttled)";
+	out << std::endl;
+	PrintPercentiles(out, "latency", latency);
+}
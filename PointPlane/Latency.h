@@ -0,0 +1,120 @@
+/*
+Title: Point - Plane
+File Name: Latency.h
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+Measures input to photon latency: the time from a key press or mouse click
+until the GPU has finished the frame which first shows its effect.
+
+Each input is timestamped when GLFW hands it to us. The next frame to run
+update() is tagged with the earliest untagged input. After that frame is
+swapped, a GL timestamp query and a fence are placed into the command stream.
+Once the fence has signaled, the timestamp tells us when the GPU finished the
+frame, which is converted to the CPU clock and compared to the input time.
+
+Optionally the number of frames the CPU may run ahead of the GPU can be limited.
+Before starting a new frame we wait on the fence of the oldest frame in flight,
+which keeps the queue of buffered frames (and so the latency) short.
+*/
+
+#ifndef _LATENCY_H
+#define _LATENCY_H
+
+#include "FrameStats.h"
+#include <deque>
+
+struct LatencyTracker
+{
+	//A frame which has been sent to the GPU but not yet measured
+	struct FrameInFlight
+	{
+		GLsync fence;
+		GLuint query;
+		long long inputTime;	//CPU time of the input the frame reflects, or -1
+	};
+
+	std::deque<FrameInFlight> inFlight;
+	std::vector<GLuint> freeQueries;
+
+	//Earliest input which no frame has reflected yet, or -1
+	long long pendingInput;
+
+	//Input of the frame currently being built, or -1
+	long long frameInput;
+
+	//Adding this to a GPU timestamp gives the CPU time, both in nanoseconds
+	long long gpuToCpuOffset;
+
+	//Largest number of frames the CPU may queue ahead of the GPU, 0 for no limit
+	int maxFramesInFlight;
+
+	//Number of frames which had to wait for the GPU because of the limit
+	long long framesThrottled;
+
+	//Input to photon latency in nanoseconds
+	HdrHistogram latency;
+
+	//Whether the context has fences and timestamp queries (GL 3.3, or ARB_sync and ARB_timer_query).
+	//Without them every frame call does nothing.
+	bool available;
+
+	LatencyTracker();
+
+	///
+	//Matches the GPU clock to the CPU clock, if the context can measure latency at all.
+	//Needs a current GL context with GLEW initialized.
+	void Init();
+
+	///
+	//Deletes the fences and queries. Needs a current GL context.
+	void Shutdown();
+
+	///
+	//Timestamps an input event
+	void OnInput();
+
+	///
+	//Called before update(). Tags the frame with the pending input and
+	//waits for the GPU if too many frames are in flight.
+	void BeginFrame();
+
+	///
+	//Called after the buffers are swapped. Places the timestamp query and fence.
+	void EndFrame();
+
+	///
+	//Records the latency of every frame the GPU has finished
+	//
+	//Parameters:
+	//	wait: Whether to block until the oldest frame has finished
+	void Poll(bool wait);
+
+	///
+	//Prints the latency percentiles
+	void PrintSummary(std::ostream &out) const;
+
+	///
+	//Returns the current CPU time in nanoseconds
+	static long long Now();
+};
+
+#endif //_LATENCY_H
@@ -0,0 +1,113 @@
+/*
+Title: Point - Plane
+File Name: NearestPoints.cpp
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+Finding the k points nearest to a plane.
+*/
+
+#include "NearestPoints.h"
+
+//A kept point, ordered by how near it is and then by index
+struct RankedPoint
+{
+	float rank;
+	float distance;
+	int point;
+
+	bool operator<(const RankedPoint &other) const
+	{
+		return rank < other.rank || (rank == other.rank && point < other.point);
+	}
+};
+
+//Keeps the best k points of a run in a max heap, worst point on top
+static void RankRun(const WorldPlane &plane, const PointSet &points, int begin, int end, int k, DistanceMode mode, std::vector<RankedPoint> &heap)
+{
+	float nx = plane.normal.x, ny = plane.normal.y, nz = plane.normal.z;
+	float d = plane.distance;
+	const float* x = points.x.data();
+	const float* y = points.y.data();
+	const float* z = points.z.data();
+
+	heap.clear();
+	heap.reserve(k);
+
+	for (int i = begin; i < end; i++)
+	{
+		RankedPoint ranked;
+		ranked.distance = nx * x[i] + ny * y[i] + nz * z[i] - d;
+		ranked.rank = mode == DISTANCE_ABSOLUTE ? fabs(ranked.distance) : ranked.distance;
+		ranked.point = i;
+
+		if ((int)heap.size() < k)
+		{
+			heap.push_back(ranked);
+			std::push_heap(heap.begin(), heap.end());
+		}
+		else if (ranked < heap.front())
+		{
+			std::pop_heap(heap.begin(), heap.end());
+			heap.back() = ranked;
+			std::push_heap(heap.begin(), heap.end());
+		}
+	}
+}
+
+int FindNearestToPlane(const WorldPlane &plane, const PointSet &points, int k, DistanceMode mode, std::vector<NearestPoint> &nearest, ThreadPool* pool)
+{
+	int count = (int)points.Size();
+	k = std::max(std::min(k, count), 0);
+	nearest.clear();
+	if (k == 0) return 0;
+
+	//A few runs per thread so uneven runs still balance
+	int numRuns = pool ? pool->NumThreads() * 4 : 1;
+	int grain = std::max((count + numRuns - 1) / numRuns, 1);
+	numRuns = (count + grain - 1) / grain;
+
+	std::vector<std::vector<RankedPoint>> heaps(numRuns);
+	ParallelRanges(pool, count, grain, [&](int begin, int end)
+	{
+		RankRun(plane, points, begin, end, k, mode, heaps[begin / grain]);
+	});
+
+	//Merge the runs and sort the best k
+	std::vector<RankedPoint> merged;
+	for (int i = 0; i < numRuns; i++)
+		merged.insert(merged.end(), heaps[i].begin(), heaps[i].end());
+	std::partial_sort(merged.begin(), merged.begin() + k, merged.end());
+
+	float inverseLengthSquared = 1.0f / glm::dot(plane.normal, plane.normal);
+	nearest.resize(k);
+	for (int i = 0; i < k; i++)
+	{
+		const RankedPoint &ranked = merged[i];
+		int p = ranked.point;
+
+		nearest[i].point = p;
+		nearest[i].distance = ranked.distance;
+		nearest[i].projection = glm::vec3(points.x[p], points.y[p], points.z[p]) - plane.normal * (ranked.distance * inverseLengthSquared);
+	}
+
+	return k;
+}
@@ -0,0 +1,76 @@
+/*
+Title: Point - Plane
+File Name: NearestPoints.h
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+Finding the k points nearest to a plane.
+
+The points are split into a few runs per thread. Each run is scanned once,
+keeping its best k points so far in a bounded max heap, so a point only
+costs a heap operation when it beats the worst point kept. The heaps of all
+the runs are then merged and the best k of them sorted. Every point's
+signed distance is kept with it, so the closest point on the plane,
+p - distance * n / |n|^2, only needs the k returned points read again and
+no distance worked out twice. Keeping the coordinates in the heaps as well
+would double the size of every heap entry to save k reads.
+
+Ties are broken by point index, so the result is the same whatever the
+number of threads.
+*/
+
+#ifndef _NEAREST_POINTS_H
+#define _NEAREST_POINTS_H
+
+#include "Scene.h"
+#include "ThreadPool.h"
+
+//What nearest means
+enum DistanceMode
+{
+	DISTANCE_ABSOLUTE,		//Closest to the plane on either side
+	DISTANCE_SIGNED			//Smallest signed distance, so furthest behind the plane first
+};
+
+//A point near a plane
+struct NearestPoint
+{
+	int point;
+	float distance;			//Signed distance from the plane
+	glm::vec3 projection;	//The closest point on the plane
+};
+
+///
+//Finds the k points nearest to a plane
+//
+//Parameters:
+//	plane: The plane, finite planes are treated as infinite
+//	points: The points to search
+//	k: How many points to find
+//	mode: Whether points are ranked by absolute or signed distance
+//	nearest: Filled with the nearest points, nearest first
+//	pool: Threads to split the points between, or nullptr to run on the calling thread
+//
+//Returns:
+//	The number of points found, which is k unless there are fewer points
+int FindNearestToPlane(const WorldPlane &plane, const PointSet &points, int k, DistanceMode mode, std::vector<NearestPoint> &nearest, ThreadPool* pool);
+
+#endif //_NEAREST_POINTS_H
@@ -0,0 +1,341 @@
+/*
+Title: Point - Plane
+File Name: Numa.cpp
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+Finds the NUMA nodes of the machine and keeps point sets split between them.
+*/
+
+#include "Numa.h"
+#include "Collision.h"
+#include "LargePages.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cstdlib>
+#include <cstdio>
+#include <algorithm>
+#include <chrono>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#elif defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/mempolicy.h>
+#endif
+
+//Points handed to one thread at a time within a node
+static const int numaGrain = 1 << 16;
+
+#ifdef __linux__
+//Reads a list like "0-3,8-11" from a file under /sys
+static std::vector<int> ReadCpuList(const std::string &fileName)
+{
+	std::vector<int> list;
+	std::ifstream file(fileName.c_str());
+	std::string item;
+	while (std::getline(file, item, ','))
+	{
+		int first = 0;
+		int last = 0;
+		int numRead = sscanf(item.c_str(), "%d-%d", &first, &last);
+		if (numRead < 1) continue;
+		if (numRead == 1) last = first;
+		for (int i = first; i <= last; i++)
+			list.push_back(i);
+	}
+	return list;
+}
+#endif
+
+std::vector<NumaNode> GetNumaNodes()
+{
+	std::vector<NumaNode> nodes;
+
+#ifdef _WIN32
+	ULONG highestNode = 0;
+	if (GetNumaHighestNodeNumber(&highestNode))
+	{
+		for (ULONG id = 0; id <= highestNode; id++)
+		{
+			ULONGLONG mask = 0;
+			if (!GetNumaNodeProcessorMask((UCHAR)id, &mask)) continue;
+
+			NumaNode node;
+			node.id = (int)id;
+			for (int cpu = 0; cpu < 64; cpu++)
+				if (mask & (1ull << cpu)) node.cpus.push_back(cpu);
+			if (!node.cpus.empty()) nodes.push_back(node);
+		}
+	}
+#elif defined(__linux__)
+	//Containers and taskset may keep the process off some hardware threads
+	cpu_set_t allowed;
+	CPU_ZERO(&allowed);
+	bool haveAllowed = sched_getaffinity(0, sizeof(allowed), &allowed) == 0;
+
+	std::vector<int> online = ReadCpuList("/sys/devices/system/node/online");
+	for (size_t i = 0; i < online.size(); i++)
+	{
+		std::ostringstream fileName;
+		fileName << "/sys/devices/system/node/node" << online[i] << "/cpulist";
+
+		NumaNode node;
+		node.id = online[i];
+		std::vector<int> cpus = ReadCpuList(fileName.str());
+		for (size_t j = 0; j < cpus.size(); j++)
+			if (!haveAllowed || (cpus[j] < CPU_SETSIZE && CPU_ISSET(cpus[j], &allowed))) node.cpus.push_back(cpus[j]);
+
+		//Nodes with memory but no processors get no slice
+		if (!node.cpus.empty()) nodes.push_back(node);
+	}
+#endif
+
+	if (nodes.empty())
+	{
+		NumaNode node;
+		node.id = 0;
+		int numCpus = std::max((int)std::thread::hardware_concurrency(), 1);
+		for (int cpu = 0; cpu < numCpus; cpu++)
+			node.cpus.push_back(cpu);
+		nodes.push_back(node);
+	}
+	return nodes;
+}
+
+bool PinThread(std::thread &thread, int cpu)
+{
+#ifdef _WIN32
+	if (cpu < 0 || cpu >= 64) return false;
+	return SetThreadAffinityMask(thread.native_handle(), (DWORD_PTR)1 << cpu) != 0;
+#elif defined(__linux__)
+	if (cpu < 0 || cpu >= CPU_SETSIZE) return false;
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	CPU_SET(cpu, &set);
+	return pthread_setaffinity_np(thread.native_handle(), sizeof(set), &set) == 0;
+#else
+	return false;
+#endif
+}
+
+bool PinCurrentThread(int cpu)
+{
+#ifdef _WIN32
+	if (cpu < 0 || cpu >= 64) return false;
+	return SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)1 << cpu) != 0;
+#elif defined(__linux__)
+	if (cpu < 0 || cpu >= CPU_SETSIZE) return false;
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	CPU_SET(cpu, &set);
+	return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+	return false;
+#endif
+}
+
+bool PinWorkers(ThreadPool &pool, const std::vector<int> &cpus)
+{
+	if (cpus.empty()) return false;
+
+	bool pinned = true;
+	for (size_t i = 0; i < pool.workers.size(); i++)
+		pinned = PinThread(pool.workers[i], cpus[(i + 1) % cpus.size()]) && pinned;
+	return pinned;
+}
+
+void* NumaAllocate(size_t bytes, int node)
+{
+	if (bytes == 0) return nullptr;
+
+#ifdef _WIN32
+	return VirtualAllocExNuma(GetCurrentProcess(), nullptr, bytes, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE, (DWORD)node);
+#elif defined(__linux__)
+	void* memory = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (memory == MAP_FAILED) return nullptr;
+
+	//Prefer the node rather than insist on it, so a full node spills over instead of failing.
+	//Kernels without NUMA refuse this, and first touch places the pages instead.
+	//Nodes which don't fit in the mask are left to first touch as well.
+	if (node >= 0 && node < (int)(sizeof(unsigned long) * 8))
+	{
+		unsigned long nodeMask = 1ul << node;
+		syscall(SYS_mbind, memory, bytes, MPOL_PREFERRED, &nodeMask, (unsigned long)(sizeof(nodeMask) * 8 + 1), 0);
+	}
+	if (GetLargePages() != PAGES_NORMAL)
+		madvise(memory, bytes, MADV_HUGEPAGE);
+	return memory;
+#else
+	(void)node;
+	return malloc(bytes);
+#endif
+}
+
+void NumaFree(void* memory, size_t bytes)
+{
+	if (memory == nullptr) return;
+
+#ifdef _WIN32
+	(void)bytes;
+	VirtualFree(memory, 0, MEM_RELEASE);
+#elif defined(__linux__)
+	munmap(memory, bytes);
+#else
+	(void)bytes;
+	free(memory);
+#endif
+}
+
+void NumaPointSet::Build(const std::vector<NumaNode> &nodes, const PointSet &points)
+{
+	Clear();
+	numPoints = (int)points.Size();
+
+	int totalCpus = 0;
+	for (size_t i = 0; i < nodes.size(); i++)
+		totalCpus += (int)nodes[i].cpus.size();
+
+	//Slices are sized by hardware threads, so every thread has about as many points
+	int begin = 0;
+	int cpusSoFar = 0;
+	for (size_t i = 0; i < nodes.size(); i++)
+	{
+		if (nodes[i].cpus.empty()) continue;
+		cpusSoFar += (int)nodes[i].cpus.size();
+		int end = (int)((long long)numPoints * cpusSoFar / totalCpus);
+
+		NumaPartition* partition = new NumaPartition();
+		partition->node = nodes[i];
+		partition->pool = new ThreadPool((int)nodes[i].cpus.size());
+		if (!PinWorkers(*partition->pool, nodes[i].cpus) && partition->pool->workers.size() > 0)
+			std::cout << "Can't pin the threads of NUMA node " << nodes[i].id << std::endl;
+		partition->begin = begin;
+		partition->count = end - begin;
+		partition->x = nullptr;
+		partition->y = nullptr;
+		partition->z = nullptr;
+		partition->sides = nullptr;
+		partition->lastSeconds = 0.0;
+		partition->lastColliding = 0;
+		partitions.push_back(partition);
+
+		begin = end;
+	}
+
+	RunOnNodes([&](NumaPartition &partition)
+	{
+		size_t count = (size_t)partition.count;
+		int node = partition.node.id;
+		partition.x = (float*)NumaAllocate(count * sizeof(float), node);
+		partition.y = (float*)NumaAllocate(count * sizeof(float), node);
+		partition.z = (float*)NumaAllocate(count * sizeof(float), node);
+		partition.sides = (signed char*)NumaAllocate(count, node);
+		if (count > 0 && (!partition.x || !partition.y || !partition.z || !partition.sides))
+		{
+			std::cout << "Can't allocate points on NUMA node " << node << std::endl;
+			NumaFree(partition.x, count * sizeof(float));
+			NumaFree(partition.y, count * sizeof(float));
+			NumaFree(partition.z, count * sizeof(float));
+			NumaFree(partition.sides, count);
+			partition.x = partition.y = partition.z = nullptr;
+			partition.sides = nullptr;
+			partition.count = 0;
+			return;
+		}
+
+		//Each page is first written by the thread which will read it
+		ParallelRanges(partition.pool, partition.count, numaGrain, [&](int first, int last)
+		{
+			int from = partition.begin + first;
+			std::copy(points.x.begin() + from, points.x.begin() + from + (last - first), partition.x + first);
+			std::copy(points.y.begin() + from, points.y.begin() + from + (last - first), partition.y + first);
+			std::copy(points.z.begin() + from, points.z.begin() + from + (last - first), partition.z + first);
+			std::fill(partition.sides + first, partition.sides + last, (signed char)0);
+		});
+	});
+}
+
+int NumaPointSet::Classify(const WorldPlane &plane, float acceptanceRange)
+{
+	RunOnNodes([&](NumaPartition &partition)
+	{
+		std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+		std::atomic<int> colliding(0);
+
+		ParallelRanges(partition.pool, partition.count, numaGrain, [&](int first, int last)
+		{
+			colliding += ClassifyPoints(plane, partition.x + first, partition.y + first, partition.z + first, last - first, acceptanceRange, partition.sides + first);
+		});
+
+		partition.lastColliding = colliding;
+		partition.lastSeconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+	});
+
+	int numColliding = 0;
+	for (size_t i = 0; i < partitions.size(); i++)
+		numColliding += partitions[i]->lastColliding;
+	return numColliding;
+}
+
+void NumaPointSet::Clear()
+{
+	for (size_t i = 0; i < partitions.size(); i++)
+	{
+		NumaPartition* partition = partitions[i];
+		delete partition->pool;
+
+		size_t count = (size_t)partition->count;
+		NumaFree(partition->x, count * sizeof(float));
+		NumaFree(partition->y, count * sizeof(float));
+		NumaFree(partition->z, count * sizeof(float));
+		NumaFree(partition->sides, count);
+		delete partition;
+	}
+	partitions.clear();
+	numPoints = 0;
+}
+
+void NumaPointSet::RunOnNodes(const std::function<void(NumaPartition&)> &body)
+{
+	//A thread per node, rather than the caller, drives each node's pool, since the
+	//thread calling ParallelFor works on the loop too and must sit on the node
+	std::vector<std::thread> drivers;
+	for (size_t i = 0; i < partitions.size(); i++)
+	{
+		NumaPartition* partition = partitions[i];
+		drivers.push_back(std::thread([partition, &body]()
+		{
+			PinCurrentThread(partition->node.cpus[0]);
+			body(*partition);
+		}));
+	}
+
+	for (size_t i = 0; i < drivers.size(); i++)
+		drivers[i].join();
+}
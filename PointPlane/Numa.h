@@ -0,0 +1,179 @@
+/*
+Title: Point - Plane
+File Name: Numa.h
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+Finds the NUMA nodes of the machine and keeps point sets split between them.
+
+On a machine with several sockets every socket has its own memory. Reading
+another socket's memory is slower, and every thread doing it shares the link
+between the sockets. A NumaPointSet gives each node a slice of the points, in
+memory placed on that node and first written by threads pinned to its cores,
+so every node classifies its own slice without touching remote memory.
+
+Machines without NUMA are treated as a single node, where the only difference
+from an ordinary pool is that the threads are pinned.
+*/
+
+#ifndef _NUMA_H
+#define _NUMA_H
+
+#include "Scene.h"
+#include "ThreadPool.h"
+
+struct NumaNode
+{
+	int id;
+
+	//The hardware threads of the node this process may run on
+	std::vector<int> cpus;
+};
+
+///
+//Finds the NUMA nodes which have hardware threads this process may run on
+//
+//Returns:
+//	The nodes in order of id. Systems without NUMA, or where the nodes can't be read,
+//	give one node holding every hardware thread.
+std::vector<NumaNode> GetNumaNodes();
+
+///
+//Keeps a thread on one hardware thread
+//
+//Parameters:
+//	thread: The thread to pin
+//	cpu: The hardware thread to run it on
+//
+//Returns:
+//	true if the thread was pinned
+bool PinThread(std::thread &thread, int cpu);
+
+///
+//Keeps the calling thread on one hardware thread
+bool PinCurrentThread(int cpu);
+
+///
+//Pins the workers of a pool, one to each of the given hardware threads
+//
+//Parameters:
+//	pool: The pool whose workers are pinned
+//	cpus: The hardware threads. Worker i is given cpus[i + 1], as cpus[0] is left
+//		for the thread which calls the pool's loops.
+//
+//Returns:
+//	true if every worker was pinned
+bool PinWorkers(ThreadPool &pool, const std::vector<int> &cpus);
+
+///
+//Allocates memory whose pages are placed on one node. Nothing is written to it,
+//so the pages are only created when they are first touched.
+//
+//Parameters:
+//	bytes: The size of the block
+//	node: The id of the node to place it on
+//
+//Returns:
+//	The block, or nullptr if it could not be allocated. If the system can't place
+//	memory on a node, the block is placed by whichever thread first writes each page.
+void* NumaAllocate(size_t bytes, int node);
+
+///
+//Frees a block from NumaAllocate
+void NumaFree(void* memory, size_t bytes);
+
+//One node's slice of a NumaPointSet
+struct NumaPartition
+{
+	NumaNode node;
+
+	//One thread for every hardware thread of the node, each pinned to its own
+	ThreadPool* pool;
+
+	//The slice's place in the whole point set
+	int begin;
+	int count;
+
+	//The slice's points and the side of the plane each one was last found on,
+	//all in the node's memory
+	float* x;
+	float* y;
+	float* z;
+	signed char* sides;
+
+	//Time taken and points found colliding by the last Classify, on this node alone
+	double lastSeconds;
+	int lastColliding;
+};
+
+struct NumaPointSet
+{
+	std::vector<NumaPartition*> partitions;
+	int numPoints;
+
+	NumaPointSet()
+	{
+		numPoints = 0;
+	}
+
+	~NumaPointSet()
+	{
+		Clear();
+	}
+
+	///
+	//Splits a point set between the nodes, in proportion to their hardware threads
+	//
+	//Overview:
+	//	Every node gets a pool of threads pinned to its cores and memory placed on it.
+	//	The node's own threads copy its slice in, so where the system can't place
+	//	memory on a node the pages still land on it when they are first touched.
+	//
+	//Parameters:
+	//	nodes: The nodes to split the points between, usually from GetNumaNodes
+	//	points: The points to copy
+	void Build(const std::vector<NumaNode> &nodes, const PointSet &points);
+
+	///
+	//Classifies every point against a plane, every node working on its own slice at once
+	//
+	//Parameters:
+	//	plane: The plane to test against
+	//	acceptanceRange: Points this close to the plane are considered colliding
+	//
+	//Returns:
+	//	The number of points colliding with the plane. Each point's side is left
+	//	in its partition's sides.
+	int Classify(const WorldPlane &plane, float acceptanceRange);
+
+	///
+	//Stops the pools and frees every slice
+	void Clear();
+
+private:
+	NumaPointSet(const NumaPointSet &);
+	NumaPointSet &operator=(const NumaPointSet &);
+
+	//Runs body(partition) for every partition at once, each on a thread pinned to the partition's first hardware thread
+	void RunOnNodes(const std::function<void(NumaPartition&)> &body);
+};
+
+#endif //_NUMA_H
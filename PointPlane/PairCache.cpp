@@ -0,0 +1,160 @@
+/*
+Title: Point - Plane
+File Name: PairCache.cpp
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+Description:
+A persistent cache of pair data in an open addressed hash table.
+*/
+
+#include "PairCache.h"
+
+//Smallest table kept
+static const size_t minimumSlots = 16;
+
+//Mixes every bit of the key into the low bits used for the slot
+static unsigned long long HashKey(unsigned long long key)
+{
+	key ^= key >> 33;
+	key *= 0xFF51AFD7ED558CCDull;
+	key ^= key >> 33;
+	key *= 0xC4CEB9FE1A85EC53ull;
+	key ^= key >> 33;
+	return key;
+}
+
+size_t PairCache::SlotOf(unsigned long long key) const
+{
+	size_t mask = slots.size() - 1;
+	size_t slot = (size_t)HashKey(key) & mask;
+	while (slots[slot].key != key && slots[slot].key != emptyPairKey)
+		slot = (slot + 1) & mask;
+	return slot;
+}
+
+PairContact* PairCache::Find(unsigned int a, unsigned int b)
+{
+	if (count == 0) return nullptr;
+
+	size_t slot = SlotOf(Key(a, b));
+	return slots[slot].key == emptyPairKey ? nullptr : &slots[slot];
+}
+
+PairContact &PairCache::Touch(unsigned int a, unsigned int b, bool* created)
+{
+	//Stay at most half full, so probes stay short
+	if ((size_t)(count + 1) * 2 > slots.size())
+		Rebuild(std::max(minimumSlots, slots.size() * 2));
+
+	unsigned long long key = Key(a, b);
+	PairContact &entry = slots[SlotOf(key)];
+	bool isNew = entry.key == emptyPairKey;
+	if (isNew)
+	{
+		entry = PairContact();
+		entry.key = key;
+		entry.side = SIDE_IGNORED;
+		entry.firstStep = step;
+		count++;
+		numInserted++;
+	}
+
+	entry.lastStep = step;
+	if (created) *created = isNew;
+	return entry;
+}
+
+void PairCache::Remove(size_t slot)
+{
+	//Pull back every later entry of the run which may live in the gap, so no probe
+	//sequence is broken by it and the table needs no tombstones
+	size_t mask = slots.size() - 1;
+	size_t gap = slot;
+	for (size_t next = (slot + 1) & mask; slots[next].key != emptyPairKey; next = (next + 1) & mask)
+	{
+		size_t home = (size_t)HashKey(slots[next].key) & mask;
+		if (((next - home) & mask) >= ((next - gap) & mask))
+		{
+			slots[gap] = slots[next];
+			gap = next;
+		}
+	}
+	slots[gap].key = emptyPairKey;
+	count--;
+}
+
+int PairCache::Recycle(unsigned int maxIdleSteps)
+{
+	if (count == 0) return 0;
+
+	//Start just past an empty slot, so entries pulled back by Remove never cross the start.
+	//The table is at most half full, so there always is one.
+	size_t mask = slots.size() - 1;
+	size_t start = 0;
+	while (slots[start].key != emptyPairKey)
+		start++;
+
+	int numStale = 0;
+	for (size_t n = 1; n <= slots.size(); n++)
+	{
+		size_t i = (start + n) & mask;
+
+		//An entry pulled back into this slot is checked too
+		while (slots[i].key != emptyPairKey && step - slots[i].lastStep > maxIdleSteps)
+		{
+			Remove(i);
+			numStale++;
+		}
+	}
+	numRecycled += numStale;
+
+	//Shrink when mostly empty
+	size_t capacity = slots.size();
+	while (capacity > minimumSlots && (size_t)count * 8 < capacity)
+		capacity /= 2;
+	if (capacity != slots.size())
+		Rebuild(capacity);
+
+	return numStale;
+}
+
+void PairCache::Clear()
+{
+	slots.clear();
+	count = 0;
+}
+
+void PairCache::Rebuild(size_t capacity)
+{
+	scratch.clear();
+	for (size_t i = 0; i < slots.size(); i++)
+	{
+		if (slots[i].key != emptyPairKey) scratch.push_back(slots[i]);
+	}
+
+	PairContact empty = PairContact();
+	empty.key = emptyPairKey;
+	slots.assign(capacity, empty);
+
+	for (size_t i = 0; i < scratch.size(); i++)
+		slots[SlotOf(scratch[i].key)] = scratch[i];
+}
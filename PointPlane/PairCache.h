@@ -0,0 +1,151 @@
+/*
+Title: Point - Plane
+File Name: PairCache.h
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+Description:
+What was learned about each pair of bodies the last time they were tested,
+kept from one step to the next. A pair whose bodies haven't moved since then
+doesn't need testing again, and a contact which lasts many steps keeps its
+data rather than having it worked out afresh every step.
+
+Pairs are keyed by the handles of their two bodies and stored in an open
+addressed table with linear probing, so a lookup is a hash and usually a
+single cache line. Entries not touched for a while are stale and are
+recycled, so the table only grows with the pairs which are actually in use.
+Recycled entries are removed by shifting the rest of their run back, so the
+table never needs rebuilding unless it grows or shrinks.
+*/
+
+#ifndef _PAIR_CACHE_H
+#define _PAIR_CACHE_H
+
+#include "Collision.h"
+
+//Everything remembered about one pair of bodies
+struct PairContact
+{
+	unsigned long long key;	//Both handles, the smaller one in the high bits
+
+	float distance;			//Signed distance of the point from the plane
+	signed char side;		//PlaneSide of the point
+	glm::vec3 contactPoint;	//The point moved onto the plane along its normal
+
+	//The versions of the two bodies the entry was worked out from, in handle order
+	unsigned int versions[2];
+
+	unsigned int firstStep;	//Step the pair entered the cache
+	unsigned int lastStep;	//Step the pair was last touched
+
+	///
+	//Returns how many steps in a row the pair has stayed in the cache
+	unsigned int Age() const
+	{
+		return lastStep - firstStep;
+	}
+};
+
+struct PairCache
+{
+	//Power of two sized, empty slots have a key of emptyPairKey
+	std::vector<PairContact> slots;
+	int count;
+
+	//Counts the steps, for the age of the entries
+	unsigned int step;
+
+	//Over the life of the cache
+	long long numInserted;
+	long long numRecycled;
+
+	PairCache()
+	{
+		count = 0;
+		step = 0;
+		numInserted = 0;
+		numRecycled = 0;
+	}
+
+	///
+	//Finds the entry of a pair of bodies
+	//
+	//Returns:
+	//	The entry, or nullptr if the pair isn't cached. The pointer is good until the next Touch or Recycle.
+	PairContact* Find(unsigned int a, unsigned int b);
+
+	///
+	//Finds the entry of a pair of bodies, adding it if it isn't cached, and marks it as used this step
+	//
+	//Parameters:
+	//	a, b: Handles of the two bodies, in either order. 0xFFFFFFFF is reserved.
+	//	created: If not nullptr, set to whether the entry was just added. A new entry
+	//		has only its key and steps filled in.
+	//
+	//Returns:
+	//	The entry, good until the next Touch or Recycle
+	PairContact &Touch(unsigned int a, unsigned int b, bool* created);
+
+	///
+	//Starts a new step, aging every entry by one
+	void NextStep()
+	{
+		step++;
+	}
+
+	///
+	//Removes the entries which haven't been touched in more than maxIdleSteps steps
+	//
+	//Returns:
+	//	The number of entries removed
+	int Recycle(unsigned int maxIdleSteps);
+
+	///
+	//Removes every entry
+	void Clear();
+
+	///
+	//Returns the bytes of memory held by the cache
+	size_t MemoryUsed() const
+	{
+		return slots.capacity() * sizeof(PairContact);
+	}
+
+	///
+	//Builds the key of a pair of bodies. The pair is the same whichever order the handles are given in.
+	static unsigned long long Key(unsigned int a, unsigned int b)
+	{
+		return a < b ? ((unsigned long long)a << 32) | b : ((unsigned long long)b << 32) | a;
+	}
+
+private:
+	//Entries moved while the table is rebuilt
+	std::vector<PairContact> scratch;
+
+	size_t SlotOf(unsigned long long key) const;
+	void Remove(size_t slot);
+	void Rebuild(size_t capacity);
+};
+
+//The key of an empty slot, which no pair of valid handles can have
+const unsigned long long emptyPairKey = 0xFFFFFFFFFFFFFFFFull;
+
+#endif //_PAIR_CACHE_H
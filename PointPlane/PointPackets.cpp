@@ -0,0 +1,207 @@
+/*
+Title: Point - Plane
+File Name: PointPackets.cpp
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+Classification of points which arrive in spatially coherent packets.
+*/
+
+#include "PointPackets.h"
+#include "PointTree.h"
+#include "Telemetry.h"
+#include <cstring>
+
+//Fits a packet's box and sphere to its points
+static void FitPacket(PointPacket &packet, const PointSet &points)
+{
+	int end = packet.first + packet.count;
+
+	glm::vec3 low(FLT_MAX), high(-FLT_MAX);
+	for (int i = packet.first; i < end; i++)
+	{
+		glm::vec3 p(points.x[i], points.y[i], points.z[i]);
+		low = glm::min(low, p);
+		high = glm::max(high, p);
+	}
+	packet.center = (low + high) * 0.5f;
+	packet.extent = (high - low) * 0.5f;
+
+	float radiusSquared = 0.0f;
+	for (int i = packet.first; i < end; i++)
+	{
+		glm::vec3 offset = glm::vec3(points.x[i], points.y[i], points.z[i]) - packet.center;
+		radiusSquared = std::max(radiusSquared, glm::dot(offset, offset));
+	}
+	packet.radius = sqrtf(radiusSquared);
+}
+
+//Gathers the collision layers of a packet's points
+static void FilterPacket(PointPacket &packet, const PointSet &points)
+{
+	packet.filter = points.FilterOf(packet.first);
+	packet.mixedFilters = false;
+	if (points.filters.empty()) return;
+
+	for (int i = packet.first; i < packet.first + packet.count; i++)
+	{
+		const CollisionFilter &filter = points.filters[i];
+		packet.mixedFilters = packet.mixedFilters || filter.layer != packet.filter.layer || filter.mask != packet.filter.mask;
+		packet.filter.layer |= filter.layer;
+		packet.filter.mask |= filter.mask;
+	}
+}
+
+void PacketSet::Build(const PointSet &points, int packetSize)
+{
+	int count = (int)points.Size();
+	packetSize = std::max(packetSize, 1);
+
+	packets.clear();
+	for (int first = 0; first < count; first += packetSize)
+	{
+		PointPacket packet;
+		packet.first = first;
+		packet.count = std::min(packetSize, count - first);
+		FitPacket(packet, points);
+		FilterPacket(packet, points);
+		packets.push_back(packet);
+	}
+}
+
+void PacketSet::Refit(const PointSet &points)
+{
+	for (size_t i = 0; i < packets.size(); i++)
+		FitPacket(packets[i], points);
+}
+
+int ClassifyPackets(const WorldPlane &plane, const PointSet &points, const PacketSet &packetSet, float acceptanceRange, signed char* sides, PacketStats* stats)
+{
+	float range = FLT_EPSILON + acceptanceRange;
+	bool infinite = plane.halfExtent <= 0.0f;
+	glm::vec3 reachNormal = glm::abs(plane.normal);
+	float normalLength = glm::length(plane.normal);
+	int numColliding = 0;
+
+	const std::vector<PointPacket> &packets = packetSet.packets;
+	PacketStats counted;
+	long long packetSkipped = 0;
+
+	for (size_t i = 0; i < packets.size(); i++)
+	{
+		const PointPacket &packet = packets[i];
+
+		//Packets with no point on a layer the plane collides with are skipped whole
+		if (!plane.filter.Interacts(packet.filter))
+		{
+			counted.packetsSkipped++;
+			counted.pointsSkipped += packet.count;
+			packetSkipped += packet.count;
+			if (sides) memset(sides + packet.first, SIDE_IGNORED, packet.count);
+			continue;
+		}
+
+		//Packets mixing layers can't be decided whole, so their points are checked one at a time
+		if (packet.mixedFilters)
+		{
+			counted.packetsTested++;
+			counted.pointsTested += packet.count;
+			numColliding += ClassifyFiltered(plane, points, packet.first, packet.first + packet.count, acceptanceRange,
+				sides ? sides + packet.first : nullptr, counted.pointsSkipped);
+			continue;
+		}
+
+		//How far the packet's points can be from the distance of its center
+		float dist = glm::dot(plane.normal, packet.center) - plane.distance;
+		float reach = std::min(glm::dot(reachNormal, packet.extent), packet.radius * normalLength);
+
+		//Leave room for rounding, so packets are only decided where every point's own test agrees
+		float slack = 4.0f * FLT_EPSILON * (fabs(plane.distance) + glm::dot(reachNormal, glm::abs(packet.center) + packet.extent + glm::abs(plane.center)));
+
+		PlaneSide side;
+		if (dist - reach > range + slack)
+		{
+			side = SIDE_FRONT;
+			counted.packetsFront++;
+		}
+		else if (dist + reach < -range - slack)
+		{
+			side = SIDE_BEHIND;
+			counted.packetsBehind++;
+		}
+		else if (infinite && fabs(dist) + reach <= range - slack)
+		{
+			side = SIDE_ON;
+			counted.packetsOn++;
+			numColliding += packet.count;
+		}
+		else
+		{
+			counted.packetsTested++;
+			counted.pointsTested += packet.count;
+			numColliding += ClassifyPoints(plane, &points.x[packet.first], &points.y[packet.first], &points.z[packet.first],
+				packet.count, acceptanceRange, sides ? sides + packet.first : nullptr);
+			continue;
+		}
+
+		if (sides) memset(sides + packet.first, (signed char)side, packet.count);
+	}
+
+	telemetry->pairsSkipped.fetch_add(packetSkipped, std::memory_order_relaxed);
+
+	if (stats)
+	{
+		stats->packetsBehind += counted.packetsBehind;
+		stats->packetsFront += counted.packetsFront;
+		stats->packetsOn += counted.packetsOn;
+		stats->packetsTested += counted.packetsTested;
+		stats->packetsSkipped += counted.packetsSkipped;
+		stats->pointsTested += counted.pointsTested;
+		stats->pointsSkipped += counted.pointsSkipped;
+	}
+
+	return numColliding;
+}
+
+//Applies a permutation to one array of a point set
+template <class Buffer>
+static void Permute(Buffer &values, const IndexBuffer &order)
+{
+	Buffer permuted(values.size());
+	for (size_t i = 0; i < order.size(); i++)
+		permuted[i] = values[order[i]];
+	values.swap(permuted);
+}
+
+void OrderPointsSpatially(PointSet &points, int runSize)
+{
+	//The leaves of a point tree are runs of nearby points
+	PointTree tree;
+	tree.Build(points, runSize, nullptr);
+
+	Permute(points.x, tree.order);
+	Permute(points.y, tree.order);
+	Permute(points.z, tree.order);
+	Permute(points.vx, tree.order);
+	Permute(points.vy, tree.order);
+	Permute(points.vz, tree.order);
+	if (!points.filters.empty()) Permute(points.filters, tree.order);
+}
@@ -0,0 +1,127 @@
+/*
+Title: Point - Plane
+File Name: PointPackets.h
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+Classification of points which arrive in spatially coherent packets.
+
+Each packet is a run of consecutive points with a bounding box and a
+bounding sphere around them. Before any of its points are looked at, a
+packet's bounds are tested against the plane, using whichever of the two
+reaches less far along the normal. A packet entirely behind or in front of
+the acceptance range has all of its sides written at once, as does a packet
+entirely inside the range of an infinite plane. Only packets which straddle
+the edge of the range run the per point test.
+
+Unlike PointTree there is no hierarchy and nothing is reordered, so the
+bounds are cheap enough to refit every step while the points move.
+*/
+
+#ifndef _POINT_PACKETS_H
+#define _POINT_PACKETS_H
+
+#include "Scene.h"
+
+//A run of consecutive points and the bounds around them
+struct PointPacket
+{
+	int first;
+	int count;
+
+	//Bounding box
+	glm::vec3 center;
+	glm::vec3 extent;
+
+	//Bounding sphere, around the center of the box
+	float radius;
+
+	//The union of the collision layers and masks of the packet's points
+	CollisionFilter filter;
+	bool mixedFilters;	//Whether the packet's points have different filters
+};
+
+//How much work a packet classification did
+struct PacketStats
+{
+	int packetsBehind;		//Packets classified wholesale as behind the plane
+	int packetsFront;		//Packets classified wholesale as in front of the plane
+	int packetsOn;			//Packets classified wholesale as colliding
+	int packetsTested;		//Packets which straddled the range, or mixed collision layers, and were tested point by point
+	int packetsSkipped;		//Packets with no point on a layer the plane collides with
+	long long pointsTested;
+	long long pointsSkipped;	//Points never tested because of their collision layers
+
+	PacketStats()
+	{
+		packetsBehind = 0;
+		packetsFront = 0;
+		packetsOn = 0;
+		packetsTested = 0;
+		packetsSkipped = 0;
+		pointsTested = 0;
+		pointsSkipped = 0;
+	}
+};
+
+struct PacketSet
+{
+	std::vector<PointPacket> packets;
+
+	///
+	//Splits a set of points into packets of consecutive points and fits their bounds.
+	//The collision layers of the points can't change without building the packets again.
+	//
+	//Parameters:
+	//	points: The points, already in a spatially coherent order
+	//	packetSize: Points per packet, the last packet may hold fewer
+	void Build(const PointSet &points, int packetSize);
+
+	///
+	//Fits the bounds of every packet to its points again, after the points have moved
+	void Refit(const PointSet &points);
+};
+
+///
+//Classifies packets of points against a plane, testing packet bounds before points
+//
+//Parameters:
+//	plane: The plane to test
+//	points: The points the packets were built from
+//	packets: The packets to classify
+//	acceptanceRange: Points this close to the plane are considered colliding
+//	sides: If not nullptr, filled with the PlaneSide of every point, exactly as ClassifyFiltered would
+//	stats: If not nullptr, the work done is added to it
+//
+//Returns:
+//	The number of colliding points
+int ClassifyPackets(const WorldPlane &plane, const PointSet &points, const PacketSet &packets, float acceptanceRange, signed char* sides, PacketStats* stats);
+
+///
+//Reorders points so that nearby points are next to each other, for scenes which
+//were not generated in packets. Velocities and collision layers are reordered along with the positions.
+//
+//Parameters:
+//	points: The points to reorder
+//	runSize: Number of consecutive points which should lie close together
+void OrderPointsSpatially(PointSet &points, int runSize);
+
+#endif //_POINT_PACKETS_H
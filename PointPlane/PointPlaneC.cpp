@@ -0,0 +1,251 @@
+/*
+Title: Point - Plane
+File Name: PointPlaneC.cpp
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+The C interface to the point - plane collision tests.
+*/
+
+#include "PointPlaneC.h"
+#include "Collision.h"
+#include "ThreadPool.h"
+#include <mutex>
+#include <new>
+#include <climits>
+
+#if defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+#include <intrin.h>
+#endif
+
+//Points gathered from a strided buffer at a time
+static const size_t gatherSize = 1024;
+
+//Points per task when a batch is split between threads
+static const size_t grain = 16384;
+
+//The pool behind pp_classify_planes, created by its first use
+static ThreadPool* pool = nullptr;
+static int poolThreads = 0;
+static std::mutex poolMutex;
+
+static ThreadPool* GetPool()
+{
+	std::lock_guard<std::mutex> lock(poolMutex);
+	if (pool == nullptr)
+		pool = new (std::nothrow) ThreadPool(poolThreads);
+	return pool;
+}
+
+static WorldPlane ToWorldPlane(const pp_plane &plane)
+{
+	return MakeWorldPlane(glm::vec3(plane.normal[0], plane.normal[1], plane.normal[2]),
+		glm::vec3(plane.center[0], plane.center[1], plane.center[2]), plane.half_extent);
+}
+
+static bool ValidPoints(const pp_points* points)
+{
+	return points != nullptr && (points->count == 0 || (points->x != nullptr && points->y != nullptr && points->z != nullptr && points->stride >= sizeof(float)));
+}
+
+//Classifies points [first, first + count) of a caller's buffer against a plane
+static size_t ClassifyRange(const WorldPlane &plane, const pp_points &points, size_t first, size_t count, float acceptanceRange, signed char* sides)
+{
+	//Separate arrays are read in place
+	if (points.stride == sizeof(float))
+	{
+		return ClassifyPoints(plane, points.x + first, points.y + first, points.z + first, (int)count, acceptanceRange, sides ? sides + first : nullptr);
+	}
+
+	//Anything else is gathered into small arrays which stay in the cache
+	float x[gatherSize], y[gatherSize], z[gatherSize];
+	size_t numColliding = 0;
+	for (size_t begin = first; begin < first + count; begin += gatherSize)
+	{
+		size_t size = std::min(gatherSize, first + count - begin);
+		const char* px = (const char*)points.x + begin * points.stride;
+		const char* py = (const char*)points.y + begin * points.stride;
+		const char* pz = (const char*)points.z + begin * points.stride;
+		for (size_t i = 0; i < size; i++)
+		{
+			x[i] = *(const float*)(px + i * points.stride);
+			y[i] = *(const float*)(py + i * points.stride);
+			z[i] = *(const float*)(pz + i * points.stride);
+		}
+		numColliding += ClassifyPoints(plane, x, y, z, (int)size, acceptanceRange, sides ? sides + begin : nullptr);
+	}
+	return numColliding;
+}
+
+extern "C"
+{
+
+int pp_abi_version(void)
+{
+	return PP_ABI_VERSION;
+}
+
+int pp_test_collision(const float normal[3], const float model_matrix[16], const float point[3])
+{
+	if (normal == nullptr || model_matrix == nullptr || point == nullptr) return PP_INVALID_ARGUMENT;
+
+	Plane collider(glm::vec3(normal[0], normal[1], normal[2]));
+	return TestCollision(collider, glm::make_mat4(model_matrix), glm::vec3(point[0], point[1], point[2])) ? 1 : 0;
+}
+
+int pp_classify_points(const pp_plane* plane, const pp_points* points, float acceptance_range, signed char* sides, size_t* num_colliding)
+{
+	if (plane == nullptr || !ValidPoints(points) || points->count > (size_t)INT_MAX) return PP_INVALID_ARGUMENT;
+
+	size_t numColliding = ClassifyRange(ToWorldPlane(*plane), *points, 0, points->count, acceptance_range, sides);
+	if (num_colliding) *num_colliding = numColliding;
+	return PP_OK;
+}
+
+int pp_classify_planes(const pp_plane* planes, size_t num_planes, const pp_points* points, float acceptance_range, signed char* sides, size_t* num_colliding)
+{
+	if ((planes == nullptr && num_planes > 0) || !ValidPoints(points) || points->count > (size_t)INT_MAX) return PP_INVALID_ARGUMENT;
+
+	ThreadPool* workers = GetPool();
+	if (workers == nullptr) return PP_OUT_OF_MEMORY;
+
+	size_t count = points->count;
+	size_t rangesPerPlane = std::max((count + grain - 1) / grain, (size_t)1);
+	std::vector<size_t> collisions;
+	std::vector<WorldPlane> worldPlanes;
+	try
+	{
+		collisions.assign(num_planes * rangesPerPlane, 0);
+		worldPlanes.resize(num_planes);
+	}
+	catch (const std::bad_alloc &)
+	{
+		return PP_OUT_OF_MEMORY;
+	}
+
+	for (size_t p = 0; p < num_planes; p++)
+		worldPlanes[p] = ToWorldPlane(planes[p]);
+
+	//Every plane and range of points is a separate task
+	ParallelRanges(workers->NumThreads() > 1 ? workers : nullptr, (int)(num_planes * rangesPerPlane), 1, [&](int begin, int end)
+	{
+		for (int task = begin; task < end; task++)
+		{
+			size_t p = task / rangesPerPlane;
+			size_t first = (task % rangesPerPlane) * grain;
+			if (first >= count) continue;
+			collisions[task] = ClassifyRange(worldPlanes[p], *points, first, std::min(grain, count - first), acceptance_range,
+				sides ? sides + p * count : nullptr);
+		}
+	});
+
+	if (num_colliding)
+	{
+		for (size_t p = 0; p < num_planes; p++)
+		{
+			num_colliding[p] = 0;
+			for (size_t r = 0; r < rangesPerPlane; r++)
+				num_colliding[p] += collisions[p * rangesPerPlane + r];
+		}
+	}
+	return PP_OK;
+}
+
+int pp_set_num_threads(int num_threads)
+{
+	if (num_threads < 0) return PP_INVALID_ARGUMENT;
+
+	std::lock_guard<std::mutex> lock(poolMutex);
+	delete pool;
+	poolThreads = num_threads;
+	pool = new (std::nothrow) ThreadPool(poolThreads);
+	return pool ? PP_OK : PP_OUT_OF_MEMORY;
+}
+
+int pp_get_num_threads(void)
+{
+	ThreadPool* workers = GetPool();
+	return workers ? workers->NumThreads() : 1;
+}
+
+unsigned int pp_simd_support(void)
+{
+	unsigned int support = 0;
+
+#if defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+	int info[4];
+	__cpuid(info, 0);
+	int maxLeaf = info[0];
+
+	__cpuid(info, 1);
+	bool osSavesAvx = (info[2] & (1 << 27)) && (_xgetbv(0) & 0x6) == 0x6;
+	if (info[3] & (1 << 26)) support |= PP_SIMD_SSE2;
+	if (info[2] & (1 << 19)) support |= PP_SIMD_SSE41;
+	if ((info[2] & (1 << 28)) && osSavesAvx) support |= PP_SIMD_AVX;
+
+	if (maxLeaf >= 7)
+	{
+		__cpuidex(info, 7, 0);
+		if ((info[1] & (1 << 5)) && osSavesAvx) support |= PP_SIMD_AVX2;
+		if ((info[1] & (1 << 16)) && osSavesAvx && (_xgetbv(0) & 0xE0) == 0xE0) support |= PP_SIMD_AVX512F;
+	}
+#elif defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("sse2")) support |= PP_SIMD_SSE2;
+	if (__builtin_cpu_supports("sse4.1")) support |= PP_SIMD_SSE41;
+	if (__builtin_cpu_supports("avx")) support |= PP_SIMD_AVX;
+	if (__builtin_cpu_supports("avx2")) support |= PP_SIMD_AVX2;
+	if (__builtin_cpu_supports("avx512f")) support |= PP_SIMD_AVX512F;
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+	support |= PP_SIMD_NEON;
+#endif
+
+	return support;
+}
+
+unsigned int pp_simd_compiled(void)
+{
+	unsigned int compiled = 0;
+
+	//x64 always has SSE2, and MSVC only defines __AVX__ and __AVX2__ for /arch:AVX and /arch:AVX2
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	compiled |= PP_SIMD_SSE2;
+#endif
+#if defined(__SSE4_1__) || defined(__AVX__)
+	compiled |= PP_SIMD_SSE41;
+#endif
+#if defined(__AVX__)
+	compiled |= PP_SIMD_AVX;
+#endif
+#if defined(__AVX2__)
+	compiled |= PP_SIMD_AVX2;
+#endif
+#if defined(__AVX512F__)
+	compiled |= PP_SIMD_AVX512F;
+#endif
+#if defined(__ARM_NEON) || defined(_M_ARM64)
+	compiled |= PP_SIMD_NEON;
+#endif
+
+	return compiled;
+}
+
+}
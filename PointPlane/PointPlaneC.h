@@ -0,0 +1,180 @@
+/*
+Title: Point - Plane
+File Name: PointPlaneC.h
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+A C interface to the point - plane collision tests, built as a shared library
+(PointPlaneC.vcxproj) which does not link GLFW, GLEW or OpenGL, so the tests can
+be called from any language with a C foreign function interface.
+
+Nothing is copied into the library. Points are read straight from the caller's
+buffers, which may be separate x, y and z arrays or interleaved records of any
+size, described by a pp_points. Results are written straight into the caller's
+arrays. Batches against many planes are split across a thread pool whose size
+can be set, and the SIMD instruction sets of the processor can be queried.
+
+Only plain C types cross the interface. The structures are passed in arrays, so
+they can't grow without breaking older programs: any change to pp_plane, pp_points
+or a function's parameters increments PP_ABI_VERSION, and programs should check
+pp_abi_version against the header they were built with. Every function returns
+PP_OK or a negative error code, apart from the queries.
+*/
+
+#ifndef _POINT_PLANE_C_H
+#define _POINT_PLANE_C_H
+
+#include <stddef.h>
+
+#if defined(_WIN32)
+	#if defined(PP_BUILD_LIBRARY)
+		#define PP_API __declspec(dllexport)
+	#else
+		#define PP_API __declspec(dllimport)
+	#endif
+#elif defined(__GNUC__)
+	#define PP_API __attribute__((visibility("default")))
+#else
+	#define PP_API
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//Incremented when the interface changes in a way older programs would notice
+#define PP_ABI_VERSION 1
+
+//Return codes
+#define PP_OK 0
+#define PP_INVALID_ARGUMENT -1
+#define PP_OUT_OF_MEMORY -2
+
+//Sides of a plane, written one signed char per point
+#define PP_SIDE_BEHIND -1
+#define PP_SIDE_ON 0
+#define PP_SIDE_FRONT 1
+
+//Instruction sets returned by pp_simd_support and pp_simd_compiled
+#define PP_SIMD_SSE2 0x01
+#define PP_SIMD_SSE41 0x02
+#define PP_SIMD_AVX 0x04
+#define PP_SIMD_AVX2 0x08
+#define PP_SIMD_AVX512F 0x10
+#define PP_SIMD_NEON 0x20
+
+//The acceptance range the demo uses for points
+#define PP_POINT_ACCEPTANCE_RANGE 0.002f
+
+//A plane in world space
+typedef struct pp_plane
+{
+	float normal[3];	//Unit length
+	float center[3];	//Any point on the plane, and the center of finite planes
+	float half_extent;	//Half the width of a finite plane, or 0 for an infinite plane
+} pp_plane;
+
+//Points in caller owned memory. The coordinates of point i are read from
+//x + i * stride bytes, y + i * stride bytes and z + i * stride bytes.
+//	Separate arrays: x, y and z point to the arrays and stride is sizeof(float)
+//	Interleaved xyz: x = base, y = base + 1, z = base + 2 and stride is 3 * sizeof(float)
+typedef struct pp_points
+{
+	const float* x;
+	const float* y;
+	const float* z;
+	size_t stride;	//In bytes
+	size_t count;
+} pp_points;
+
+///
+//Returns PP_ABI_VERSION as it was when the library was built
+PP_API int pp_abi_version(void);
+
+///
+//Tests one point against a plane collider with TestCollision, which accepts points
+//within PP_POINT_ACCEPTANCE_RANGE of the plane
+//
+//Parameters:
+//	normal: The plane's normal in model space
+//	model_matrix: The plane's model to world matrix, 16 floats in column major order (as glm stores them)
+//	point: The point in world space
+//
+//Returns:
+//	1 if the point collides with the plane, 0 if not, or PP_INVALID_ARGUMENT
+PP_API int pp_test_collision(const float normal[3], const float model_matrix[16], const float point[3]);
+
+///
+//Classifies points against one plane on the calling thread
+//
+//Parameters:
+//	plane: The plane
+//	points: The points
+//	acceptance_range: Points this close to the plane are considered colliding
+//	sides: Filled with the PP_SIDE of each point, may be NULL to only count
+//	num_colliding: Filled with the number of colliding points, may be NULL
+//
+//Returns:
+//	PP_OK or PP_INVALID_ARGUMENT
+PP_API int pp_classify_points(const pp_plane* plane, const pp_points* points, float acceptance_range, signed char* sides, size_t* num_colliding);
+
+///
+//Classifies points against many planes, split across the library's thread pool
+//
+//Parameters:
+//	planes: The planes
+//	num_planes: The number of planes
+//	points: The points
+//	acceptance_range: Points this close to a plane are considered colliding
+//	sides: num_planes * points->count values, filled plane by plane with the PP_SIDE of each point. May be NULL.
+//	num_colliding: num_planes values, filled with the number of points colliding with each plane. May be NULL.
+//
+//Returns:
+//	PP_OK, PP_INVALID_ARGUMENT or PP_OUT_OF_MEMORY
+PP_API int pp_classify_planes(const pp_plane* planes, size_t num_planes, const pp_points* points, float acceptance_range, signed char* sides, size_t* num_colliding);
+
+///
+//Sets the number of threads pp_classify_planes uses. Must not be called while a batch is running.
+//
+//Parameters:
+//	num_threads: Threads counting the calling thread, 0 for one per hardware thread, 1 to stay on the calling thread
+//
+//Returns:
+//	PP_OK, PP_INVALID_ARGUMENT or PP_OUT_OF_MEMORY
+PP_API int pp_set_num_threads(int num_threads);
+
+///
+//Returns the number of threads pp_classify_planes uses, counting the calling thread
+PP_API int pp_get_num_threads(void);
+
+///
+//Returns the PP_SIMD instruction sets this processor supports
+PP_API unsigned int pp_simd_support(void);
+
+///
+//Returns the PP_SIMD instruction sets the library was compiled to use
+PP_API unsigned int pp_simd_compiled(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //_POINT_PLANE_C_H
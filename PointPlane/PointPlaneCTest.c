@@ -0,0 +1,151 @@
+/*
+Title: Point - Plane
+File Name: PointPlaneCTest.c
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+A small C program which checks the PointPlaneC shared library. It classifies the
+same points stored as separate arrays and as interleaved records, against one
+plane and against several across the thread pool, and compares every answer with
+a direct computation. It prints each check and returns 0 only if all pass.
+*/
+
+#include "PointPlaneC.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#define NUM_POINTS 100000
+#define NUM_PLANES 8
+
+static int failures = 0;
+
+static void Check(int passed, const char* what)
+{
+	printf("%s: %s\n", passed ? "pass" : "FAIL", what);
+	if (!passed) failures++;
+}
+
+//The side of a point against an infinite plane, computed directly
+static signed char ExpectedSide(const pp_plane* plane, float x, float y, float z)
+{
+	float distance = plane->normal[0] * (x - plane->center[0]) + plane->normal[1] * (y - plane->center[1]) + plane->normal[2] * (z - plane->center[2]);
+	if (fabsf(distance) <= PP_POINT_ACCEPTANCE_RANGE * 0.5f) return PP_SIDE_ON;
+	if (fabsf(distance) < PP_POINT_ACCEPTANCE_RANGE * 2.0f) return 2;	//Too close to the edge of the range to call
+	return distance > 0.0f ? PP_SIDE_FRONT : PP_SIDE_BEHIND;
+}
+
+int main(void)
+{
+	static float x[NUM_POINTS], y[NUM_POINTS], z[NUM_POINTS];
+	static float interleaved[NUM_POINTS * 3];
+	static signed char sides[NUM_PLANES * NUM_POINTS];
+	static signed char interleavedSides[NUM_PLANES * NUM_POINTS];
+	pp_plane planes[NUM_PLANES];
+	size_t colliding[NUM_PLANES];
+	size_t interleavedColliding[NUM_PLANES];
+	pp_points separate, packed;
+	int i, p, matches;
+
+	float identity[16] = { 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1 };
+	float normal[3] = { 1.0f, 0.0f, 0.0f };
+	float onPlane[3] = { 0.0f, 0.5f, -0.25f };
+	float offPlane[3] = { 0.1f, 0.0f, 0.0f };
+
+	printf("ABI version %d, %d threads, SIMD supported 0x%x, compiled 0x%x\n",
+		pp_abi_version(), pp_get_num_threads(), pp_simd_support(), pp_simd_compiled());
+	Check(pp_abi_version() == PP_ABI_VERSION, "library and header ABI versions agree");
+
+	//The single point test
+	Check(pp_test_collision(normal, identity, onPlane) == 1, "a point on the plane collides");
+	Check(pp_test_collision(normal, identity, offPlane) == 0, "a point off the plane does not collide");
+	Check(pp_test_collision(NULL, identity, onPlane) == PP_INVALID_ARGUMENT, "a missing normal is rejected");
+
+	//Random points, a few of them placed on the first plane
+	srand(1);
+	for (i = 0; i < NUM_POINTS; i++)
+	{
+		x[i] = (float)rand() / RAND_MAX * 2.0f - 1.0f;
+		y[i] = (float)rand() / RAND_MAX * 2.0f - 1.0f;
+		z[i] = (float)rand() / RAND_MAX * 2.0f - 1.0f;
+		if (i % 100 == 0) x[i] = 0.25f;
+
+		interleaved[i * 3] = x[i];
+		interleaved[i * 3 + 1] = y[i];
+		interleaved[i * 3 + 2] = z[i];
+	}
+
+	for (p = 0; p < NUM_PLANES; p++)
+	{
+		float angle = p * 0.4f;
+		planes[p].normal[0] = cosf(angle);
+		planes[p].normal[1] = sinf(angle);
+		planes[p].normal[2] = 0.0f;
+		planes[p].center[0] = p == 0 ? 0.25f : 0.0f;
+		planes[p].center[1] = 0.0f;
+		planes[p].center[2] = 0.0f;
+		planes[p].half_extent = 0.0f;
+	}
+
+	separate.x = x;
+	separate.y = y;
+	separate.z = z;
+	separate.stride = sizeof(float);
+	separate.count = NUM_POINTS;
+
+	packed.x = interleaved;
+	packed.y = interleaved + 1;
+	packed.z = interleaved + 2;
+	packed.stride = 3 * sizeof(float);
+	packed.count = NUM_POINTS;
+
+	//One plane on the calling thread
+	Check(pp_classify_points(&planes[0], &separate, PP_POINT_ACCEPTANCE_RANGE, sides, &colliding[0]) == PP_OK, "classify one plane");
+	Check(colliding[0] >= NUM_POINTS / 100, "every point placed on the plane collides");
+
+	//Many planes on the thread pool, from both layouts
+	Check(pp_set_num_threads(4) == PP_OK && pp_get_num_threads() == 4, "use four threads");
+	Check(pp_classify_planes(planes, NUM_PLANES, &separate, PP_POINT_ACCEPTANCE_RANGE, sides, colliding) == PP_OK, "classify separate arrays");
+	Check(pp_classify_planes(planes, NUM_PLANES, &packed, PP_POINT_ACCEPTANCE_RANGE, interleavedSides, interleavedColliding) == PP_OK, "classify interleaved points");
+
+	matches = 1;
+	for (p = 0; p < NUM_PLANES; p++)
+	{
+		size_t count = 0;
+		matches = matches && colliding[p] == interleavedColliding[p];
+		for (i = 0; i < NUM_POINTS; i++)
+		{
+			signed char expected = ExpectedSide(&planes[p], x[i], y[i], z[i]);
+			signed char side = sides[p * NUM_POINTS + i];
+			matches = matches && side == interleavedSides[p * NUM_POINTS + i];
+			matches = matches && (expected == 2 || side == expected);
+			count += side == PP_SIDE_ON;
+		}
+		matches = matches && count == colliding[p];
+	}
+	Check(matches, "both layouts agree with a direct computation");
+
+	Check(pp_classify_planes(planes, NUM_PLANES, NULL, PP_POINT_ACCEPTANCE_RANGE, sides, colliding) == PP_INVALID_ARGUMENT, "missing points are rejected");
+	Check(pp_set_num_threads(-1) == PP_INVALID_ARGUMENT, "a negative thread count is rejected");
+
+	printf("%d checks failed\n", failures);
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,475 @@
+/*
+Title: Point - Plane
+File Name: PointPlaneChecks.cpp
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+Small deterministic checks of the parts of Point - Plane whose mistakes the timing
+sweeps would not show: snapshot and scene files, including damaged ones, the pair
+cache, collision layer filtering, trajectory crossings of finite planes, and the
+shared memory query protocol. Everything
+is generated from fixed seeds, so a run either passes every time or fails every time.
+It prints each check and returns 0 only if all pass.
+
+Usage: PointPlaneChecks
+The files it writes are removed before it returns.
+*/
+
+#include "Snapshot.h"
+#include "Scene.h"
+#include "PairCache.h"
+#include "PointPackets.h"
+#include "PointTree.h"
+#include "Trajectory.h"
+#include "SharedQueries.h"
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+#include <random>
+#include <map>
+#include <thread>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+static int failures = 0;
+
+static const char* snapshotFile = "PointPlaneChecks.snap";
+static const char* damagedFile = "PointPlaneChecks.damaged";
+static const char* sceneFile = "PointPlaneChecks.scene";
+
+static bool Check(bool passed, const char* what)
+{
+	std::cout << (passed ? "pass" : "FAIL") << ": " << what << std::endl;
+	if (!passed) failures++;
+	return passed;
+}
+
+///
+//Reads a whole file into memory
+//
+//Returns:
+//	The bytes of the file, or none if it can't be read
+static std::vector<char> ReadFile(const char* fileName)
+{
+	std::ifstream file(fileName, std::ios::in | std::ios::binary);
+	return std::vector<char>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+///
+//Writes the first size bytes of a buffer to a file
+static void WriteFile(const char* fileName, const std::vector<char> &bytes, size_t size)
+{
+	std::ofstream file(fileName, std::ios::out | std::ios::binary);
+	file.write(bytes.data(), size);
+}
+
+///
+//Returns true if two planes have the same geometry and collision layers
+static bool SamePlane(const WorldPlane &a, const WorldPlane &b)
+{
+	return a.normal == b.normal && a.distance == b.distance && a.center == b.center
+		&& a.tangent == b.tangent && a.bitangent == b.bitangent && a.halfExtent == b.halfExtent
+		&& a.filter.layer == b.filter.layer && a.filter.mask == b.filter.mask;
+}
+
+///
+//Returns true if two scenes hold the same points and planes. The filters are compared only if compareFilters is set.
+static bool SameScene(const Scene &a, const Scene &b, bool compareFilters)
+{
+	const FloatBuffer* arraysA[] = { &a.points.x, &a.points.y, &a.points.z, &a.points.vx, &a.points.vy, &a.points.vz };
+	const FloatBuffer* arraysB[] = { &b.points.x, &b.points.y, &b.points.z, &b.points.vx, &b.points.vy, &b.points.vz };
+	bool same = a.points.Size() == b.points.Size() && a.planes.size() == b.planes.size()
+		&& a.motion == b.motion && a.extent == b.extent && a.orbitSpeed == b.orbitSpeed;
+	for (int i = 0; i < 6 && same; i++)
+		same = std::equal(arraysA[i]->begin(), arraysA[i]->end(), arraysB[i]->begin());
+	for (size_t i = 0; i < a.planes.size() && same; i++)
+		same = SamePlane(a.planes[i], b.planes[i]);
+	if (compareFilters)
+	{
+		same = same && a.points.filters.size() == b.points.filters.size();
+		for (size_t i = 0; i < a.points.filters.size() && same; i++)
+			same = a.points.filters[i].layer == b.points.filters[i].layer && a.points.filters[i].mask == b.points.filters[i].mask;
+	}
+	return same;
+}
+
+///
+//Saves and loads snapshots, and makes sure damaged ones are refused
+static void CheckSnapshots()
+{
+	SimulationState state;
+	for (int i = 0; i < 40; i++)
+	{
+		state.translations.push_back(glm::translate(glm::mat4(1.0f), glm::vec3(i * 0.5f, -i * 0.25f, 1.0f)));
+		state.rotations.push_back(glm::rotate(glm::mat4(1.0f), i * 0.1f, glm::vec3(0.0f, 1.0f, 0.0f)));
+		state.scales.push_back(glm::mat4(1.0f));
+	}
+	state.colliderNormals.assign(3, glm::vec3(0.0f, 0.0f, 1.0f));
+	for (int i = 0; i < 120; i++)
+		state.pairStates.push_back((unsigned char)(i % 3 == 0));
+	state.selectedBody = 7;
+
+	SimulationState loaded;
+	Check(SaveSnapshot(state, snapshotFile, false) && LoadSnapshot(loaded, snapshotFile)
+		&& HashState(loaded) == HashState(state) && loaded.selectedBody == state.selectedBody, "an uncompressed snapshot round trips");
+
+	std::vector<char> plain = ReadFile(snapshotFile);
+	WriteFile(damagedFile, plain, 20);
+	Check(!LoadSnapshot(loaded, damagedFile), "a snapshot cut off in its header is refused");
+	WriteFile(damagedFile, plain, plain.size() - 10);
+	Check(!LoadSnapshot(loaded, damagedFile), "a snapshot cut off in its arrays is refused");
+
+	std::vector<char> badMagic = plain;
+	badMagic[0] ^= 0x55;
+	WriteFile(damagedFile, badMagic, badMagic.size());
+	Check(!LoadSnapshot(loaded, damagedFile), "a file with the wrong magic number is refused");
+
+	loaded = SimulationState();
+	Check(SaveSnapshot(state, snapshotFile, true) && LoadSnapshot(loaded, snapshotFile)
+		&& HashState(loaded) == HashState(state), "a compressed snapshot round trips");
+
+	//Every token of the payload claims a run of literals longer than the payload
+	std::vector<char> compressed = ReadFile(snapshotFile);
+	Check(compressed.size() < plain.size(), "the compressed snapshot is smaller");
+	std::fill(compressed.begin() + 36, compressed.end(), (char)0xFF);
+	WriteFile(damagedFile, compressed, compressed.size());
+	Check(!LoadSnapshot(loaded, damagedFile), "a corrupt compressed payload is refused");
+
+	Check(!LoadSnapshot(loaded, "PointPlaneChecks.missing"), "a missing snapshot is refused");
+}
+
+///
+//Saves and loads scenes in the current and the first file version, and makes sure damaged ones are refused
+static void CheckScenes()
+{
+	ScenarioSettings settings;
+	settings.numPoints = 3000;
+	settings.numPlanes = 5;
+	settings.finitePlanes = true;
+	settings.numLayers = 4;
+	settings.motion = MOTION_DRIFT;
+	Scene scene;
+	GenerateScene(settings, scene);
+
+	Scene loaded;
+	Check(SaveScene(scene, sceneFile) && LoadScene(loaded, sceneFile) && SameScene(scene, loaded, true), "a scene with collision layers round trips");
+
+	std::vector<char> bytes = ReadFile(sceneFile);
+	WriteFile(damagedFile, bytes, bytes.size() - 1);
+	Check(!LoadScene(loaded, damagedFile), "a scene cut off in its filters is refused");
+	WriteFile(damagedFile, bytes, 16);
+	Check(!LoadScene(loaded, damagedFile), "a scene cut off in its header is refused");
+
+	//numFilters follows the seven words of the first version's header
+	std::vector<char> wrongFilters = bytes;
+	unsigned int numFilters = 17;
+	memcpy(&wrongFilters[28], &numFilters, sizeof(numFilters));
+	WriteFile(damagedFile, wrongFilters, wrongFilters.size());
+	Check(!LoadScene(loaded, damagedFile), "a scene with filters for only some points is refused");
+
+	std::vector<char> tooManyPoints = bytes;
+	unsigned int numPoints = 0xF0000000;
+	memcpy(&tooManyPoints[8], &numPoints, sizeof(numPoints));
+	memcpy(&tooManyPoints[28], &numPoints, sizeof(numPoints));
+	WriteFile(damagedFile, tooManyPoints, tooManyPoints.size());
+	Check(!LoadScene(loaded, damagedFile), "a scene with a count larger than the file is refused");
+
+	std::vector<char> unknownMotion = bytes;
+	int motion = MOTION_ORBIT + 1;
+	memcpy(&unknownMotion[16], &motion, sizeof(motion));
+	WriteFile(damagedFile, unknownMotion, unknownMotion.size());
+	Check(!LoadScene(loaded, damagedFile), "a scene with an unknown motion is refused");
+
+	std::vector<char> newerVersion = bytes;
+	unsigned int version = 3;
+	memcpy(&newerVersion[4], &version, sizeof(version));
+	WriteFile(damagedFile, newerVersion, newerVersion.size());
+	Check(!LoadScene(loaded, damagedFile), "a scene from a newer version is refused");
+
+	//A version 1 file has no filters, and stores planes without them
+	std::ofstream file(damagedFile, std::ios::out | std::ios::binary);
+	unsigned int header[7] = { 0x43535050, 1, (unsigned int)scene.points.Size(), (unsigned int)scene.planes.size(), (unsigned int)scene.motion, 0, 0 };
+	memcpy(&header[5], &scene.extent, sizeof(float));
+	memcpy(&header[6], &scene.orbitSpeed, sizeof(float));
+	file.write((const char*)header, sizeof(header));
+	const FloatBuffer* arrays[] = { &scene.points.x, &scene.points.y, &scene.points.z, &scene.points.vx, &scene.points.vy, &scene.points.vz };
+	for (int i = 0; i < 6; i++)
+		file.write((const char*)arrays[i]->data(), arrays[i]->size() * sizeof(float));
+	for (size_t i = 0; i < scene.planes.size(); i++)
+	{
+		const WorldPlane &plane = scene.planes[i];
+		float stored[14] = { plane.normal.x, plane.normal.y, plane.normal.z, plane.distance,
+			plane.center.x, plane.center.y, plane.center.z, plane.tangent.x, plane.tangent.y, plane.tangent.z,
+			plane.bitangent.x, plane.bitangent.y, plane.bitangent.z, plane.halfExtent };
+		file.write((const char*)stored, sizeof(stored));
+	}
+	file.close();
+
+	Scene unfiltered = scene;
+	unfiltered.points.filters.clear();
+	for (size_t i = 0; i < unfiltered.planes.size(); i++)
+		unfiltered.planes[i].filter = CollisionFilter();
+	Check(LoadScene(loaded, damagedFile) && loaded.points.filters.empty() && SameScene(unfiltered, loaded, false), "a version 1 scene loads without filters");
+}
+
+///
+//Adds, finds and recycles pairs, comparing the cache against a map of when each pair was last touched
+static void CheckPairCache()
+{
+	PairCache cache;
+	bool created = false;
+	cache.NextStep();
+	cache.Touch(3, 7, &created);
+	Check(created && cache.count == 1, "a new pair is added");
+	cache.Touch(7, 3, &created);
+	Check(!created && cache.count == 1 && PairCache::Key(3, 7) == PairCache::Key(7, 3), "a pair is the same in either order");
+	Check(cache.Find(3, 8) == nullptr, "a pair never touched isn't found");
+	cache.Clear();
+	Check(cache.count == 0 && cache.Find(3, 7) == nullptr, "clearing removes every pair");
+
+	//Removing idle pairs shifts the pairs after them back, which must keep every other pair reachable
+	std::mt19937 random(3);
+	std::map<unsigned long long, unsigned int> lastTouched;
+	bool found = true;
+	bool recycled = true;
+	for (int step = 0; step < 500; step++)
+	{
+		cache.NextStep();
+		int touches = random() % 200;
+		for (int i = 0; i < touches; i++)
+		{
+			unsigned int a = random() % 300;
+			unsigned int b = random() % 300;
+			if (a == b) continue;
+			cache.Touch(a, b, nullptr);
+			lastTouched[PairCache::Key(a, b)] = cache.step;
+		}
+
+		int expected = 0;
+		for (std::map<unsigned long long, unsigned int>::iterator it = lastTouched.begin(); it != lastTouched.end();)
+		{
+			if (cache.step - it->second > 5)
+			{
+				it = lastTouched.erase(it);
+				expected++;
+			}
+			else
+				++it;
+		}
+		recycled = recycled && cache.Recycle(5) == expected && cache.count == (int)lastTouched.size();
+
+		for (std::map<unsigned long long, unsigned int>::iterator it = lastTouched.begin(); it != lastTouched.end() && found; ++it)
+		{
+			PairContact* contact = cache.Find((unsigned int)(it->first >> 32), (unsigned int)it->first);
+			found = contact != nullptr && contact->lastStep == it->second;
+		}
+	}
+	Check(recycled, "recycling removes exactly the idle pairs");
+	Check(found, "every pair still cached is found after recycling");
+}
+
+///
+//Classifies a layered scene linearly, in packets and in a point tree, against testing every pair
+static void CheckLayerFilters()
+{
+	ScenarioSettings settings;
+	settings.numPoints = 20000;
+	settings.numPlanes = 6;
+	settings.numLayers = 4;
+	settings.distribution = DISTRIBUTION_NEAR_PLANE;
+	Scene scene;
+	GenerateScene(settings, scene);
+	const PointSet &points = scene.points;
+	int numPoints = (int)points.Size();
+
+	//Every pair tested, with the pairs whose layers don't interact marked afterwards
+	SideBuffer expected((size_t)numPoints * scene.planes.size());
+	long long expectedHits = 0;
+	long long expectedSkipped = 0;
+	for (size_t p = 0; p < scene.planes.size(); p++)
+	{
+		signed char* planeSides = &expected[p * numPoints];
+		ClassifyPoints(scene.planes[p], points.x.data(), points.y.data(), points.z.data(), numPoints, pointAcceptanceRange, planeSides);
+		for (int i = 0; i < numPoints; i++)
+		{
+			if (!scene.planes[p].filter.Interacts(points.filters[i]))
+			{
+				planeSides[i] = SIDE_IGNORED;
+				expectedSkipped++;
+			}
+			else if (planeSides[i] == SIDE_ON)
+				expectedHits++;
+		}
+	}
+	Check(expectedHits > 0 && expectedSkipped > 0, "the layered scene has both colliding and skipped pairs");
+
+	SideBuffer sides;
+	long long numSkipped = 0;
+	long long hits = ClassifyScene(scene, pointAcceptanceRange, sides, &numSkipped);
+	Check(hits == expectedHits && numSkipped == expectedSkipped && sides == expected, "the filtered scene skips exactly the pairs which don't interact");
+
+	//A run starting partway through the points
+	std::vector<signed char> runSides(numPoints / 2);
+	numSkipped = 0;
+	ClassifyFiltered(scene.planes[0], points, numPoints / 4, numPoints / 4 + (int)runSides.size(), pointAcceptanceRange, runSides.data(), numSkipped);
+	Check(std::equal(runSides.begin(), runSides.end(), expected.begin() + numPoints / 4), "a run of points is filtered from its own first point");
+
+	PacketSet packets;
+	packets.Build(points, 256);
+	PacketStats stats;
+	SideBuffer packetSides((size_t)numPoints * scene.planes.size());
+	long long packetHits = 0;
+	for (size_t p = 0; p < scene.planes.size(); p++)
+		packetHits += ClassifyPackets(scene.planes[p], points, packets, pointAcceptanceRange, &packetSides[p * numPoints], &stats);
+	Check(packetHits == expectedHits && packetSides == expected, "packets agree with testing every pair");
+
+	PointTree tree;
+	tree.Build(points, 64, nullptr);
+	bool treeMatch = true;
+	for (size_t p = 0; p < scene.planes.size() && treeMatch; p++)
+	{
+		std::vector<int> treeHits;
+		tree.QueryBand(scene.planes[p], pointAcceptanceRange, treeHits);
+		std::sort(treeHits.begin(), treeHits.end());
+		std::vector<int> expectedIndices;
+		for (int i = 0; i < numPoints; i++)
+			if (expected[p * numPoints + i] == SIDE_ON) expectedIndices.push_back(i);
+		treeMatch = treeHits == expectedIndices;
+	}
+	Check(treeMatch, "the point tree finds the same colliding points");
+
+	Scene empty;
+	empty.planes.resize(2);
+	empty.planes[0].filter = CollisionFilter(2, 2);
+	numSkipped = 0;
+	Check(ClassifyScene(empty, pointAcceptanceRange, sides, &numSkipped) == 0 && sides.empty() && numSkipped == 0, "a scene without points has no collisions");
+}
+
+///
+//Finds the crossings of straight paths through and beside a finite plane
+static void CheckTrajectories()
+{
+	WorldPlane plane = MakeWorldPlane(glm::vec3(0.0f, 0.0f, 1.0f), glm::vec3(0.0f), 1.0f);
+	Trajectory path;
+	path.Resize(2);
+	path.z[0] = -1.0f;
+	path.z[1] = 1.0f;
+	path.time[1] = 1.0f;
+
+	//Passing beside the plane changes side once, without ever touching it
+	std::vector<TrajectoryCrossing> crossings;
+	path.x[0] = path.x[1] = 5.0f;
+	FindCrossings(plane, path, pointAcceptanceRange, 0, 0, crossings);
+	Check(crossings.size() == 1 && crossings[0].from == SIDE_BEHIND && crossings[0].to == SIDE_FRONT
+		&& fabs(crossings[0].position.z) < 1e-6f, "a path beside a finite plane crosses it once");
+
+	//Passing through the plane enters and leaves it within the segment
+	crossings.clear();
+	path.x[0] = path.x[1] = 0.5f;
+	FindCrossings(plane, path, pointAcceptanceRange, 0, 0, crossings);
+	Check(crossings.size() == 2 && crossings[0].to == SIDE_ON && crossings[1].from == SIDE_ON, "a path through a finite plane touches it");
+}
+
+#ifdef __linux__
+///
+//Writes a query of numPoints points at the origin against the plane x = 0, so every point collides
+static SharedQuery* BeginOriginQuery(SharedQueryClient &client, unsigned int id, int numPoints)
+{
+	SharedQuery* query = client.BeginQuery(id, 1, numPoints, pointAcceptanceRange);
+	QueryPlane* plane = client.Planes(query);
+	memset(plane, 0, sizeof(QueryPlane));
+	plane->normal[0] = 1.0f;
+	memset(client.Points(query), 0, numPoints * 3 * sizeof(float));
+	return query;
+}
+
+///
+//Sends queries to a shared memory server from two clients, including ones which point outside their own arena
+static void CheckSharedQueries()
+{
+	ThreadPool pool(2);
+	SharedQueryServer server;
+	if (!Check(server.Create("PointPlaneChecks", 2, 1 << 20, &pool), "create a shared query region")) return;
+	std::thread serverThread([&server]() { server.Run(); });
+
+	SharedQueryClient first, second;
+	if (Check(first.Attach("PointPlaneChecks") && second.Attach("PointPlaneChecks"), "two clients attach"))
+	{
+		SharedQuery* secondQuery = BeginOriginQuery(second, 1, 16);
+		memset((void*)second.Sides(secondQuery), 77, 16);
+
+		//The first client aims its answer at the second client's arena
+		SharedQuery* query = BeginOriginQuery(first, 2, 16);
+		query->sidesOffset = secondQuery->sidesOffset;
+		first.Submit(query);
+		SharedQuery* answer = first.WaitAnswer();
+		Check(answer->numColliding == 0 && second.Sides(secondQuery)[0] == 77, "a query into another client's arena is refused");
+		first.Finish(answer);
+
+		query = BeginOriginQuery(first, 3, 16);
+		query->pointsOffset = ~0ull - 100;
+		query->sidesOffset = ~0ull - 4;
+		first.Submit(query);
+		answer = first.WaitAnswer();
+		Check(answer->numColliding == 0, "a query whose offsets wrap around is refused");
+		first.Finish(answer);
+
+		//A head a whole ring ahead of the server would make it take billions of queries
+		unsigned int head = first.channel->submitHead.load();
+		first.channel->submitHead.store(head - 1);
+		std::this_thread::sleep_for(std::chrono::milliseconds(200));
+		first.channel->submitHead.store(head);
+
+		second.Submit(secondQuery);
+		answer = second.WaitAnswer();
+		Check(answer->numColliding == 16 && second.Sides(answer)[0] == SIDE_ON && second.Sides(answer)[15] == SIDE_ON, "a query inside its own arena is answered, after another channel's head was corrupt");
+		second.Finish(answer);
+	}
+	first.Detach();
+	second.Detach();
+
+	server.stopping = true;
+	serverThread.join();
+	server.Stop();
+}
+#endif
+
+int main()
+{
+	CheckSnapshots();
+	CheckScenes();
+	CheckPairCache();
+	CheckLayerFilters();
+	CheckTrajectories();
+#ifdef __linux__
+	CheckSharedQueries();
+#else
+	std::cout << "skip: shared memory queries are only served on Linux" << std::endl;
+#endif
+
+	std::remove(snapshotFile);
+	std::remove(damagedFile);
+	std::remove(sceneFile);
+
+	std::cout << failures << " checks failed" << std::endl;
+	return failures == 0 ? 0 : 1;
+}
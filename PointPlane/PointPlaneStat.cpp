@@ -0,0 +1,152 @@
+/*
+Title: Point - Plane
+File Name: PointPlaneStat.cpp
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+Prints the live counters of a running Point - Plane program. The program must
+have been started with --telemetry <name>. The counters are mapped read only,
+so watching them can't disturb the program.
+
+Usage: PointPlaneStat <name> [--interval ms] [--count n]
+Without --interval every counter is printed once. With it, one line of rates
+over each interval is printed, --count times or until interrupted.
+*/
+
+#include "Telemetry.h"
+#include <iostream>
+#include <iomanip>
+#include <thread>
+#include <chrono>
+#include <cstring>
+#include <cstdlib>
+
+//A copy of the counters taken at one moment
+struct TelemetrySample
+{
+	unsigned long long frames;
+	unsigned long long totalUpdateTime;
+	unsigned long long totalRenderTime;
+	unsigned long long totalSwapTime;
+	unsigned long long pairTests;
+	unsigned long long pairsSkipped;
+	unsigned long long pointsClassified;
+	unsigned long long queriesAnswered;
+	std::chrono::steady_clock::time_point time;
+};
+
+static TelemetrySample Sample(const TelemetryCounters &counters)
+{
+	TelemetrySample sample;
+	sample.frames = counters.frames.load(std::memory_order_relaxed);
+	sample.totalUpdateTime = counters.totalUpdateTime.load(std::memory_order_relaxed);
+	sample.totalRenderTime = counters.totalRenderTime.load(std::memory_order_relaxed);
+	sample.totalSwapTime = counters.totalSwapTime.load(std::memory_order_relaxed);
+	sample.pairTests = counters.pairTests.load(std::memory_order_relaxed);
+	sample.pairsSkipped = counters.pairsSkipped.load(std::memory_order_relaxed);
+	sample.pointsClassified = counters.PointsClassified();
+	sample.queriesAnswered = counters.queriesAnswered.load(std::memory_order_relaxed);
+	sample.time = std::chrono::steady_clock::now();
+	return sample;
+}
+
+static void PrintCounters(const TelemetryCounters &counters)
+{
+	std::cout << "process " << counters.processId << std::endl;
+	std::cout << "frames " << counters.frames.load() << std::endl;
+	std::cout << "last_update_ns " << counters.lastUpdateTime.load() << std::endl;
+	std::cout << "last_render_ns " << counters.lastRenderTime.load() << std::endl;
+	std::cout << "last_swap_ns " << counters.lastSwapTime.load() << std::endl;
+	std::cout << "total_update_ns " << counters.totalUpdateTime.load() << std::endl;
+	std::cout << "total_render_ns " << counters.totalRenderTime.load() << std::endl;
+	std::cout << "total_swap_ns " << counters.totalSwapTime.load() << std::endl;
+	std::cout << "max_frame_ns " << counters.maxFrameTime.load() << std::endl;
+	std::cout << "draw_calls " << counters.drawCalls.load() << std::endl;
+	std::cout << "pair_tests " << counters.pairTests.load() << std::endl;
+	std::cout << "pair_collisions " << counters.pairCollisions.load() << std::endl;
+	std::cout << "pairs_skipped " << counters.pairsSkipped.load() << std::endl;
+	std::cout << "points_classified " << counters.PointsClassified() << std::endl;
+	std::cout << "points_colliding " << counters.PointsColliding() << std::endl;
+	std::cout << "task_queue_depth " << counters.taskQueueDepth.load() << std::endl;
+	std::cout << "query_queue_depth " << counters.queryQueueDepth.load() << std::endl;
+	std::cout << "queries_answered " << counters.queriesAnswered.load() << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+	if (argc < 2)
+	{
+		std::cout << "Usage: PointPlaneStat <name> [--interval ms] [--count n]" << std::endl;
+		return 1;
+	}
+
+	int interval = 0;
+	int count = -1;
+	for (int i = 2; i < argc; i++)
+	{
+		bool hasValue = i + 1 < argc;
+		if (strcmp(argv[i], "--interval") == 0 && hasValue)
+			interval = atoi(argv[++i]);
+		else if (strcmp(argv[i], "--count") == 0 && hasValue)
+			count = atoi(argv[++i]);
+		else
+			std::cout << "Unknown argument: " << argv[i] << std::endl;
+	}
+
+	TelemetrySegment segment;
+	if (!segment.Attach(argv[1])) return 1;
+	const TelemetryCounters &counters = *segment.counters;
+
+	if (interval <= 0)
+	{
+		PrintCounters(counters);
+		return 0;
+	}
+
+	std::cout << "fps,update_ms,render_ms,swap_ms,max_frame_ms,pair_tests_per_s,pairs_skipped_per_s,mpoints_per_s,queries_per_s,task_queue,query_queue" << std::endl;
+	std::cout << std::fixed << std::setprecision(3);
+
+	TelemetrySample previous = Sample(counters);
+	for (int n = 0; n != count; n++)
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(interval));
+		TelemetrySample current = Sample(counters);
+
+		double seconds = std::chrono::duration<double>(current.time - previous.time).count();
+		double frames = (double)(current.frames - previous.frames);
+		double perFrame = frames > 0.0 ? 1e-6 / frames : 0.0;
+
+		std::cout << frames / seconds << ","
+			<< (current.totalUpdateTime - previous.totalUpdateTime) * perFrame << ","
+			<< (current.totalRenderTime - previous.totalRenderTime) * perFrame << ","
+			<< (current.totalSwapTime - previous.totalSwapTime) * perFrame << ","
+			<< counters.maxFrameTime.load(std::memory_order_relaxed) * 1e-6 << ","
+			<< (current.pairTests - previous.pairTests) / seconds << ","
+			<< (current.pairsSkipped - previous.pairsSkipped) / seconds << ","
+			<< (current.pointsClassified - previous.pointsClassified) / seconds / 1e6 << ","
+			<< (current.queriesAnswered - previous.queriesAnswered) / seconds << ","
+			<< counters.taskQueueDepth.load(std::memory_order_relaxed) << ","
+			<< counters.queryQueueDepth.load(std::memory_order_relaxed) << std::endl;
+
+		previous = current;
+	}
+	return 0;
+}
@@ -0,0 +1,420 @@
+/*
+Title: Point - Plane
+File Name: PointTree.cpp
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+A bounding volume tree over still points, for planes whose normal and
+distance can both change between queries.
+*/
+
+#include "PointTree.h"
+#include "Telemetry.h"
+
+//The same SSE2 test as the batch kernels in Collision.cpp
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define TREE_SSE2
+#include <emmintrin.h>
+#endif
+
+//Returned by NodeSide when a node has points both inside and outside the acceptance range
+static const int nodeStraddles = 2;
+
+//Deepest a tree over 2^31 points split at the median can be, plus room for both children
+static const int maxTreeDepth = 64;
+
+//A point and its original index, kept together while building so
+//partitioning moves through memory in order instead of jumping around
+struct BuildPoint
+{
+	glm::vec3 position;
+	int index;
+	CollisionFilter filter;
+};
+
+//Sets a node's bounding box to fit the points below it
+static void FitNode(TreeNode &node, const std::vector<BuildPoint> &items)
+{
+	glm::vec3 low(FLT_MAX), high(-FLT_MAX);
+	for (int i = node.first; i < node.first + node.count; i++)
+	{
+		low = glm::min(low, items[i].position);
+		high = glm::max(high, items[i].position);
+	}
+
+	node.center = (low + high) * 0.5f;
+	node.extent = (high - low) * 0.5f;
+
+	node.filter = CollisionFilter(0, 0);
+	node.mixedFilters = false;
+	for (int i = node.first; i < node.first + node.count; i++)
+	{
+		const CollisionFilter &filter = items[i].filter;
+		node.mixedFilters = node.mixedFilters || filter.layer != items[node.first].filter.layer || filter.mask != items[node.first].filter.mask;
+		node.filter.layer |= filter.layer;
+		node.filter.mask |= filter.mask;
+	}
+}
+
+///
+//Splits a node at the median of its longest axis until its children are small enough to be leaves
+//
+//Parameters:
+//	nodes: The node array to add children to
+//	nodeIndex: The node to split, whose first and count are already set
+//	items: The points in tree order, reordered in place below the node
+//	leafSize: Most points a leaf may hold
+//	depth: Depth of the node
+//	stopDepth: Depth at which nodes are left for later instead of split
+//	pending: Filled with the nodes left at stopDepth, or nullptr to split everything
+static void Subdivide(std::vector<TreeNode> &nodes, int nodeIndex, std::vector<BuildPoint> &items, int leafSize, int depth, int stopDepth, std::vector<int>* pending)
+{
+	FitNode(nodes[nodeIndex], items);
+	nodes[nodeIndex].children = -1;
+
+	TreeNode node = nodes[nodeIndex];
+	if (node.count <= leafSize) return;
+	if (pending && depth >= stopDepth)
+	{
+		pending->push_back(nodeIndex);
+		return;
+	}
+
+	int axis = 0;
+	if (node.extent.y > node.extent.x && node.extent.y >= node.extent.z) axis = 1;
+	else if (node.extent.z > node.extent.x && node.extent.z > node.extent.y) axis = 2;
+
+	int half = node.count / 2;
+	std::nth_element(items.begin() + node.first, items.begin() + node.first + half, items.begin() + node.first + node.count,
+		[axis](const BuildPoint &a, const BuildPoint &b) { return a.position[axis] < b.position[axis]; });
+
+	TreeNode left, right;
+	left.first = node.first;
+	left.count = half;
+	right.first = node.first + half;
+	right.count = node.count - half;
+
+	int children = (int)nodes.size();
+	nodes[nodeIndex].children = children;
+	nodes.push_back(left);
+	nodes.push_back(right);
+
+	Subdivide(nodes, children, items, leafSize, depth + 1, stopDepth, pending);
+	Subdivide(nodes, children + 1, items, leafSize, depth + 1, stopDepth, pending);
+}
+
+void PointTree::Build(const PointSet &points, int maxLeafSize, ThreadPool* pool)
+{
+	int count = (int)points.Size();
+	leafSize = std::max(maxLeafSize, 1);
+
+	nodes.clear();
+	std::vector<BuildPoint> items(count);
+	ParallelRanges(pool, count, 1 << 16, [&](int begin, int end)
+	{
+		for (int i = begin; i < end; i++)
+		{
+			items[i].position = glm::vec3(points.x[i], points.y[i], points.z[i]);
+			items[i].index = i;
+			items[i].filter = points.FilterOf(i);
+		}
+	});
+
+	if (count > 0)
+	{
+		TreeNode root;
+		root.first = 0;
+		root.count = count;
+		nodes.push_back(root);
+
+		if (pool == nullptr || pool->NumThreads() == 1)
+			Subdivide(nodes, 0, items, leafSize, 0, 0, nullptr);
+		else
+		{
+			//Split the top levels here until there are a few subtrees per thread
+			int stopDepth = 0;
+			while ((1 << stopDepth) < pool->NumThreads() * 4)
+				stopDepth++;
+
+			std::vector<int> pending;
+			Subdivide(nodes, 0, items, leafSize, 0, stopDepth, &pending);
+
+			//Build each subtree into its own array, each one owns a separate run of the points
+			std::vector<std::vector<TreeNode>> subtrees(pending.size());
+			pool->ParallelFor((int)pending.size(), [&](int i)
+			{
+				subtrees[i].push_back(nodes[pending[i]]);
+				Subdivide(subtrees[i], 0, items, leafSize, 0, 0, nullptr);
+			});
+
+			//Join them, moving each subtree's children to the end of the node array
+			for (size_t i = 0; i < pending.size(); i++)
+			{
+				std::vector<TreeNode> &subtree = subtrees[i];
+				int offset = (int)nodes.size() - 1;
+				for (size_t j = 0; j < subtree.size(); j++)
+				{
+					if (subtree[j].children >= 0) subtree[j].children += offset;
+				}
+
+				nodes[pending[i]] = subtree[0];
+				nodes.insert(nodes.end(), subtree.begin() + 1, subtree.end());
+			}
+		}
+	}
+
+	//Split the points back into arrays
+	order.resize(count);
+	x.resize(count);
+	y.resize(count);
+	z.resize(count);
+	filters.resize(points.filters.empty() ? 0 : count);
+	ParallelRanges(pool, count, 1 << 16, [&](int begin, int end)
+	{
+		for (int i = begin; i < end; i++)
+		{
+			order[i] = items[i].index;
+			x[i] = items[i].position.x;
+			y[i] = items[i].position.y;
+			z[i] = items[i].position.z;
+			if (!filters.empty()) filters[i] = items[i].filter;
+		}
+	});
+}
+
+//A plane set up once per query for testing many nodes
+struct NodePlane
+{
+	const WorldPlane* plane;
+	bool infinite;
+
+#ifdef TREE_SSE2
+	//Each vector holds x, y, z and a 0
+	__m128 normal;
+	__m128 reachNormal;		//|normal|
+	__m128 planeCenter;		//|center|
+#endif
+
+	NodePlane(const WorldPlane &worldPlane)
+	{
+		plane = &worldPlane;
+		infinite = worldPlane.halfExtent <= 0.0f;
+
+#ifdef TREE_SSE2
+		glm::vec3 absNormal = glm::abs(worldPlane.normal);
+		glm::vec3 absCenter = glm::abs(worldPlane.center);
+		normal = _mm_set_ps(0.0f, worldPlane.normal.z, worldPlane.normal.y, worldPlane.normal.x);
+		reachNormal = _mm_set_ps(0.0f, absNormal.z, absNormal.y, absNormal.x);
+		planeCenter = _mm_set_ps(0.0f, absCenter.z, absCenter.y, absCenter.x);
+#endif
+	}
+};
+
+///
+//Tests a node's bounding box against the acceptance range of a plane
+//
+//Overview:
+//	A box with center c and half size e reaches dot(|n|, e) either side of the distance
+//	of its center. With SSE2 the three dot products of the test are done at once, each
+//	summed x + y + z like glm::dot so the results match the scalar test bit for bit, and
+//	the front, behind and on conditions are then decided by one compare of four lanes.
+//
+//Returns:
+//	SIDE_BEHIND or SIDE_FRONT if every point below the node is outside the range on that side,
+//	SIDE_ON if every point is inside the range of an infinite plane, or nodeStraddles otherwise
+static int NodeSide(const TreeNode &node, const NodePlane &nodePlane, float range)
+{
+	const WorldPlane &plane = *nodePlane.plane;
+
+#ifdef TREE_SSE2
+	const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+	__m128 center = _mm_set_ps(0.0f, node.center.z, node.center.y, node.center.x);
+	__m128 extent = _mm_set_ps(0.0f, node.extent.z, node.extent.y, node.extent.x);
+
+	//One row per dot product, turned into columns so the sums run down the lanes
+	__m128 distRow = _mm_mul_ps(nodePlane.normal, center);
+	__m128 reachRow = _mm_mul_ps(nodePlane.reachNormal, extent);
+	__m128 slackRow = _mm_mul_ps(nodePlane.reachNormal, _mm_add_ps(_mm_add_ps(_mm_and_ps(center, absMask), extent), nodePlane.planeCenter));
+	__m128 zeroRow = _mm_setzero_ps();
+	_MM_TRANSPOSE4_PS(distRow, reachRow, slackRow, zeroRow);
+
+	//dot(n, c), dot(|n|, e) and dot(|n|, |c| + e + |plane center|)
+	alignas(16) float dots[4];
+	_mm_store_ps(dots, _mm_add_ps(_mm_add_ps(distRow, reachRow), slackRow));
+
+	float dist = dots[0] - plane.distance;
+	float reach = dots[1];
+
+	//Leave room for rounding, so whole nodes are only decided where every point's own test agrees
+	float slack = 4.0f * FLT_EPSILON * (fabs(plane.distance) + dots[2]);
+
+	//Lanes are front, behind and on. Front and behind are strict, on allows equality.
+	__m128 left = _mm_set_ps(0.0f, range - slack, -dist - reach, dist - reach);
+	__m128 right = _mm_set_ps(1.0f, fabs(dist) + reach, range + slack, range + slack);
+	int outside = _mm_movemask_ps(_mm_cmpgt_ps(left, right));
+	int inside = _mm_movemask_ps(_mm_cmpge_ps(left, right));
+
+	if (outside & 1) return SIDE_FRONT;
+	if (outside & 2) return SIDE_BEHIND;
+	if (nodePlane.infinite && (inside & 4)) return SIDE_ON;
+	return nodeStraddles;
+#else
+	glm::vec3 reachNormal = glm::abs(plane.normal);
+	float dist = glm::dot(plane.normal, node.center) - plane.distance;
+	float reach = glm::dot(reachNormal, node.extent);
+
+	//Leave room for rounding, so whole nodes are only decided where every point's own test agrees
+	float slack = 4.0f * FLT_EPSILON * (fabs(plane.distance) + glm::dot(reachNormal, glm::abs(node.center) + node.extent + glm::abs(plane.center)));
+
+	if (dist - reach > range + slack) return SIDE_FRONT;
+	if (dist + reach < -range - slack) return SIDE_BEHIND;
+	if (nodePlane.infinite && fabs(dist) + reach <= range - slack) return SIDE_ON;
+	return nodeStraddles;
+#endif
+}
+
+int PointTree::QueryBand(const WorldPlane &plane, float acceptanceRange, std::vector<int> &hits) const
+{
+	hits.clear();
+	if (nodes.empty()) return 0;
+
+	float range = FLT_EPSILON + acceptanceRange;
+	NodePlane nodePlane(plane);
+	std::vector<signed char> sides(leafSize);
+	long long numSkipped = 0;
+
+	int stack[maxTreeDepth];
+	int top = 0;
+	stack[top++] = 0;
+
+	while (top > 0)
+	{
+		const TreeNode &node = nodes[stack[--top]];
+
+		//No point below the node is on a layer the plane collides with
+		if (!plane.filter.Interacts(node.filter))
+		{
+			numSkipped += node.count;
+			continue;
+		}
+
+		int side = NodeSide(node, nodePlane, range);
+
+		if (side == SIDE_ON && !node.mixedFilters)
+			hits.insert(hits.end(), order.begin() + node.first, order.begin() + node.first + node.count);
+		else if (side == SIDE_ON || side == nodeStraddles)
+		{
+			if (node.children >= 0)
+			{
+				stack[top++] = node.children + 1;
+				stack[top++] = node.children;
+			}
+			else
+			{
+				//Straddling leaves use the same test as everything else, so the results match exactly.
+				//Points on layers the plane doesn't collide with are skipped before the test, and
+				//each run of the others between them is tested as one batch.
+				int end = node.first + node.count;
+				int runStart = node.first;
+				while (runStart < end)
+				{
+					if (node.mixedFilters && !plane.filter.Interacts(filters[runStart]))
+					{
+						numSkipped++;
+						runStart++;
+						continue;
+					}
+
+					int runEnd = runStart + 1;
+					while (runEnd < end && (!node.mixedFilters || plane.filter.Interacts(filters[runEnd])))
+						runEnd++;
+
+					ClassifyPoints(plane, &x[runStart], &y[runStart], &z[runStart], runEnd - runStart, acceptanceRange, sides.data());
+					for (int i = 0; i < runEnd - runStart; i++)
+					{
+						if (sides[i] == SIDE_ON)
+							hits.push_back(order[runStart + i]);
+					}
+					runStart = runEnd;
+				}
+			}
+		}
+	}
+
+	telemetry->pairsSkipped.fetch_add(numSkipped, std::memory_order_relaxed);
+	return (int)hits.size();
+}
+
+void PointTree::CountSides(const WorldPlane &plane, float acceptanceRange, int counts[3]) const
+{
+	counts[0] = counts[1] = counts[2] = 0;
+	if (nodes.empty()) return;
+
+	float range = FLT_EPSILON + acceptanceRange;
+	NodePlane nodePlane(plane);
+	std::vector<signed char> sides(leafSize);
+
+	int stack[maxTreeDepth];
+	int top = 0;
+	stack[top++] = 0;
+
+	while (top > 0)
+	{
+		const TreeNode &node = nodes[stack[--top]];
+		int side = NodeSide(node, nodePlane, range);
+
+		if (side != nodeStraddles)
+			counts[side + 1] += node.count;
+		else if (node.children >= 0)
+		{
+			stack[top++] = node.children + 1;
+			stack[top++] = node.children;
+		}
+		else
+		{
+			ClassifyPoints(plane, &x[node.first], &y[node.first], &z[node.first], node.count, acceptanceRange, sides.data());
+			for (int i = 0; i < node.count; i++)
+				counts[sides[i] + 1]++;
+		}
+	}
+}
+
+int PointTree::QueryBands(const std::vector<WorldPlane> &planes, float acceptanceRange, std::vector<std::vector<int>> &hits, ThreadPool* pool) const
+{
+	int numPlanes = (int)planes.size();
+	hits.resize(numPlanes);
+
+	std::atomic<int> numHits(0);
+	std::function<void(int)> query = [&](int i)
+	{
+		numHits += QueryBand(planes[i], acceptanceRange, hits[i]);
+	};
+
+	if (pool)
+		pool->ParallelFor(numPlanes, query);
+	else
+	{
+		for (int i = 0; i < numPlanes; i++)
+			query(i);
+	}
+
+	return numHits;
+}
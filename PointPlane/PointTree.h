@@ -0,0 +1,140 @@
+/*
+Title: Point - Plane
+File Name: PointTree.h
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+A bounding volume tree over still points, for planes whose normal and
+distance can both change between queries.
+
+The points are split at the median of the longest axis of their bounding
+box until at most a leaf's worth remain, like a KD-tree, but every node
+keeps its own tight bounding box. The points are then copied into the order
+of the tree's leaves, so every node covers one contiguous run of them.
+
+A box with center c and half size e reaches dot(|n|, e) either side of the
+plane from its center's distance dot(n, c) - d. A node entirely outside the
+acceptance range is skipped along with everything below it, and a node
+entirely inside it hands back its whole run of points without visiting its
+children. Only leaves which straddle the edge of the range test their
+points one at a time.
+
+The nodes live in one array with each pair of children next to each other,
+and are visited with a small stack instead of recursion.
+
+Every node also keeps the union of its points' collision layers and masks. A
+node whose union doesn't interact with the plane's layers can't hold a single
+point the plane collides with, so it is skipped without looking at its bounds.
+*/
+
+#ifndef _POINT_TREE_H
+#define _POINT_TREE_H
+
+#include "Scene.h"
+#include "ThreadPool.h"
+
+struct TreeNode
+{
+	glm::vec3 center;	//Center of the bounding box
+	glm::vec3 extent;	//Half the size of the bounding box on each axis
+	int first;			//First point below the node, in tree order
+	int count;			//Number of points below the node
+	int children;		//Index of the first of the two children, or -1 for a leaf
+
+	CollisionFilter filter;	//The union of the layers and masks of the points below the node
+	bool mixedFilters;		//Whether the points below the node have different filters
+};
+
+struct PointTree
+{
+	//Root first, the two children of a node are always adjacent
+	std::vector<TreeNode> nodes;
+
+	//The points in tree order
+	FloatBuffer x, y, z;
+
+	//The original index of each point in tree order
+	IndexBuffer order;
+
+	//The collision layers of the points in tree order, or empty if they all have the default filter
+	std::vector<CollisionFilter> filters;
+
+	//Most points a leaf holds
+	int leafSize;
+
+	PointTree()
+	{
+		leafSize = 64;
+	}
+
+	///
+	//Builds the tree over a set of points
+	//
+	//Overview:
+	//	The top few levels are split on the calling thread until there is
+	//	a subtree for every thread several times over. The subtrees are then
+	//	built in parallel and joined into the one node array.
+	//
+	//Parameters:
+	//	points: The points to index
+	//	maxLeafSize: Most points a leaf may hold
+	//	pool: Threads to build with, or nullptr to build on the calling thread
+	void Build(const PointSet &points, int maxLeafSize, ThreadPool* pool);
+
+	///
+	//Finds the points colliding with a plane of any orientation
+	//
+	//Parameters:
+	//	plane: The plane to test. Finite planes are supported, but whole nodes
+	//		are only accepted at once for infinite planes.
+	//	acceptanceRange: Points this close to the plane are considered colliding
+	//	hits: Filled with the original indices of the colliding points. Points whose
+	//		collision layers don't interact with the plane's are left out.
+	//
+	//Returns:
+	//	The number of colliding points
+	int QueryBand(const WorldPlane &plane, float acceptanceRange, std::vector<int> &hits) const;
+
+	///
+	//Counts the points on each side of a plane, as ClassifyPoints would classify them
+	//
+	//Parameters:
+	//	plane: The plane to test
+	//	acceptanceRange: Points this close to the plane are considered colliding
+	//	counts: Filled with the number of points behind, on and in front of the plane,
+	//		indexed by PlaneSide + 1
+	void CountSides(const WorldPlane &plane, float acceptanceRange, int counts[3]) const;
+
+	///
+	//Finds the points colliding with each of a batch of planes
+	//
+	//Parameters:
+	//	planes: The planes to test
+	//	acceptanceRange: Points this close to a plane are considered colliding
+	//	hits: Filled with the colliding points of each plane
+	//	pool: Threads to split the planes between, or nullptr to run on the calling thread
+	//
+	//Returns:
+	//	The number of colliding pairs
+	int QueryBands(const std::vector<WorldPlane> &planes, float acceptanceRange, std::vector<std::vector<int>> &hits, ThreadPool* pool) const;
+};
+
+#endif //_POINT_TREE_H
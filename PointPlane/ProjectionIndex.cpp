@@ -0,0 +1,77 @@
+/*
+Title: Point - Plane
+File Name: ProjectionIndex.cpp
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+An index of points sorted by their projection onto one fixed normal.
+*/
+
+#include "ProjectionIndex.h"
+
+void ProjectionIndex::Build(const PointSet &points, glm::vec3 indexNormal)
+{
+	normal = indexNormal;
+	int count = (int)points.Size();
+
+	//Project every point
+	std::vector<float> unsorted(count);
+	for (int i = 0; i < count; i++)
+		unsorted[i] = normal.x * points.x[i] + normal.y * points.y[i] + normal.z * points.z[i];
+
+	//Sort the point indices by projection
+	order.resize(count);
+	for (int i = 0; i < count; i++)
+		order[i] = i;
+	std::sort(order.begin(), order.end(), [&unsorted](int a, int b) { return unsorted[a] < unsorted[b]; });
+
+	//Store the projections in sorted order, so searches only touch one array
+	projections.resize(count);
+	for (int i = 0; i < count; i++)
+		projections[i] = unsorted[order[i]];
+}
+
+void ProjectionIndex::BandRange(float distance, float acceptanceRange, int &first, int &last) const
+{
+	//The same tolerance ClassifyPoints uses
+	float range = FLT_EPSILON + acceptanceRange;
+
+	//Search a slightly wider window, since distance - range rounds differently than the
+	//subtraction ClassifyPoints does per point
+	float margin = range + fabs(distance) * FLT_EPSILON;
+	first = (int)(std::lower_bound(projections.begin(), projections.end(), distance - range - margin) - projections.begin());
+	last = (int)(std::upper_bound(projections.begin() + first, projections.end(), distance + range + margin) - projections.begin());
+
+	//Then trim it with exactly the per point test, so both agree on points right at the edge.
+	//Only points behind the plane are trimmed from the start and only points in front from the end,
+	//so an empty run still sits between the points behind and the points in front.
+	while (first < last && projections[first] < distance && fabs(projections[first] - distance) > range) first++;
+	while (last > first && projections[last - 1] > distance && fabs(projections[last - 1] - distance) > range) last--;
+}
+
+int ProjectionIndex::QueryBand(const WorldPlane &plane, float acceptanceRange, std::vector<int> &hits) const
+{
+	int first, last;
+	BandRange(plane.distance, acceptanceRange, first, last);
+
+	hits.assign(order.begin() + first, order.begin() + last);
+	return last - first;
+}
@@ -0,0 +1,112 @@
+/*
+Title: Point - Plane
+File Name: ProjectionIndex.h
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+An index of points sorted by their projection onto one fixed normal.
+
+The signed distance from a point p to a plane is dot(normal, p) - distance. When
+a plane only translates, its normal stays the same and only its distance changes,
+so every point's projection dot(normal, p) stays the same too. Sorting the
+projections once turns "which points are within the acceptance range" into two
+binary searches: the colliding points are one contiguous run of the sorted order,
+with the points behind the plane before it and the points in front after it.
+*/
+
+#ifndef _PROJECTION_INDEX_H
+#define _PROJECTION_INDEX_H
+
+#include "Scene.h"
+
+struct ProjectionIndex
+{
+	//The normal the points were projected onto
+	glm::vec3 normal;
+
+	//Projections in increasing order
+	FloatBuffer projections;
+
+	//The point each sorted projection belongs to
+	IndexBuffer order;
+
+	ProjectionIndex()
+	{
+		normal = glm::vec3(1.0f, 0.0f, 0.0f);
+	}
+
+	///
+	//Projects and sorts a set of points
+	//
+	//Parameters:
+	//	points: The points to index
+	//	indexNormal: The normal to project onto
+	void Build(const PointSet &points, glm::vec3 indexNormal);
+
+	///
+	//Returns true if the index can answer queries for the given plane.
+	//Only infinite planes are supported, as finite planes also bound the points along the plane.
+	bool Matches(const WorldPlane &plane) const
+	{
+		return plane.normal == normal && plane.halfExtent <= 0.0f;
+	}
+
+	///
+	//Finds the run of sorted points within a range of the plane
+	//
+	//Parameters:
+	//	distance: The plane's distance along the normal
+	//	acceptanceRange: Points this close to the plane are considered colliding
+	//	first: Filled with the first sorted position within range. Every earlier point is behind the plane.
+	//	last: Filled with one past the last sorted position within range. Every later point is in front.
+	void BandRange(float distance, float acceptanceRange, int &first, int &last) const;
+
+	///
+	//Finds the points colliding with a plane which shares the index normal
+	//
+	//Overview:
+	//	Two binary searches find the run of colliding points, so the cost is
+	//	O(log N) plus the number of hits instead of O(N).
+	//
+	//Parameters:
+	//	plane: The plane to test, which must match the index
+	//	acceptanceRange: Points this close to the plane are considered colliding
+	//	hits: Filled with the indices of the colliding points
+	//
+	//Returns:
+	//	The number of colliding points
+	int QueryBand(const WorldPlane &plane, float acceptanceRange, std::vector<int> &hits) const;
+
+	///
+	//Returns which side of a plane a point lies on, given its position in the sorted order
+	//
+	//Parameters:
+	//	sortedPosition: The position of the point in the sorted order
+	//	first, last: The run found by BandRange
+	static PlaneSide SideAt(int sortedPosition, int first, int last)
+	{
+		if (sortedPosition < first) return SIDE_BEHIND;
+		if (sortedPosition >= last) return SIDE_FRONT;
+		return SIDE_ON;
+	}
+};
+
+#endif //_PROJECTION_INDEX_H
@@ -0,0 +1,562 @@
+/*
+Title: Point - Plane
+File Name: QueryServer.cpp
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+Answers point - plane classification queries from other processes over a UNIX domain socket.
+*/
+
+#include "QueryServer.h"
+#include "Telemetry.h"
+#include <cstring>
+
+#ifdef __linux__
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/epoll.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <cerrno>
+#endif
+
+QueryServer::QueryServer()
+{
+	listenSocket = -1;
+	epollFd = -1;
+	pool = nullptr;
+	grain = 16384;
+	stopping = false;
+	numQueries = 0;
+	numBatches = 0;
+	numPoints = 0;
+}
+
+QueryServer::~QueryServer()
+{
+	Stop();
+}
+
+void QueryServer::PrintSummary(std::ostream &out) const
+{
+	out << "Answered " << numQueries << " queries of " << numPoints << " points in " << numBatches << " batches";
+	if (numBatches > 0)
+		out << " (" << (double)numQueries / numBatches << " queries per batch)";
+	out << std::endl;
+}
+
+#ifdef __linux__
+
+bool QueryServer::Start(const std::string &path, ThreadPool* workers)
+{
+	sockaddr_un address;
+	memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	if (path.size() >= sizeof(address.sun_path))
+	{
+		std::cout << "Socket path is too long: " << path.data() << std::endl;
+		return false;
+	}
+	strcpy(address.sun_path, path.c_str());
+
+	listenSocket = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+	unlink(path.c_str());
+	if (listenSocket < 0 || bind(listenSocket, (sockaddr*)&address, sizeof(address)) != 0 || listen(listenSocket, 128) != 0)
+	{
+		std::cout << "Can't listen on socket: " << path.data() << " (" << strerror(errno) << ")" << std::endl;
+		Stop();
+		return false;
+	}
+	socketPath = path;
+
+	epollFd = epoll_create1(EPOLL_CLOEXEC);
+	epoll_event event;
+	event.events = EPOLLIN;
+	event.data.fd = listenSocket;
+	epoll_ctl(epollFd, EPOLL_CTL_ADD, listenSocket, &event);
+
+	pool = workers;
+	stopping = false;
+	return true;
+}
+
+void QueryServer::Stop()
+{
+	for (std::unordered_map<int, QueryConnection*>::iterator i = connections.begin(); i != connections.end(); ++i)
+	{
+		close(i->first);
+		delete i->second;
+	}
+	connections.clear();
+	pending.clear();
+
+	if (epollFd >= 0) close(epollFd);
+	if (listenSocket >= 0) close(listenSocket);
+	if (!socketPath.empty()) unlink(socketPath.c_str());
+	epollFd = -1;
+	listenSocket = -1;
+	socketPath.clear();
+}
+
+void QueryServer::Run()
+{
+	const int maxEvents = 64;
+	epoll_event events[maxEvents];
+
+	while (!stopping)
+	{
+		//Wake up now and then to check whether we should stop
+		int numEvents = epoll_wait(epollFd, events, maxEvents, 100);
+		if (numEvents < 0 && errno != EINTR) break;
+
+		for (int i = 0; i < numEvents; i++)
+		{
+			if (events[i].data.fd == listenSocket)
+			{
+				Accept();
+				continue;
+			}
+
+			std::unordered_map<int, QueryConnection*>::iterator found = connections.find(events[i].data.fd);
+			if (found == connections.end()) continue;
+			QueryConnection* connection = found->second;
+
+			if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR))
+				Receive(connection);
+			if ((events[i].events & EPOLLOUT) && !connection->closed)
+				Send(connection);
+		}
+
+		//Everything which arrived together is answered together
+		AnswerPending();
+
+		//Only forget closed connections once no pending query can refer to them
+		for (std::unordered_map<int, QueryConnection*>::iterator i = connections.begin(); i != connections.end();)
+		{
+			//A client which shut down its side and has every answer is done
+			if (i->second->inputClosed && i->second->output.empty())
+				Close(i->second);
+
+			if (i->second->closed)
+			{
+				close(i->first);
+				delete i->second;
+				i = connections.erase(i);
+			}
+			else
+				++i;
+		}
+	}
+}
+
+void QueryServer::Accept()
+{
+	for (;;)
+	{
+		int fd = accept4(listenSocket, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+		if (fd < 0) return;
+
+		epoll_event event;
+		event.events = EPOLLIN;
+		event.data.fd = fd;
+		epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event);
+		connections[fd] = new QueryConnection(fd);
+	}
+}
+
+void QueryServer::Close(QueryConnection* connection)
+{
+	if (connection->closed) return;
+	epoll_ctl(epollFd, EPOLL_CTL_DEL, connection->socket, nullptr);
+	connection->closed = true;
+}
+
+void QueryServer::Receive(QueryConnection* connection)
+{
+	if (connection->inputClosed) return;
+
+	std::vector<unsigned char> &input = connection->input;
+	unsigned char buffer[65536];
+	bool endOfInput = false;
+
+	for (;;)
+	{
+		ssize_t numRead = recv(connection->socket, buffer, sizeof(buffer), 0);
+		if (numRead > 0)
+		{
+			input.insert(input.end(), buffer, buffer + numRead);
+			continue;
+		}
+
+		//A client which shuts down its side still gets the answers to the queries it sent
+		if (numRead == 0)
+		{
+			endOfInput = true;
+			break;
+		}
+		if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+		{
+			Close(connection);
+			return;
+		}
+		if (errno != EINTR) break;
+	}
+
+	//Split off every complete query
+	size_t used = 0;
+	while (input.size() - used >= sizeof(QueryHeader))
+	{
+		const QueryHeader* header = (const QueryHeader*)(input.data() + used);
+		if (header->magic != queryMagic || header->numPlanes > maxQueryPlanes || header->numPoints > maxQueryPoints
+			|| (unsigned long long)header->numPlanes * header->numPoints > maxQuerySides)
+		{
+			std::cout << "Closing a client which sent a malformed query" << std::endl;
+			Close(connection);
+			return;
+		}
+
+		size_t size = sizeof(QueryHeader) + header->numPlanes * sizeof(QueryPlane) + header->numPoints * 3 * sizeof(float);
+		if (input.size() - used < size) break;
+
+		PendingQuery query;
+		query.connection = connection;
+		query.message.assign(input.begin() + used, input.begin() + used + size);
+		pending.push_back(std::move(query));
+		used += size;
+	}
+	input.erase(input.begin(), input.begin() + used);
+
+	//Nothing more will arrive. Only listen for the socket becoming writable, and close once the answers are written.
+	if (endOfInput)
+	{
+		connection->inputClosed = true;
+		input.clear();
+
+		epoll_event event;
+		event.events = connection->output.empty() ? 0u : (unsigned int)EPOLLOUT;
+		event.data.fd = connection->socket;
+		epoll_ctl(epollFd, EPOLL_CTL_MOD, connection->socket, &event);
+	}
+}
+
+void QueryServer::Send(QueryConnection* connection)
+{
+	std::vector<unsigned char> &output = connection->output;
+
+	while (connection->outputSent < output.size())
+	{
+		ssize_t numSent = send(connection->socket, output.data() + connection->outputSent, output.size() - connection->outputSent, MSG_NOSIGNAL);
+		if (numSent > 0)
+		{
+			connection->outputSent += numSent;
+			continue;
+		}
+		if (errno == EINTR) continue;
+		if (errno != EAGAIN && errno != EWOULDBLOCK) Close(connection);
+		break;
+	}
+
+	bool finished = connection->outputSent == output.size();
+	if (finished)
+	{
+		output.clear();
+		connection->outputSent = 0;
+		if (connection->inputClosed) Close(connection);
+	}
+
+	//Only ask to hear about a writable socket while answers are waiting
+	if (!connection->closed)
+	{
+		unsigned int reading = connection->inputClosed ? 0u : (unsigned int)EPOLLIN;
+		epoll_event event;
+		event.events = finished ? reading : reading | EPOLLOUT;
+		event.data.fd = connection->socket;
+		epoll_ctl(epollFd, EPOLL_CTL_MOD, connection->socket, &event);
+	}
+}
+
+void QueryServer::AnswerPending()
+{
+	telemetry->queryQueueDepth.store(pending.size(), std::memory_order_relaxed);
+	if (pending.empty()) return;
+
+	//Queries with byte for byte identical planes and range are joined into one batch,
+	//and a new batch is started whenever one would answer more than maxQuerySides sides
+	std::unordered_map<std::string, int> batchOfPlanes;
+	std::vector<int> queryBatch(pending.size());
+	std::vector<size_t> queryOffset(pending.size());
+	std::vector<std::vector<int>> batchQueries;
+	std::vector<unsigned long long> batchSideCount;
+
+	for (size_t q = 0; q < pending.size(); q++)
+	{
+		const QueryHeader &header = pending[q].Header();
+		std::string key((const char*)&header.acceptanceRange, sizeof(float));
+		key.append((const char*)(pending[q].message.data() + sizeof(QueryHeader)), header.numPlanes * sizeof(QueryPlane));
+
+		unsigned long long numSides = (unsigned long long)header.numPlanes * header.numPoints;
+		std::unordered_map<std::string, int>::iterator found = batchOfPlanes.find(key);
+		if (found == batchOfPlanes.end())
+			found = batchOfPlanes.insert(std::make_pair(key, -1)).first;
+		if (found->second < 0 || batchSideCount[found->second] + numSides > maxQuerySides)
+		{
+			found->second = (int)batchQueries.size();
+			batchQueries.push_back(std::vector<int>());
+			batchSideCount.push_back(0);
+		}
+		batchSideCount[found->second] += numSides;
+		queryBatch[q] = found->second;
+		batchQueries[found->second].push_back((int)q);
+	}
+
+	std::vector<std::vector<signed char>> batchSides(batchQueries.size());
+	std::vector<std::vector<int>> batchCollisions(batchQueries.size());
+	std::vector<float> x, y, z;
+	std::vector<WorldPlane> planes;
+
+	for (size_t b = 0; b < batchQueries.size(); b++)
+	{
+		const std::vector<int> &queries = batchQueries[b];
+		const QueryHeader &first = pending[queries[0]].Header();
+
+		planes.resize(first.numPlanes);
+		const QueryPlane* sent = (const QueryPlane*)(pending[queries[0]].message.data() + sizeof(QueryHeader));
+		for (unsigned int p = 0; p < first.numPlanes; p++)
+		{
+			planes[p] = MakeWorldPlane(glm::vec3(sent[p].normal[0], sent[p].normal[1], sent[p].normal[2]),
+				glm::vec3(sent[p].center[0], sent[p].center[1], sent[p].center[2]), sent[p].halfExtent);
+		}
+
+		//Gather the points of every query in the batch
+		size_t total = 0;
+		for (size_t i = 0; i < queries.size(); i++)
+		{
+			queryOffset[queries[i]] = total;
+			total += pending[queries[i]].Header().numPoints;
+		}
+		x.resize(total);
+		y.resize(total);
+		z.resize(total);
+		for (size_t i = 0; i < queries.size(); i++)
+		{
+			const PendingQuery &query = pending[queries[i]];
+			size_t count = query.Header().numPoints;
+			const float* points = (const float*)(query.message.data() + sizeof(QueryHeader) + query.Header().numPlanes * sizeof(QueryPlane));
+			size_t offset = queryOffset[queries[i]];
+			memcpy(x.data() + offset, points, count * sizeof(float));
+			memcpy(y.data() + offset, points + count, count * sizeof(float));
+			memcpy(z.data() + offset, points + 2 * count, count * sizeof(float));
+		}
+
+		//Every plane and range of points is a separate task
+		int numPlanes = (int)planes.size();
+		int rangesPerPlane = std::max((int)((total + grain - 1) / grain), 1);
+		std::vector<signed char> &sides = batchSides[b];
+		std::vector<int> &collisions = batchCollisions[b];
+		sides.resize(total * numPlanes);
+		collisions.assign((size_t)numPlanes * rangesPerPlane, 0);
+
+		ParallelRanges(pool, numPlanes * rangesPerPlane, 1, [&](int begin, int end)
+		{
+			for (int task = begin; task < end; task++)
+			{
+				int p = task / rangesPerPlane;
+				size_t start = (size_t)(task % rangesPerPlane) * grain;
+				int count = (int)std::min((size_t)grain, total - std::min(start, total));
+				if (count <= 0) continue;
+				collisions[task] = ClassifyPoints(planes[p], x.data() + start, y.data() + start, z.data() + start,
+					count, first.acceptanceRange, sides.data() + p * total + start);
+			}
+		});
+
+		numBatches++;
+		numPoints += total;
+	}
+
+	//Answer in the order the queries arrived, so each client gets its answers in order
+	for (size_t q = 0; q < pending.size(); q++)
+	{
+		PendingQuery &query = pending[q];
+		QueryConnection* connection = query.connection;
+		numQueries++;
+		telemetry->queriesAnswered.fetch_add(1, std::memory_order_relaxed);
+		if (connection->closed) continue;
+
+		const QueryHeader &header = query.Header();
+		const std::vector<signed char> &sides = batchSides[queryBatch[q]];
+		size_t total = sides.size() / std::max(header.numPlanes, 1u);
+		size_t offset = queryOffset[q];
+
+		AnswerHeader answer;
+		answer.magic = answerMagic;
+		answer.id = header.id;
+		answer.numPlanes = header.numPlanes;
+		answer.numPoints = header.numPoints;
+		answer.numColliding = 0;
+
+		std::vector<unsigned char> &output = connection->output;
+		size_t start = output.size();
+		output.resize(start + sizeof(AnswerHeader) + (size_t)header.numPlanes * header.numPoints);
+		signed char* answerSides = (signed char*)(output.data() + start + sizeof(AnswerHeader));
+		for (unsigned int p = 0; p < header.numPlanes; p++)
+		{
+			const signed char* planeSides = sides.data() + p * total + offset;
+			memcpy(answerSides + (size_t)p * header.numPoints, planeSides, header.numPoints);
+			for (unsigned int i = 0; i < header.numPoints; i++)
+				answer.numColliding += planeSides[i] == SIDE_ON;
+		}
+		memcpy(output.data() + start, &answer, sizeof(AnswerHeader));
+	}
+
+	for (size_t q = 0; q < pending.size(); q++)
+	{
+		QueryConnection* connection = pending[q].connection;
+		if (!connection->closed && connection->outputSent == 0 && !connection->output.empty())
+			Send(connection);
+	}
+	pending.clear();
+}
+
+bool QueryClient::Connect(const std::string &path)
+{
+	Disconnect();
+
+	sockaddr_un address;
+	memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+
+	socket = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+	if (socket < 0 || connect(socket, (sockaddr*)&address, sizeof(address)) != 0)
+	{
+		std::cout << "Can't connect to socket: " << path.data() << " (" << strerror(errno) << ")" << std::endl;
+		Disconnect();
+		return false;
+	}
+	return true;
+}
+
+void QueryClient::Disconnect()
+{
+	if (socket >= 0) close(socket);
+	socket = -1;
+}
+
+//Sends or receives a whole buffer on a blocking socket
+static bool SendAll(int fd, const void* data, size_t size)
+{
+	const unsigned char* bytes = (const unsigned char*)data;
+	while (size > 0)
+	{
+		ssize_t numSent = send(fd, bytes, size, MSG_NOSIGNAL);
+		if (numSent < 0 && errno == EINTR) continue;
+		if (numSent <= 0) return false;
+		bytes += numSent;
+		size -= numSent;
+	}
+	return true;
+}
+
+static bool ReceiveAll(int fd, void* data, size_t size)
+{
+	unsigned char* bytes = (unsigned char*)data;
+	while (size > 0)
+	{
+		ssize_t numRead = recv(fd, bytes, size, 0);
+		if (numRead < 0 && errno == EINTR) continue;
+		if (numRead <= 0) return false;
+		bytes += numRead;
+		size -= numRead;
+	}
+	return true;
+}
+
+bool QueryClient::SendQuery(unsigned int id, const std::vector<WorldPlane> &planes, const float* x, const float* y, const float* z, int count, float acceptanceRange)
+{
+	QueryHeader header;
+	header.magic = queryMagic;
+	header.id = id;
+	header.numPlanes = (unsigned int)planes.size();
+	header.numPoints = (unsigned int)count;
+	header.acceptanceRange = acceptanceRange;
+
+	std::vector<QueryPlane> sent(planes.size());
+	for (size_t p = 0; p < planes.size(); p++)
+	{
+		memcpy(sent[p].normal, &planes[p].normal[0], sizeof(sent[p].normal));
+		memcpy(sent[p].center, &planes[p].center[0], sizeof(sent[p].center));
+		sent[p].halfExtent = planes[p].halfExtent;
+	}
+
+	return socket >= 0
+		&& SendAll(socket, &header, sizeof(header))
+		&& SendAll(socket, sent.data(), sent.size() * sizeof(QueryPlane))
+		&& SendAll(socket, x, count * sizeof(float))
+		&& SendAll(socket, y, count * sizeof(float))
+		&& SendAll(socket, z, count * sizeof(float));
+}
+
+bool QueryClient::ReceiveAnswer(AnswerHeader &header, std::vector<signed char> &sides)
+{
+	if (socket < 0 || !ReceiveAll(socket, &header, sizeof(header)) || header.magic != answerMagic)
+		return false;
+
+	sides.resize((size_t)header.numPlanes * header.numPoints);
+	return ReceiveAll(socket, sides.data(), sides.size());
+}
+
+#else
+
+bool QueryServer::Start(const std::string &path, ThreadPool* workers)
+{
+	std::cout << "The query server needs epoll and UNIX domain sockets, which this system does not have" << std::endl;
+	return false;
+}
+
+void QueryServer::Stop()
+{
+}
+
+void QueryServer::Run()
+{
+}
+
+bool QueryClient::Connect(const std::string &path)
+{
+	std::cout << "The query client needs UNIX domain sockets, which this system does not have" << std::endl;
+	return false;
+}
+
+void QueryClient::Disconnect()
+{
+}
+
+bool QueryClient::SendQuery(unsigned int id, const std::vector<WorldPlane> &planes, const float* x, const float* y, const float* z, int count, float acceptanceRange)
+{
+	return false;
+}
+
+bool QueryClient::ReceiveAnswer(AnswerHeader &header, std::vector<signed char> &sides)
+{
+	return false;
+}
+
+#endif
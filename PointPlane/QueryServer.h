@@ -0,0 +1,248 @@
+/*
+Title: Point - Plane
+File Name: QueryServer.h
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+Answers point - plane classification queries from other processes on the same
+machine, over a UNIX domain socket.
+
+A query is a small header, the planes as normals, centers and half extents,
+and then the x, y and z arrays of the points. The answer is a header with the
+number of colliding points, followed by the PlaneSide of every point against
+every plane, one byte each, plane by plane. All values are in the machine's
+own byte order, since both ends run on the same machine.
+
+The server watches every connection with epoll and never blocks on one client.
+Each time it wakes it first reads everything which has arrived, then joins the
+queries which use the same planes into one large batch and classifies that on a
+thread pool, so many small queries cost about as much as one large one. Answers
+are written as the sockets accept them, so a slow reader only delays itself.
+Clients may send many queries before reading any answers, which lets the server
+batch the queries of a single client too.
+
+epoll and UNIX domain sockets are Linux only. On other systems Start prints a
+message and fails.
+*/
+
+#ifndef _QUERY_SERVER_H
+#define _QUERY_SERVER_H
+
+#include "Collision.h"
+#include "ThreadPool.h"
+#include <unordered_map>
+#include <atomic>
+
+//First four bytes of every query and answer
+const unsigned int queryMagic = 0x59525150;	//"PQRY"
+const unsigned int answerMagic = 0x534E4150;	//"PANS"
+
+//Largest query the server accepts
+const unsigned int maxQueryPlanes = 4096;
+const unsigned int maxQueryPoints = 1 << 24;
+
+//Most sides in one answer, and in one batch, which keeps an answer to 256MB.
+//Larger queries are refused and their client disconnected.
+const unsigned long long maxQuerySides = 1ull << 28;
+
+#pragma pack(push, 1)
+struct QueryHeader
+{
+	unsigned int magic;
+	unsigned int id;			//Chosen by the client and copied into the answer
+	unsigned int numPlanes;
+	unsigned int numPoints;
+	float acceptanceRange;
+};
+
+//A plane as sent in a query. The server rebuilds it with MakeWorldPlane.
+struct QueryPlane
+{
+	float normal[3];
+	float center[3];
+	float halfExtent;
+};
+
+struct AnswerHeader
+{
+	unsigned int magic;
+	unsigned int id;
+	unsigned int numPlanes;
+	unsigned int numPoints;
+	unsigned long long numColliding;	//Summed over every plane
+};
+#pragma pack(pop)
+
+//A client of the query server, along with the bytes still to be read from it and written to it
+struct QueryConnection
+{
+	int socket;
+	std::vector<unsigned char> input;
+	std::vector<unsigned char> output;
+	size_t outputSent;
+	bool closed;
+
+	//The client has shut down its side. Its queries are still answered, then the connection is closed.
+	bool inputClosed;
+
+	QueryConnection(int fd)
+	{
+		socket = fd;
+		outputSent = 0;
+		closed = false;
+		inputClosed = false;
+	}
+};
+
+//A query which has been read in full and is waiting to be batched
+struct PendingQuery
+{
+	QueryConnection* connection;
+	std::vector<unsigned char> message;
+
+	const QueryHeader &Header() const
+	{
+		return *(const QueryHeader*)message.data();
+	}
+};
+
+struct QueryServer
+{
+	int listenSocket;
+	int epollFd;
+	std::string socketPath;
+
+	//Classifies the batches, or nullptr to classify on the server thread
+	ThreadPool* pool;
+
+	//Points per task when a batch is split between threads
+	int grain;
+
+	std::unordered_map<int, QueryConnection*> connections;
+	std::vector<PendingQuery> pending;
+
+	//Set from any thread to make Run return
+	std::atomic<bool> stopping;
+
+	long long numQueries;
+	long long numBatches;
+	long long numPoints;
+
+	QueryServer();
+
+	///
+	//Closes the socket if the server is still running
+	~QueryServer();
+
+	///
+	//Starts listening on a UNIX domain socket, replacing any old socket file at that path
+	//
+	//Parameters:
+	//	path: The file name of the socket
+	//	workers: Classifies the batches, or nullptr to classify on the server thread
+	//
+	//Returns:
+	//	true if the server is listening, else false
+	bool Start(const std::string &path, ThreadPool* workers);
+
+	///
+	//Answers queries until stopping is set
+	void Run();
+
+	///
+	//Closes every connection and removes the socket file
+	void Stop();
+
+	///
+	//Prints how many queries were answered and how well they were batched
+	void PrintSummary(std::ostream &out) const;
+
+private:
+	void Accept();
+
+	//Reads everything available from a connection and queues each query it completes,
+	//including the queries completed by the last bytes before the client shut down its side
+	void Receive(QueryConnection* connection);
+
+	//Writes as much of a connection's answers as the socket accepts, and closes a
+	//connection whose client has shut down its side once every answer is written
+	void Send(QueryConnection* connection);
+
+	//Classifies every pending query, joining the ones with the same planes into one batch
+	void AnswerPending();
+
+	void Close(QueryConnection* connection);
+};
+
+//Talks to a query server. Queries may be sent ahead of reading their answers.
+struct QueryClient
+{
+	int socket;
+
+	QueryClient()
+	{
+		socket = -1;
+	}
+
+	~QueryClient()
+	{
+		Disconnect();
+	}
+
+	///
+	//Connects to a query server
+	//
+	//Parameters:
+	//	path: The file name of the server's socket
+	//
+	//Returns:
+	//	true if connected, else false
+	bool Connect(const std::string &path);
+
+	void Disconnect();
+
+	///
+	//Sends a query without waiting for its answer
+	//
+	//Parameters:
+	//	id: Returned with the answer
+	//	planes: The planes to classify against. Only the normal, center and halfExtent are sent.
+	//	x, y, z: The point coordinates
+	//	count: The number of points
+	//	acceptanceRange: Points this close to a plane are considered colliding
+	//
+	//Returns:
+	//	true if the query was sent, else false
+	bool SendQuery(unsigned int id, const std::vector<WorldPlane> &planes, const float* x, const float* y, const float* z, int count, float acceptanceRange);
+
+	///
+	//Waits for the next answer. Answers come back in the order their queries were sent.
+	//
+	//Parameters:
+	//	header: Filled with the answer's header
+	//	sides: Filled with the PlaneSide of every point against every plane, plane by plane
+	//
+	//Returns:
+	//	true if an answer was read, else false
+	bool ReceiveAnswer(AnswerHeader &header, std::vector<signed char> &sides);
+};
+
+#endif //_QUERY_SERVER_H
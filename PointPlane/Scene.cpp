@@ -0,0 +1,385 @@
+/*
+Title: Point - Plane
+File Name: Scene.cpp
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+Generation, motion and storage of large synthetic scenes. A scene file is a
+small header followed by each point array, the plane array and, for scenes
+with collision layers, the filter of every point, each written with a single write.
+*/
+
+#include "Scene.h"
+#include "Telemetry.h"
+#include <random>
+#include <fstream>
+#include <cstring>
+#include <cstddef>
+
+//Identifies a scene file ("PPSC")
+static const unsigned int sceneMagic = 0x43535050;
+static const unsigned int sceneVersion = 2;
+
+struct SceneHeader
+{
+	unsigned int magic;
+	unsigned int version;
+	unsigned int numPoints;
+	unsigned int numPlanes;
+	int motion;
+	float extent;
+	float orbitSpeed;
+	unsigned int numFilters;	//0, or one filter for every point, from version 2
+};
+
+//A plane as version 1 files store it, before planes had collision filters
+struct ScenePlaneV1
+{
+	float normal[3];
+	float distance;
+	float center[3];
+	float tangent[3];
+	float bitangent[3];
+	float halfExtent;
+};
+
+//Returns a random unit vector
+static glm::vec3 RandomDirection(std::mt19937 &rng)
+{
+	std::normal_distribution<float> normal(0.0f, 1.0f);
+	glm::vec3 v;
+	do
+	{
+		v = glm::vec3(normal(rng), normal(rng), normal(rng));
+	} while (glm::dot(v, v) < 1e-6f);
+	return glm::normalize(v);
+}
+
+void GenerateScene(const ScenarioSettings &settings, Scene &scene)
+{
+	std::mt19937 rng(settings.seed);
+	std::uniform_real_distribution<float> inVolume(-settings.extent, settings.extent);
+	std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+
+	scene.motion = settings.motion;
+	scene.extent = settings.extent;
+	scene.orbitSpeed = settings.orbitSpeed;
+
+	//Place the planes within the inner half of the volume so they cut through the points
+	scene.planes.resize(settings.numPlanes);
+	for (int i = 0; i < settings.numPlanes; i++)
+	{
+		glm::vec3 center(inVolume(rng) * 0.5f, inVolume(rng) * 0.5f, inVolume(rng) * 0.5f);
+		scene.planes[i] = MakeWorldPlane(RandomDirection(rng), center, settings.finitePlanes ? settings.planeHalfExtent : 0.0f);
+	}
+
+	//Cluster centers for the clustered distribution
+	std::vector<glm::vec3> clusters(std::max(settings.numClusters, 1));
+	for (size_t i = 0; i < clusters.size(); i++)
+		clusters[i] = glm::vec3(inVolume(rng), inVolume(rng), inVolume(rng));
+	std::normal_distribution<float> aroundCluster(0.0f, settings.clusterRadius);
+
+	PointSet &points = scene.points;
+	points.Resize(settings.numPoints);
+	for (int i = 0; i < settings.numPoints; i++)
+	{
+		glm::vec3 p;
+		switch (settings.distribution)
+		{
+		case DISTRIBUTION_CLUSTERED:
+			p = clusters[rng() % clusters.size()] + glm::vec3(aroundCluster(rng), aroundCluster(rng), aroundCluster(rng));
+			break;
+
+		case DISTRIBUTION_NEAR_PLANE:
+			if (!scene.planes.empty())
+			{
+				//Somewhere on a plane, then pushed off it by no more than the band
+				const WorldPlane &plane = scene.planes[rng() % scene.planes.size()];
+				float spread = plane.halfExtent > 0.0f ? plane.halfExtent : settings.extent;
+				p = plane.center
+					+ plane.tangent * (unit(rng) * spread)
+					+ plane.bitangent * (unit(rng) * spread)
+					+ plane.normal * (unit(rng) * settings.nearPlaneBand);
+				break;
+			}
+			//Without planes fall back to a uniform spread
+			p = glm::vec3(inVolume(rng), inVolume(rng), inVolume(rng));
+			break;
+
+		default:
+			p = glm::vec3(inVolume(rng), inVolume(rng), inVolume(rng));
+			break;
+		}
+
+		glm::vec3 v = settings.motion == MOTION_DRIFT ? RandomDirection(rng) * (settings.maxSpeed * (unit(rng) * 0.5f + 0.5f)) : glm::vec3(0.0f);
+
+		points.x[i] = p.x; points.y[i] = p.y; points.z[i] = p.z;
+		points.vx[i] = v.x; points.vy[i] = v.y; points.vz[i] = v.z;
+	}
+
+	int numLayers = std::min(settings.numLayers, 32);
+	if (numLayers > 0)
+	{
+		points.filters.resize(settings.numPoints);
+		for (int i = 0; i < settings.numPoints; i++)
+			points.filters[i] = CollisionFilter(1u << (int)((long long)i * numLayers / settings.numPoints), LAYERS_ALL);
+
+		for (int i = 0; i < settings.numPlanes; i++)
+		{
+			unsigned int layer = 1u << (i % numLayers);
+			scene.planes[i].filter = CollisionFilter(layer, layer | 1u << ((i + 1) % numLayers));
+		}
+	}
+}
+
+//Wraps a coordinate back into [-extent, extent]
+static float Wrap(float value, float extent)
+{
+	if (value > extent) return value - 2.0f * extent;
+	if (value < -extent) return value + 2.0f * extent;
+	return value;
+}
+
+void StepScene(Scene &scene, float dt)
+{
+	PointSet &points = scene.points;
+	int count = (int)points.Size();
+
+	if (scene.motion == MOTION_DRIFT)
+	{
+		float extent = scene.extent;
+		for (int i = 0; i < count; i++)
+		{
+			points.x[i] = Wrap(points.x[i] + points.vx[i] * dt, extent);
+			points.y[i] = Wrap(points.y[i] + points.vy[i] * dt, extent);
+			points.z[i] = Wrap(points.z[i] + points.vz[i] * dt, extent);
+		}
+	}
+	else if (scene.motion == MOTION_ORBIT)
+	{
+		float c = cosf(scene.orbitSpeed * dt);
+		float s = sinf(scene.orbitSpeed * dt);
+		for (int i = 0; i < count; i++)
+		{
+			float x = points.x[i];
+			float z = points.z[i];
+			points.x[i] = c * x + s * z;
+			points.z[i] = c * z - s * x;
+		}
+	}
+}
+
+long long ClassifyScene(const Scene &scene, float acceptanceRange, SideBuffer &sides, long long* numSkipped)
+{
+	int numPoints = (int)scene.points.Size();
+	sides.resize((size_t)numPoints * scene.planes.size());
+
+	long long numColliding = 0;
+	long long skipped = 0;
+	for (size_t i = 0; i < scene.planes.size(); i++)
+		numColliding += ClassifyFiltered(scene.planes[i], scene.points, 0, numPoints, acceptanceRange, sides.data() + i * numPoints, skipped);
+
+	if (numSkipped) *numSkipped += skipped;
+	return numColliding;
+}
+
+int ClassifyFiltered(const WorldPlane &plane, const PointSet &points, int begin, int end, float acceptanceRange, signed char* sides, long long &numSkipped)
+{
+	int numColliding = 0;
+	long long skipped = 0;
+
+	//Every point has the default filter, so the plane takes all of them or none
+	if (points.filters.empty())
+	{
+		if (plane.filter.Interacts(CollisionFilter()))
+			return ClassifyPoints(plane, points.x.data() + begin, points.y.data() + begin, points.z.data() + begin, end - begin, acceptanceRange, sides);
+
+		if (sides) memset(sides, SIDE_IGNORED, end - begin);
+		skipped = end - begin;
+	}
+	else
+	{
+		int runStart = begin;
+		while (runStart < end)
+		{
+			//Find the run of points which are all accepted, or all skipped
+			bool accepted = plane.filter.Interacts(points.filters[runStart]);
+			int runEnd = runStart + 1;
+			while (runEnd < end && plane.filter.Interacts(points.filters[runEnd]) == accepted)
+				runEnd++;
+
+			signed char* runSides = sides ? sides + (runStart - begin) : nullptr;
+			if (accepted)
+				numColliding += ClassifyPoints(plane, points.x.data() + runStart, points.y.data() + runStart, points.z.data() + runStart, runEnd - runStart, acceptanceRange, runSides);
+			else
+			{
+				if (runSides) memset(runSides, SIDE_IGNORED, runEnd - runStart);
+				skipped += runEnd - runStart;
+			}
+			runStart = runEnd;
+		}
+	}
+
+	numSkipped += skipped;
+	telemetry->pairsSkipped.fetch_add(skipped, std::memory_order_relaxed);
+	return numColliding;
+}
+
+bool SaveScene(const Scene &scene, const std::string &fileName)
+{
+	std::ofstream file(fileName, std::ios::out | std::ios::binary);
+	if (!file.good())
+	{
+		std::cout << "Can't write file: " << fileName.data() << std::endl;
+		return false;
+	}
+
+	SceneHeader header;
+	header.magic = sceneMagic;
+	header.version = sceneVersion;
+	header.numPoints = (unsigned int)scene.points.Size();
+	header.numPlanes = (unsigned int)scene.planes.size();
+	header.motion = scene.motion;
+	header.extent = scene.extent;
+	header.orbitSpeed = scene.orbitSpeed;
+	header.numFilters = (unsigned int)scene.points.filters.size();
+
+	std::streamsize arrayBytes = header.numPoints * sizeof(float);
+	file.write((const char*)&header, sizeof(header));
+	file.write((const char*)scene.points.x.data(), arrayBytes);
+	file.write((const char*)scene.points.y.data(), arrayBytes);
+	file.write((const char*)scene.points.z.data(), arrayBytes);
+	file.write((const char*)scene.points.vx.data(), arrayBytes);
+	file.write((const char*)scene.points.vy.data(), arrayBytes);
+	file.write((const char*)scene.points.vz.data(), arrayBytes);
+	file.write((const char*)scene.planes.data(), header.numPlanes * sizeof(WorldPlane));
+	file.write((const char*)scene.points.filters.data(), header.numFilters * sizeof(CollisionFilter));
+
+	bool written = file.good();
+	file.close();
+	if (!written) std::cout << "Failed writing scene: " << fileName.data() << std::endl;
+	return written;
+}
+
+bool LoadScene(Scene &scene, const std::string &fileName)
+{
+	std::ifstream file(fileName, std::ios::in | std::ios::binary);
+	if (!file.good())
+	{
+		std::cout << "Can't read file: " << fileName.data() << std::endl;
+		return false;
+	}
+
+	//Version 1 headers end before numFilters, and their scenes have no filters
+	SceneHeader header;
+	file.read((char*)&header, offsetof(SceneHeader, numFilters));
+	if (!file.good() || header.magic != sceneMagic || (header.version != 1 && header.version != sceneVersion))
+	{
+		std::cout << "Not a scene file: " << fileName.data() << std::endl;
+		return false;
+	}
+	header.numFilters = 0;
+	if (header.version != 1)
+		file.read((char*)&header.numFilters, sizeof(header.numFilters));
+
+	scene.motion = (MotionPattern)header.motion;
+	scene.extent = header.extent;
+	scene.orbitSpeed = header.orbitSpeed;
+	if ((header.numFilters != 0 && header.numFilters != header.numPoints)
+		|| header.motion < MOTION_STATIC || header.motion > MOTION_ORBIT)
+	{
+		std::cout << "Not a scene file: " << fileName.data() << std::endl;
+		return false;
+	}
+
+	//The counts come from the file, so check the arrays are really there before making room for them
+	std::streamoff start = file.tellg();
+	file.seekg(0, std::ios::end);
+	std::streamoff remaining = file.tellg() - start;
+	file.seekg(start, std::ios::beg);
+	unsigned long long planeBytes = header.version == 1 ? sizeof(ScenePlaneV1) : sizeof(WorldPlane);
+	unsigned long long expectedBytes = (unsigned long long)header.numPoints * 6 * sizeof(float)
+		+ header.numPlanes * planeBytes + (unsigned long long)header.numFilters * sizeof(CollisionFilter);
+	if (remaining < 0 || (unsigned long long)remaining < expectedBytes)
+	{
+		std::cout << "Scene is truncated: " << fileName.data() << std::endl;
+		return false;
+	}
+
+	scene.points.filters.resize(header.numFilters);
+	scene.points.Resize(header.numPoints);
+
+	//Version 1 planes are read field by field, so planes left from an earlier scene mustn't keep their filters
+	scene.planes.assign(header.numPlanes, WorldPlane());
+
+	std::streamsize arrayBytes = header.numPoints * sizeof(float);
+	file.read((char*)scene.points.x.data(), arrayBytes);
+	file.read((char*)scene.points.y.data(), arrayBytes);
+	file.read((char*)scene.points.z.data(), arrayBytes);
+	file.read((char*)scene.points.vx.data(), arrayBytes);
+	file.read((char*)scene.points.vy.data(), arrayBytes);
+	file.read((char*)scene.points.vz.data(), arrayBytes);
+	if (header.version == 1)
+	{
+		std::vector<ScenePlaneV1> oldPlanes(header.numPlanes);
+		file.read((char*)oldPlanes.data(), header.numPlanes * sizeof(ScenePlaneV1));
+		for (unsigned int i = 0; i < header.numPlanes; i++)
+		{
+			const ScenePlaneV1 &old = oldPlanes[i];
+			WorldPlane &plane = scene.planes[i];
+			plane.normal = glm::vec3(old.normal[0], old.normal[1], old.normal[2]);
+			plane.distance = old.distance;
+			plane.center = glm::vec3(old.center[0], old.center[1], old.center[2]);
+			plane.tangent = glm::vec3(old.tangent[0], old.tangent[1], old.tangent[2]);
+			plane.bitangent = glm::vec3(old.bitangent[0], old.bitangent[1], old.bitangent[2]);
+			plane.halfExtent = old.halfExtent;
+		}
+	}
+	else
+		file.read((char*)scene.planes.data(), header.numPlanes * sizeof(WorldPlane));
+	file.read((char*)scene.points.filters.data(), header.numFilters * sizeof(CollisionFilter));
+
+	if (!file.good())
+	{
+		std::cout << "Scene is truncated: " << fileName.data() << std::endl;
+		return false;
+	}
+	file.close();
+	return true;
+}
+
+bool ParseDistribution(const std::string &name, PointDistribution &distribution)
+{
+	if (name == "uniform") distribution = DISTRIBUTION_UNIFORM;
+	else if (name == "clustered") distribution = DISTRIBUTION_CLUSTERED;
+	else if (name == "nearplane") distribution = DISTRIBUTION_NEAR_PLANE;
+	else return false;
+	return true;
+}
+
+bool ParseMotion(const std::string &name, MotionPattern &motion)
+{
+	if (name == "static") motion = MOTION_STATIC;
+	else if (name == "drift") motion = MOTION_DRIFT;
+	else if (name == "orbit") motion = MOTION_ORBIT;
+	else return false;
+	return true;
+}
@@ -0,0 +1,231 @@
+/*
+Title: Point - Plane
+File Name: Scene.h
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+Large synthetic scenes made of many points and many planes, used to measure
+how the collision tests scale. Scenes are generated from a set of settings
+(how many points and planes, how the points are spread out and how they move)
+and can be kept in memory or saved to a binary scene file and loaded back.
+*/
+
+#ifndef _SCENE_H
+#define _SCENE_H
+
+#include "Collision.h"
+#include "LargePages.h"
+
+//A set of points stored as separate coordinate arrays
+struct PointSet
+{
+	FloatBuffer x, y, z;
+
+	//Velocity of each point, used by the drift motion pattern
+	FloatBuffer vx, vy, vz;
+
+	//The collision layers of each point, or empty when every point has the default filter
+	std::vector<CollisionFilter> filters;
+
+	size_t Size() const
+	{
+		return x.size();
+	}
+
+	void Resize(size_t count)
+	{
+		x.resize(count); y.resize(count); z.resize(count);
+		vx.resize(count); vy.resize(count); vz.resize(count);
+		if (!filters.empty()) filters.resize(count);
+	}
+
+	CollisionFilter FilterOf(size_t i) const
+	{
+		return filters.empty() ? CollisionFilter() : filters[i];
+	}
+};
+
+//How the points of a generated scene are spread out
+enum PointDistribution
+{
+	DISTRIBUTION_UNIFORM,		//Evenly through the scene volume
+	DISTRIBUTION_CLUSTERED,		//In a few tight clusters
+	DISTRIBUTION_NEAR_PLANE		//Right around the planes, to stress the acceptance range
+};
+
+//How the points of a scene move each step
+enum MotionPattern
+{
+	MOTION_STATIC,		//Points do not move
+	MOTION_DRIFT,		//Points move with a constant velocity and wrap around the scene volume
+	MOTION_ORBIT		//Points circle the Y axis
+};
+
+//Everything needed to generate a scene
+struct ScenarioSettings
+{
+	int numPoints;
+	int numPlanes;
+	PointDistribution distribution;
+	MotionPattern motion;
+
+	//Whether planes are bounded like the demo's plane mesh, or extend infinitely
+	bool finitePlanes;
+	float planeHalfExtent;
+
+	//Points are placed within [-extent, extent] on each axis
+	float extent;
+
+	//Settings for the clustered distribution
+	int numClusters;
+	float clusterRadius;
+
+	//Near plane points are placed at most this far from a plane
+	float nearPlaneBand;
+
+	//Fastest a drifting point moves, in units per second
+	float maxSpeed;
+
+	//Angular speed of orbiting points, in radians per second
+	float orbitSpeed;
+
+	unsigned int seed;
+
+	//Points are split into this many collision layers, in runs of consecutive points,
+	//and plane i collides with layers i and i + 1. 0 leaves every body on the default layer.
+	int numLayers;
+
+	ScenarioSettings()
+	{
+		numPoints = 1000;
+		numPlanes = 1;
+		distribution = DISTRIBUTION_UNIFORM;
+		motion = MOTION_STATIC;
+		finitePlanes = false;
+		planeHalfExtent = 1.0f;
+		extent = 1.0f;
+		numClusters = 8;
+		clusterRadius = 0.05f;
+		nearPlaneBand = 4.0f * pointAcceptanceRange;
+		maxSpeed = 0.1f;
+		orbitSpeed = 0.5f;
+		seed = 1;
+		numLayers = 0;
+	}
+};
+
+//Points and planes making up a generated scene
+struct Scene
+{
+	PointSet points;
+	std::vector<WorldPlane> planes;
+
+	MotionPattern motion;
+	float extent;
+	float orbitSpeed;
+
+	Scene()
+	{
+		motion = MOTION_STATIC;
+		extent = 1.0f;
+		orbitSpeed = 0.0f;
+	}
+};
+
+///
+//Generates a scene from a set of settings
+//
+//Parameters:
+//	settings: Describes the scene to generate
+//	scene: The scene to fill
+void GenerateScene(const ScenarioSettings &settings, Scene &scene);
+
+///
+//Moves the points of a scene forward in time according to its motion pattern
+//
+//Parameters:
+//	scene: The scene to advance
+//	dt: The timestep in seconds
+void StepScene(Scene &scene, float dt);
+
+///
+//Classifies every point of a scene against every plane
+//
+//Parameters:
+//	scene: The scene to test
+//	acceptanceRange: Points this close to a plane are considered colliding
+//	sides: Filled with the PlaneSide of every point against every plane, one plane after another
+//	numSkipped: If not nullptr, the pairs skipped by their collision layers are added to it
+//
+//Returns:
+//	The number of colliding point - plane pairs
+long long ClassifyScene(const Scene &scene, float acceptanceRange, SideBuffer &sides, long long* numSkipped);
+
+///
+//Classifies a run of points against a plane, skipping the points whose collision layers
+//don't interact with the plane's
+//
+//Overview:
+//	The layers are checked before the batch kernel, and the points between two changes of
+//	layer are passed to it as one batch, so points kept in runs by layer lose nothing to
+//	the check. Without per point filters the whole run is accepted or skipped at once.
+//
+//Parameters:
+//	plane: The plane to test
+//	points: The points to test
+//	begin, end: The run of points to test
+//	acceptanceRange: Points this close to the plane are considered colliding
+//	sides: If not nullptr, filled with the PlaneSide of the points from begin on, SIDE_IGNORED for skipped points
+//	numSkipped: The number of points skipped is added to it
+//
+//Returns:
+//	The number of colliding points
+int ClassifyFiltered(const WorldPlane &plane, const PointSet &points, int begin, int end, float acceptanceRange, signed char* sides, long long &numSkipped);
+
+///
+//Writes a scene to a binary scene file. Every array is written with a single write.
+//
+//Returns:
+//	true if the scene was written, else false
+bool SaveScene(const Scene &scene, const std::string &fileName);
+
+///
+//Reads a binary scene file written by SaveScene
+//
+//Returns:
+//	true if the scene was read, else false
+bool LoadScene(Scene &scene, const std::string &fileName);
+
+///
+//Converts a distribution name ("uniform", "clustered" or "nearplane") to a PointDistribution
+//
+//Returns:
+//	true if the name was recognized, else false
+bool ParseDistribution(const std::string &name, PointDistribution &distribution);
+
+///
+//Converts a motion name ("static", "drift" or "orbit") to a MotionPattern
+//
+//Returns:
+//	true if the name was recognized, else false
+bool ParseMotion(const std::string &name, MotionPattern &motion);
+
+#endif //_SCENE_H
@@ -0,0 +1,186 @@
+/*
+Title: Point - Plane
+File Name: Shapes.cpp
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+Batches of spheres, boxes and capsules to test against planes.
+*/
+
+#include "Shapes.h"
+#include <random>
+
+void ShapeSet::Resize(size_t count)
+{
+	x.resize(count);
+	y.resize(count);
+	z.resize(count);
+
+	if (type == SHAPE_SPHERE || type == SHAPE_CAPSULE)
+		radius.resize(count);
+
+	if (type != SHAPE_SPHERE)
+	{
+		hx.resize(count);
+		hy.resize(count);
+		hz.resize(count);
+	}
+
+	if (type == SHAPE_ORIENTED_BOX)
+	{
+		ux.resize(count); uy.resize(count); uz.resize(count);
+		vx.resize(count); vy.resize(count); vz.resize(count);
+		wx.resize(count); wy.resize(count); wz.resize(count);
+	}
+}
+
+void ShapeSet::SupportExtents(glm::vec3 direction, float* extents) const
+{
+	int count = (int)Size();
+	float dx = direction.x, dy = direction.y, dz = direction.z;
+	float length = glm::length(direction);
+
+	switch (type)
+	{
+	case SHAPE_SPHERE:
+		for (int i = 0; i < count; i++)
+			extents[i] = radius[i] * length;
+		break;
+
+	case SHAPE_BOX:
+	{
+		float ax = fabs(dx), ay = fabs(dy), az = fabs(dz);
+		for (int i = 0; i < count; i++)
+			extents[i] = ax * hx[i] + ay * hy[i] + az * hz[i];
+		break;
+	}
+
+	case SHAPE_ORIENTED_BOX:
+		for (int i = 0; i < count; i++)
+		{
+			extents[i] = hx[i] * fabs(dx * ux[i] + dy * uy[i] + dz * uz[i])
+				+ hy[i] * fabs(dx * vx[i] + dy * vy[i] + dz * vz[i])
+				+ hz[i] * fabs(dx * wx[i] + dy * wy[i] + dz * wz[i]);
+		}
+		break;
+
+	case SHAPE_CAPSULE:
+		for (int i = 0; i < count; i++)
+			extents[i] = fabs(dx * hx[i] + dy * hy[i] + dz * hz[i]) + radius[i] * length;
+		break;
+	}
+}
+
+int ClassifyShapes(const WorldPlane &plane, const ShapeSet &shapes, float acceptanceRange, std::vector<float> &extents, signed char* sides)
+{
+	int count = (int)shapes.Size();
+	bool finite = plane.halfExtent > 0.0f;
+
+	//Finite planes also need the extents along the tangent and bitangent
+	extents.resize((size_t)count * (finite ? 3 : 1));
+	float* normalExtents = extents.data();
+	float* tangentExtents = finite ? normalExtents + count : nullptr;
+	float* bitangentExtents = finite ? tangentExtents + count : nullptr;
+
+	shapes.SupportExtents(plane.normal, normalExtents);
+	if (finite)
+	{
+		shapes.SupportExtents(plane.tangent, tangentExtents);
+		shapes.SupportExtents(plane.bitangent, bitangentExtents);
+	}
+
+	return ClassifyExtents(plane, shapes.x.data(), shapes.y.data(), shapes.z.data(),
+		normalExtents, tangentExtents, bitangentExtents, count, acceptanceRange, sides);
+}
+
+//Returns a random unit vector
+static glm::vec3 RandomAxis(std::mt19937 &rng)
+{
+	std::normal_distribution<float> normal(0.0f, 1.0f);
+	glm::vec3 axis(normal(rng), normal(rng), normal(rng));
+	float length = glm::length(axis);
+	return length > 0.0f ? axis / length : glm::vec3(1.0f, 0.0f, 0.0f);
+}
+
+void GenerateShapes(ShapeType type, const PointSet &centers, float maxSize, unsigned int seed, ShapeSet &shapes)
+{
+	std::mt19937 rng(seed);
+	std::uniform_real_distribution<float> size(0.1f * maxSize, maxSize);
+
+	int count = (int)centers.Size();
+	shapes.type = type;
+	shapes.Resize(count);
+
+	for (int i = 0; i < count; i++)
+	{
+		shapes.x[i] = centers.x[i];
+		shapes.y[i] = centers.y[i];
+		shapes.z[i] = centers.z[i];
+
+		if (type == SHAPE_SPHERE)
+			shapes.radius[i] = size(rng);
+		else if (type == SHAPE_CAPSULE)
+		{
+			shapes.radius[i] = 0.5f * size(rng);
+			glm::vec3 half = RandomAxis(rng) * size(rng);
+			shapes.hx[i] = half.x; shapes.hy[i] = half.y; shapes.hz[i] = half.z;
+		}
+		else
+		{
+			shapes.hx[i] = size(rng); shapes.hy[i] = size(rng); shapes.hz[i] = size(rng);
+
+			if (type == SHAPE_ORIENTED_BOX)
+			{
+				//Build an orthonormal frame around a random axis
+				glm::vec3 u = RandomAxis(rng);
+				glm::vec3 other = fabs(u.x) < 0.9f ? glm::vec3(1.0f, 0.0f, 0.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+				glm::vec3 v = glm::normalize(glm::cross(u, other));
+				glm::vec3 w = glm::cross(u, v);
+
+				shapes.ux[i] = u.x; shapes.uy[i] = u.y; shapes.uz[i] = u.z;
+				shapes.vx[i] = v.x; shapes.vy[i] = v.y; shapes.vz[i] = v.z;
+				shapes.wx[i] = w.x; shapes.wy[i] = w.y; shapes.wz[i] = w.z;
+			}
+		}
+	}
+}
+
+bool ParseShapeType(const std::string &name, ShapeType &type)
+{
+	if (name == "sphere") type = SHAPE_SPHERE;
+	else if (name == "box") type = SHAPE_BOX;
+	else if (name == "obb") type = SHAPE_ORIENTED_BOX;
+	else if (name == "capsule") type = SHAPE_CAPSULE;
+	else return false;
+	return true;
+}
+
+const char* ShapeTypeName(ShapeType type)
+{
+	switch (type)
+	{
+	case SHAPE_SPHERE: return "sphere";
+	case SHAPE_BOX: return "box";
+	case SHAPE_ORIENTED_BOX: return "obb";
+	case SHAPE_CAPSULE: return "capsule";
+	}
+	return "unknown";
+}
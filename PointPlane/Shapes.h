@@ -0,0 +1,131 @@
+/*
+Title: Point - Plane
+File Name: Shapes.h
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+Batches of spheres, boxes and capsules to test against planes.
+
+Each batch holds one kind of shape with every property in its own array,
+like PointSet. Testing a batch is done in two passes. The first finds how
+far every shape reaches along the plane normal (its support extent):
+	sphere			radius * |n|
+	box				|n.x| * hx + |n.y| * hy + |n.z| * hz
+	oriented box	hx * |dot(n, u)| + hy * |dot(n, v)| + hz * |dot(n, w)|
+	capsule			|dot(n, h)| + radius * |n|, h being half the capsule's segment
+The second pass is ClassifyExtents, which is shared by every kind of shape.
+Against finite planes the second pass is conservative near the plane's edges
+and corners, and may accept shapes which pass just outside them.
+*/
+
+#ifndef _SHAPES_H
+#define _SHAPES_H
+
+#include "Scene.h"
+
+enum ShapeType
+{
+	SHAPE_SPHERE,
+	SHAPE_BOX,				//Axis aligned box
+	SHAPE_ORIENTED_BOX,
+	SHAPE_CAPSULE
+};
+
+//A batch of shapes of one type
+struct ShapeSet
+{
+	ShapeType type;
+
+	//Centers
+	std::vector<float> x, y, z;
+
+	//Spheres and capsules
+	std::vector<float> radius;
+
+	//Half sizes of boxes along their axes, or for capsules the vector
+	//from the center to one end of the capsule's segment
+	std::vector<float> hx, hy, hz;
+
+	//Axes of oriented boxes
+	std::vector<float> ux, uy, uz;
+	std::vector<float> vx, vy, vz;
+	std::vector<float> wx, wy, wz;
+
+	ShapeSet()
+	{
+		type = SHAPE_SPHERE;
+	}
+
+	size_t Size() const
+	{
+		return x.size();
+	}
+
+	///
+	//Resizes the arrays the shape type uses
+	void Resize(size_t count);
+
+	///
+	//Finds how far every shape reaches from its center along a direction
+	//
+	//Parameters:
+	//	direction: The direction to measure along, usually a plane normal
+	//	extents: Filled with the extent of every shape
+	void SupportExtents(glm::vec3 direction, float* extents) const;
+};
+
+///
+//Classifies a batch of shapes against a plane
+//
+//Parameters:
+//	plane: The world space plane
+//	shapes: The shapes to test
+//	acceptanceRange: Shapes this close to the plane are considered colliding
+//	extents: Scratch space for the support extents, resized as needed
+//	sides: Filled with the PlaneSide of each shape, may be nullptr
+//
+//Returns:
+//	The number of shapes colliding with the plane
+int ClassifyShapes(const WorldPlane &plane, const ShapeSet &shapes, float acceptanceRange, std::vector<float> &extents, signed char* sides);
+
+///
+//Places a shape of random size and orientation at every point of a point set
+//
+//Parameters:
+//	type: The type of shape to make
+//	centers: Where to put the shapes
+//	maxSize: Largest radius or half size of a shape
+//	seed: Seed for the sizes and orientations
+//	shapes: Filled with the shapes
+void GenerateShapes(ShapeType type, const PointSet &centers, float maxSize, unsigned int seed, ShapeSet &shapes);
+
+///
+//Converts a shape name ("sphere", "box", "obb" or "capsule") to a ShapeType
+//
+//Returns:
+//	true if the name was recognized, else false
+bool ParseShapeType(const std::string &name, ShapeType &type);
+
+///
+//Returns the name ParseShapeType accepts for a shape type
+const char* ShapeTypeName(ShapeType type);
+
+#endif //_SHAPES_H
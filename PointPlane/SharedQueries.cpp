@@ -0,0 +1,534 @@
+/*
+Title: Point - Plane
+File Name: SharedQueries.cpp
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+Answers point - plane classification queries from other processes through shared memory.
+*/
+
+#include "SharedQueries.h"
+#include "Telemetry.h"
+#include <cstring>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <cerrno>
+#endif
+
+//Arena allocations are aligned to a cache line
+static const unsigned long long arenaAlignment = 64;
+
+static unsigned long long AlignUp(unsigned long long value, unsigned long long alignment)
+{
+	return (value + alignment - 1) / alignment * alignment;
+}
+
+//Offset of the first channel, and the size of each, from the start of the region
+static size_t FirstChannelOffset()
+{
+	return (size_t)AlignUp(sizeof(SharedRegionHeader), arenaAlignment);
+}
+
+static size_t ChannelStride()
+{
+	return (size_t)AlignUp(sizeof(SharedChannel), arenaAlignment);
+}
+
+SharedQueryServer::SharedQueryServer()
+{
+	region = nullptr;
+	regionBytes = 0;
+	numChannels = 0;
+	arenasOffset = 0;
+	arenaBytes = 0;
+	pool = nullptr;
+	grain = 16384;
+	stopping = false;
+	numQueries = 0;
+	numRounds = 0;
+	numPoints = 0;
+}
+
+SharedQueryServer::~SharedQueryServer()
+{
+	Stop();
+}
+
+SharedChannel* SharedQueryServer::Channel(int channel) const
+{
+	return (SharedChannel*)(region + FirstChannelOffset() + channel * ChannelStride());
+}
+
+void SharedQueryServer::PrintSummary(std::ostream &out) const
+{
+	out << "Answered " << numQueries << " queries of " << numPoints << " points in " << numRounds << " rounds" << std::endl;
+}
+
+SharedQueryClient::SharedQueryClient()
+{
+	region = nullptr;
+	regionBytes = 0;
+	channel = nullptr;
+	arenaUsed = 0;
+}
+
+SharedQueryClient::~SharedQueryClient()
+{
+	Detach();
+}
+
+SharedQuery* SharedQueryClient::BeginQuery(unsigned int id, int numPlanes, int numPoints, float acceptanceRange)
+{
+	if (channel == nullptr || freeSlots.empty()) return nullptr;
+
+	unsigned long long planesBytes = AlignUp((unsigned long long)numPlanes * sizeof(QueryPlane), arenaAlignment);
+	unsigned long long pointsBytes = AlignUp((unsigned long long)numPoints * 3 * sizeof(float), arenaAlignment);
+	unsigned long long sidesBytes = AlignUp((unsigned long long)numPlanes * numPoints, arenaAlignment);
+	if (arenaUsed + planesBytes + pointsBytes + sidesBytes > channel->arenaBytes) return nullptr;
+
+	SharedQuery* query = &channel->slots[freeSlots.back()];
+	freeSlots.pop_back();
+
+	query->id = id;
+	query->numPlanes = (unsigned int)numPlanes;
+	query->numPoints = (unsigned int)numPoints;
+	query->acceptanceRange = acceptanceRange;
+	query->planesOffset = channel->arenaOffset + arenaUsed;
+	query->pointsOffset = query->planesOffset + planesBytes;
+	query->sidesOffset = query->pointsOffset + pointsBytes;
+	query->numColliding = 0;
+
+	arenaUsed += planesBytes + pointsBytes + sidesBytes;
+	return query;
+}
+
+void SharedQueryClient::Finish(SharedQuery* query)
+{
+	freeSlots.push_back((unsigned int)(query - channel->slots));
+
+	//The arena is handed out front to back, and starts again once it is all free
+	if (NumInFlight() == 0)
+		arenaUsed = 0;
+}
+
+#ifdef __linux__
+
+static void FutexWait(std::atomic<unsigned int>* address, unsigned int expected, int timeoutMilliseconds)
+{
+	timespec timeout;
+	timeout.tv_sec = timeoutMilliseconds / 1000;
+	timeout.tv_nsec = (timeoutMilliseconds % 1000) * 1000000L;
+
+	//Not FUTEX_PRIVATE_FLAG, the waker is in another process
+	syscall(SYS_futex, (unsigned int*)address, FUTEX_WAIT, expected, &timeout, nullptr, 0);
+}
+
+static void FutexWake(std::atomic<unsigned int>* address)
+{
+	syscall(SYS_futex, (unsigned int*)address, FUTEX_WAKE, 1, nullptr, nullptr, 0);
+}
+
+//Bumps a sequence and wakes whoever sleeps on it, only calling the kernel if they said they are asleep
+static void Signal(std::atomic<unsigned int>* sequence, std::atomic<unsigned int>* sleeping)
+{
+	sequence->fetch_add(1);
+	if (sleeping->load() != 0)
+		FutexWake(sequence);
+}
+
+bool SharedQueryServer::Create(const std::string &regionName, int numChannels, size_t arenaBytes, ThreadPool* workers)
+{
+	Stop();
+
+	numChannels = std::max(numChannels, 1);
+	arenaBytes = (size_t)AlignUp(arenaBytes, 4096);
+	size_t arenasOffset = (size_t)AlignUp(FirstChannelOffset() + numChannels * ChannelStride(), 4096);
+	size_t bytes = arenasOffset + numChannels * arenaBytes;
+
+	std::string shmName = "/" + regionName;
+	shm_unlink(shmName.c_str());
+	int fd = shm_open(shmName.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+	if (fd < 0 || ftruncate(fd, bytes) != 0)
+	{
+		std::cout << "Can't create shared memory: " << regionName.data() << " (" << strerror(errno) << ")" << std::endl;
+		if (fd >= 0)
+		{
+			close(fd);
+			shm_unlink(shmName.c_str());
+		}
+		return false;
+	}
+
+	void* mapping = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if (mapping == MAP_FAILED)
+	{
+		std::cout << "Can't map shared memory: " << regionName.data() << " (" << strerror(errno) << ")" << std::endl;
+		shm_unlink(shmName.c_str());
+		return false;
+	}
+
+	region = (unsigned char*)mapping;
+	regionBytes = bytes;
+	this->numChannels = numChannels;
+	this->arenasOffset = arenasOffset;
+	this->arenaBytes = arenaBytes;
+	name = regionName;
+	pool = workers;
+	stopping = false;
+
+	//A new mapping is zero filled, which is a valid empty state for every channel.
+	//The atomics are lock free, so they work the same from every process mapping them.
+	SharedRegionHeader* header = new (region) SharedRegionHeader();
+	header->numChannels = (unsigned int)numChannels;
+	header->regionBytes = bytes;
+	header->serverSequence = 0;
+	header->serverSleeping = 0;
+	header->running = 1;
+
+	for (int c = 0; c < numChannels; c++)
+	{
+		SharedChannel* channel = new (Channel(c)) SharedChannel();
+		channel->owner = 0;
+		channel->submitHead = 0;
+		channel->clientSleeping = 0;
+		channel->submitTail = 0;
+		channel->completeHead = 0;
+		channel->completeSequence = 0;
+		channel->completeTail = 0;
+		channel->arenaOffset = arenasOffset + c * arenaBytes;
+		channel->arenaBytes = arenaBytes;
+	}
+
+	//Publish the region only once it is laid out
+	std::atomic_thread_fence(std::memory_order_release);
+	header->magic = sharedRegionMagic;
+	return true;
+}
+
+void SharedQueryServer::Stop()
+{
+	if (region == nullptr) return;
+
+	SharedRegionHeader* header = Header();
+	header->running = 0;
+	for (int c = 0; c < numChannels; c++)
+	{
+		SharedChannel* channel = Channel(c);
+		channel->completeSequence++;
+		FutexWake(&channel->completeSequence);
+	}
+
+	munmap(region, regionBytes);
+	shm_unlink(("/" + name).c_str());
+	region = nullptr;
+	regionBytes = 0;
+	numChannels = 0;
+}
+
+//Whether size bytes from offset lie within [arenaBegin, arenaEnd), without adding anything which can overflow
+static bool InArena(unsigned long long offset, unsigned long long size, unsigned long long arenaBegin, unsigned long long arenaEnd)
+{
+	return arenaBegin <= offset && offset <= arenaEnd && size <= arenaEnd - offset;
+}
+
+void SharedQueryServer::Run()
+{
+	SharedRegionHeader* header = Header();
+
+	//The queries taken this round, and how each splits into tasks. Each query is copied
+	//out of its slot once, so the client can't change it between checking and classifying.
+	std::vector<int> queryChannels;
+	std::vector<unsigned int> querySlots;
+	std::vector<SharedQuery> queries;
+	std::vector<int> firstTask;
+	std::vector<int> rangesPerPlane;
+	std::vector<int> queryPlanes;
+
+	while (!stopping)
+	{
+		unsigned int sequence = header->serverSequence.load();
+
+		queryChannels.clear();
+		querySlots.clear();
+		queries.clear();
+		for (int c = 0; c < numChannels; c++)
+		{
+			SharedChannel* channel = Channel(c);
+			unsigned int head = channel->submitHead.load(std::memory_order_acquire);
+			unsigned int first = channel->submitTail.load(std::memory_order_relaxed);
+
+			//A client can't have more queries waiting than its ring holds. A head further ahead
+			//is corrupt, and the channel isn't served until its head is back within reach.
+			if (head - first > sharedSlots) continue;
+
+			for (unsigned int tail = first; tail != head; tail++)
+			{
+				unsigned int slot = channel->submitRing[tail % sharedSlots];
+				if (slot >= sharedSlots) continue;
+				queryChannels.push_back(c);
+				querySlots.push_back(slot);
+				queries.push_back(channel->slots[slot]);
+			}
+
+			//The ring entries have been read, the slots stay in use until they are answered
+			channel->submitTail.store(head, std::memory_order_release);
+		}
+
+		telemetry->queryQueueDepth.store(queries.size(), std::memory_order_relaxed);
+		if (queries.empty())
+		{
+			//Say we are going to sleep, then look once more, so a submit can't slip in between
+			header->serverSleeping = 1;
+			if (header->serverSequence.load() == sequence)
+				FutexWait(&header->serverSequence, sequence, 100);
+			header->serverSleeping = 0;
+			continue;
+		}
+
+		//Every plane and range of points of every query is a separate task.
+		//Queries reaching outside their own channel's arena are answered without being classified.
+		int numTasks = 0;
+		firstTask.resize(queries.size());
+		rangesPerPlane.resize(queries.size());
+		queryPlanes.resize(queries.size());
+		for (size_t q = 0; q < queries.size(); q++)
+		{
+			SharedQuery &query = queries[q];
+			unsigned long long arenaBegin = arenasOffset + (unsigned long long)queryChannels[q] * arenaBytes;
+			unsigned long long arenaEnd = arenaBegin + arenaBytes;
+			bool valid = query.numPlanes <= maxQueryPlanes && query.numPoints <= maxQueryPoints
+				&& (unsigned long long)query.numPlanes * query.numPoints <= maxQuerySides
+				&& InArena(query.planesOffset, (unsigned long long)query.numPlanes * sizeof(QueryPlane), arenaBegin, arenaEnd)
+				&& InArena(query.pointsOffset, (unsigned long long)query.numPoints * 3 * sizeof(float), arenaBegin, arenaEnd)
+				&& InArena(query.sidesOffset, (unsigned long long)query.numPlanes * query.numPoints, arenaBegin, arenaEnd);
+			if (!valid)
+			{
+				query.numPlanes = 0;
+				query.numPoints = 0;
+			}
+
+			firstTask[q] = numTasks;
+			queryPlanes[q] = (int)query.numPlanes;
+			rangesPerPlane[q] = std::max((int)((query.numPoints + grain - 1) / grain), 1);
+			numTasks += rangesPerPlane[q] * queryPlanes[q];
+		}
+
+		std::vector<int> collisions(numTasks, 0);
+		ParallelRanges(pool, numTasks, 1, [&](int begin, int end)
+		{
+			for (int task = begin; task < end; task++)
+			{
+				size_t q = std::upper_bound(firstTask.begin(), firstTask.end(), task) - firstTask.begin() - 1;
+				const SharedQuery &query = queries[q];
+				int local = task - firstTask[q];
+				int plane = local / rangesPerPlane[q];
+				int start = (local % rangesPerPlane[q]) * grain;
+				int count = std::min(grain, (int)query.numPoints - start);
+				if (count <= 0) continue;
+
+				const QueryPlane &sent = ((const QueryPlane*)(region + query.planesOffset))[plane];
+				WorldPlane worldPlane = MakeWorldPlane(glm::vec3(sent.normal[0], sent.normal[1], sent.normal[2]),
+					glm::vec3(sent.center[0], sent.center[1], sent.center[2]), sent.halfExtent);
+
+				//Read the points and write the sides where they are in the client's arena
+				const float* x = (const float*)(region + query.pointsOffset);
+				const float* y = x + query.numPoints;
+				const float* z = y + query.numPoints;
+				signed char* sides = (signed char*)(region + query.sidesOffset) + (size_t)plane * query.numPoints;
+				collisions[task] = ClassifyPoints(worldPlane, x + start, y + start, z + start, count, query.acceptanceRange, sides + start);
+			}
+		});
+
+		//Answer every query in the order it was taken, then wake its client
+		for (size_t q = 0; q < queries.size(); q++)
+		{
+			SharedChannel* channel = Channel(queryChannels[q]);
+
+			int numQueryTasks = rangesPerPlane[q] * queryPlanes[q];
+			unsigned long long numColliding = 0;
+			for (int t = 0; t < numQueryTasks; t++)
+				numColliding += collisions[firstTask[q] + t];
+			channel->slots[querySlots[q]].numColliding = numColliding;
+
+			unsigned int completeHead = channel->completeHead.load(std::memory_order_relaxed);
+			channel->completeRing[completeHead % sharedSlots] = querySlots[q];
+			channel->completeHead.store(completeHead + 1, std::memory_order_release);
+
+			numQueries++;
+			numPoints += queries[q].numPoints;
+			telemetry->queriesAnswered.fetch_add(1, std::memory_order_relaxed);
+
+			if (q + 1 == queries.size() || queryChannels[q + 1] != queryChannels[q])
+				Signal(&channel->completeSequence, &channel->clientSleeping);
+		}
+		numRounds++;
+	}
+}
+
+bool SharedQueryClient::Attach(const std::string &regionName)
+{
+	Detach();
+
+	int fd = shm_open(("/" + regionName).c_str(), O_RDWR, 0);
+	struct stat info;
+	if (fd < 0 || fstat(fd, &info) != 0 || (size_t)info.st_size < sizeof(SharedRegionHeader))
+	{
+		std::cout << "Can't open shared memory: " << regionName.data() << " (" << strerror(errno) << ")" << std::endl;
+		if (fd >= 0) close(fd);
+		return false;
+	}
+
+	void* mapping = mmap(nullptr, info.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if (mapping == MAP_FAILED)
+	{
+		std::cout << "Can't map shared memory: " << regionName.data() << " (" << strerror(errno) << ")" << std::endl;
+		return false;
+	}
+	region = (unsigned char*)mapping;
+	regionBytes = info.st_size;
+
+	SharedRegionHeader* header = (SharedRegionHeader*)region;
+	if (header->magic != sharedRegionMagic || header->regionBytes != regionBytes || header->running == 0)
+	{
+		std::cout << "Shared memory " << regionName.data() << " is not a running query server" << std::endl;
+		Detach();
+		return false;
+	}
+	std::atomic_thread_fence(std::memory_order_acquire);
+
+	//Claim the first free channel
+	unsigned int pid = (unsigned int)getpid();
+	for (unsigned int c = 0; c < header->numChannels && channel == nullptr; c++)
+	{
+		SharedChannel* candidate = (SharedChannel*)(region + FirstChannelOffset() + c * ChannelStride());
+		unsigned int expected = 0;
+		if (candidate->owner.compare_exchange_strong(expected, pid))
+			channel = candidate;
+	}
+	if (channel == nullptr)
+	{
+		std::cout << "Every channel of shared memory " << regionName.data() << " is in use" << std::endl;
+		Detach();
+		return false;
+	}
+
+	freeSlots.clear();
+	for (unsigned int s = sharedSlots; s > 0; s--)
+		freeSlots.push_back(s - 1);
+	arenaUsed = 0;
+	return true;
+}
+
+void SharedQueryClient::Detach()
+{
+	if (region == nullptr) return;
+
+	if (channel != nullptr)
+	{
+		//The server may still be writing into the arena, so wait for everything submitted
+		while (channel->completeTail != channel->submitHead.load() && WaitAnswer() != nullptr)
+			;
+		channel->owner = 0;
+		channel = nullptr;
+	}
+
+	munmap(region, regionBytes);
+	region = nullptr;
+	regionBytes = 0;
+}
+
+void SharedQueryClient::Submit(SharedQuery* query)
+{
+	unsigned int head = channel->submitHead.load(std::memory_order_relaxed);
+	channel->submitRing[head % sharedSlots] = (unsigned int)(query - channel->slots);
+	channel->submitHead.store(head + 1, std::memory_order_release);
+
+	SharedRegionHeader* header = (SharedRegionHeader*)region;
+	Signal(&header->serverSequence, &header->serverSleeping);
+}
+
+SharedQuery* SharedQueryClient::WaitAnswer()
+{
+	SharedRegionHeader* header = (SharedRegionHeader*)region;
+
+	for (;;)
+	{
+		unsigned int sequence = channel->completeSequence.load();
+		if (channel->completeTail != channel->completeHead.load(std::memory_order_acquire))
+		{
+			unsigned int slot = channel->completeRing[channel->completeTail % sharedSlots];
+			channel->completeTail++;
+			return &channel->slots[slot];
+		}
+		if (header->running == 0)
+			return nullptr;
+
+		channel->clientSleeping = 1;
+		if (channel->completeSequence.load() == sequence && channel->completeHead.load() == channel->completeTail)
+			FutexWait(&channel->completeSequence, sequence, 100);
+		channel->clientSleeping = 0;
+	}
+}
+
+#else
+
+bool SharedQueryServer::Create(const std::string &regionName, int numChannels, size_t arenaBytes, ThreadPool* workers)
+{
+	std::cout << "Shared memory queries need futexes and named shared memory, which this system does not have" << std::endl;
+	return false;
+}
+
+void SharedQueryServer::Run()
+{
+}
+
+void SharedQueryServer::Stop()
+{
+}
+
+bool SharedQueryClient::Attach(const std::string &regionName)
+{
+	std::cout << "Shared memory queries need futexes and named shared memory, which this system does not have" << std::endl;
+	return false;
+}
+
+void SharedQueryClient::Detach()
+{
+}
+
+void SharedQueryClient::Submit(SharedQuery* query)
+{
+}
+
+SharedQuery* SharedQueryClient::WaitAnswer()
+{
+	return nullptr;
+}
+
+#endif
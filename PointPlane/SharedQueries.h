@@ -0,0 +1,256 @@
+/*
+Title: Point - Plane
+File Name: SharedQueries.h
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+Answers point - plane classification queries from other processes through a
+block of shared memory, so neither the points nor the answers are copied by
+the kernel.
+
+The server creates a named shared memory region split into channels, and each
+client claims one channel. A channel holds a set of query slots, two rings of
+slot numbers and an arena for data. The client writes the planes and points of
+a query straight into its arena, fills in a slot, and puts the slot's number on
+the submission ring. The server classifies the points where they lie, writes the
+sides into the arena behind them and puts the slot on the completion ring.
+
+Each ring has one writer and one reader, so it only needs a head and a tail
+which are read and written atomically, and no locks. When there is nothing to
+do the server and clients sleep on a futex, a counter in the shared region which
+the other side bumps before waking it, and which is only woken through the kernel
+when the sleeper has said it is sleeping.
+
+Shared memory names, futexes and mmap are Linux only. On other systems Create
+and Attach print a message and fail.
+*/
+
+#ifndef _SHARED_QUERIES_H
+#define _SHARED_QUERIES_H
+
+#include "QueryServer.h"
+
+const unsigned int sharedRegionMagic = 0x4D485350;	//"PSHM"
+
+//Query slots in every channel, also the size of its rings
+const unsigned int sharedSlots = 256;
+
+//A query in a channel. Offsets are in bytes from the start of the region,
+//so they mean the same thing in every process which maps it.
+struct SharedQuery
+{
+	unsigned int id;
+	unsigned int numPlanes;
+	unsigned int numPoints;
+	float acceptanceRange;
+
+	unsigned long long planesOffset;	//QueryPlane[numPlanes]
+	unsigned long long pointsOffset;	//x[numPoints], then y, then z
+	unsigned long long sidesOffset;		//PlaneSide of every point against every plane, plane by plane
+
+	//Filled in by the server, summed over every plane
+	unsigned long long numColliding;
+};
+
+//One client's share of the region. The counters written by each side are on their own cache lines.
+struct SharedChannel
+{
+	//Process id of the client which claimed the channel, or 0 when free
+	alignas(64) std::atomic<unsigned int> owner;
+
+	//Written by the client
+	alignas(64) std::atomic<unsigned int> submitHead;
+	std::atomic<unsigned int> clientSleeping;
+
+	//Written by the server
+	alignas(64) std::atomic<unsigned int> submitTail;
+	std::atomic<unsigned int> completeHead;
+	std::atomic<unsigned int> completeSequence;
+
+	//Read only by the client
+	alignas(64) unsigned int completeTail;
+
+	unsigned int submitRing[sharedSlots];
+	unsigned int completeRing[sharedSlots];
+	SharedQuery slots[sharedSlots];
+
+	//Set by the server for the client. The server keeps its own copy, and only
+	//reads and writes inside this range for the channel's queries.
+	unsigned long long arenaOffset;
+	unsigned long long arenaBytes;
+};
+
+struct SharedRegionHeader
+{
+	unsigned int magic;
+	unsigned int numChannels;
+	unsigned long long regionBytes;
+
+	//Cleared when the server stops, so clients stop waiting for answers
+	std::atomic<unsigned int> running;
+
+	//Bumped by clients after submitting, the server sleeps on it
+	alignas(64) std::atomic<unsigned int> serverSequence;
+	std::atomic<unsigned int> serverSleeping;
+};
+
+struct SharedQueryServer
+{
+	std::string name;
+	unsigned char* region;
+	size_t regionBytes;
+
+	//The layout Create chose. Clients can write anything in the region,
+	//so the server never takes these back from it.
+	int numChannels;
+	size_t arenasOffset;
+	size_t arenaBytes;
+
+	ThreadPool* pool;
+
+	//Points per task when a query is split between threads
+	int grain;
+
+	std::atomic<bool> stopping;
+
+	long long numQueries;
+	long long numRounds;
+	long long numPoints;
+
+	SharedQueryServer();
+
+	~SharedQueryServer();
+
+	///
+	//Creates the shared memory region, replacing an old one with the same name
+	//
+	//Parameters:
+	//	regionName: The name clients attach to
+	//	numChannels: The most clients which can be attached at once
+	//	arenaBytes: The bytes of query data each client may have in flight
+	//	workers: Classifies the queries, or nullptr to classify on the server thread
+	//
+	//Returns:
+	//	true if the region was created, else false
+	bool Create(const std::string &regionName, int numChannels, size_t arenaBytes, ThreadPool* workers);
+
+	///
+	//Answers queries until stopping is set
+	void Run();
+
+	///
+	//Tells attached clients the server has gone, then unmaps and removes the region
+	void Stop();
+
+	///
+	//Prints how many queries were answered
+	void PrintSummary(std::ostream &out) const;
+
+private:
+	SharedRegionHeader* Header() const
+	{
+		return (SharedRegionHeader*)region;
+	}
+
+	SharedChannel* Channel(int channel) const;
+};
+
+struct SharedQueryClient
+{
+	unsigned char* region;
+	size_t regionBytes;
+	SharedChannel* channel;
+
+	//Slots not in use, and the next free byte of the arena
+	std::vector<unsigned int> freeSlots;
+	unsigned long long arenaUsed;
+
+	SharedQueryClient();
+
+	~SharedQueryClient();
+
+	///
+	//Maps a server's region and claims a free channel
+	//
+	//Parameters:
+	//	regionName: The name the server created the region with
+	//
+	//Returns:
+	//	true if a channel was claimed, else false
+	bool Attach(const std::string &regionName);
+
+	///
+	//Waits for every answer, frees the channel and unmaps the region
+	void Detach();
+
+	///
+	//Reserves a slot and room in the arena for a query. Write the planes and points
+	//through Planes and Points, then call Submit.
+	//
+	//Parameters:
+	//	id: Kept with the query, for the caller's use
+	//	numPlanes, numPoints: The size of the query
+	//	acceptanceRange: Points this close to a plane are considered colliding
+	//
+	//Returns:
+	//	The query, or nullptr if every slot or the arena is in use until answers are collected
+	SharedQuery* BeginQuery(unsigned int id, int numPlanes, int numPoints, float acceptanceRange);
+
+	QueryPlane* Planes(const SharedQuery* query) const
+	{
+		return (QueryPlane*)(region + query->planesOffset);
+	}
+
+	//The x coordinates, followed by the y and then the z coordinates
+	float* Points(const SharedQuery* query) const
+	{
+		return (float*)(region + query->pointsOffset);
+	}
+
+	const signed char* Sides(const SharedQuery* query) const
+	{
+		return (const signed char*)(region + query->sidesOffset);
+	}
+
+	///
+	//Hands a query to the server
+	void Submit(SharedQuery* query);
+
+	///
+	//Waits for the next answer. Queries are answered in the order they were submitted.
+	//
+	//Returns:
+	//	The answered query, or nullptr if the server has stopped
+	SharedQuery* WaitAnswer();
+
+	///
+	//Returns an answered query's slot, and its arena space once no query is left in flight
+	void Finish(SharedQuery* query);
+
+	///
+	//Returns the number of queries submitted or being written whose slots have not been returned
+	int NumInFlight() const
+	{
+		return (int)(sharedSlots - freeSlots.size());
+	}
+};
+
+#endif //_SHARED_QUERIES_H
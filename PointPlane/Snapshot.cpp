@@ -0,0 +1,423 @@
+/*
+Title: Point - Plane
+File Name: Snapshot.cpp
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+Checkpoint and restore of the simulation state. A snapshot file is a small
+fixed size header followed by the arrays of the state, one after another.
+When compression is requested the arrays are packed into one block and
+compressed together, otherwise each array is written with a single write.
+Restoring reads the whole file with a single read and copies the arrays out.
+*/
+
+#include "Snapshot.h"
+
+//Identifies a snapshot file ("PPSN")
+static const unsigned int snapshotMagic = 0x4E535050;
+static const unsigned int snapshotVersion = 1;
+
+//Flag set in the header when the payload is compressed
+static const unsigned int snapshotCompressed = 1;
+
+//The header which begins every snapshot file
+struct SnapshotHeader
+{
+	unsigned int magic;
+	unsigned int version;
+	unsigned int flags;
+	unsigned int numBodies;
+	unsigned int numColliders;
+	unsigned int numPairs;
+	int selectedBody;
+	unsigned int rawSize;		//Size of the payload once decompressed
+	unsigned int storedSize;	//Size of the payload in the file
+};
+
+//Compressor settings
+static const int hashBits = 12;
+static const int minMatch = 4;
+static const int maxOffset = 65535;
+//The last match must begin at least this many bytes before the end of the block
+static const int matchLimit = 12;
+//The last bytes of a block are always literals
+static const int lastLiterals = 5;
+
+#pragma region Compression
+
+static unsigned int Read32(const unsigned char* p)
+{
+	unsigned int value;
+	memcpy(&value, p, sizeof(value));
+	return value;
+}
+
+static unsigned int HashSequence(unsigned int sequence)
+{
+	return (sequence * 2654435761u) >> (32 - hashBits);
+}
+
+//Writes a length which did not fit into its 4 bit token field
+static unsigned char* WriteLength(unsigned char* op, int length)
+{
+	while (length >= 255)
+	{
+		*op++ = 255;
+		length -= 255;
+	}
+	*op++ = (unsigned char)length;
+	return op;
+}
+
+//Writes one sequence of literals, optionally followed by a match
+static bool WriteSequence(const unsigned char* literals, int numLiterals, int offset, int matchLength, unsigned char* &op, unsigned char* opEnd)
+{
+	//Worst case size of this sequence
+	int needed = 1 + numLiterals + numLiterals / 255 + 1 + (matchLength > 0 ? 2 + matchLength / 255 + 1 : 0);
+	if (op + needed > opEnd) return false;
+
+	unsigned char* token = op++;
+	*token = (unsigned char)((numLiterals >= 15 ? 15 : numLiterals) << 4);
+	if (numLiterals >= 15) op = WriteLength(op, numLiterals - 15);
+
+	memcpy(op, literals, numLiterals);
+	op += numLiterals;
+
+	if (matchLength > 0)
+	{
+		*op++ = (unsigned char)(offset & 0xFF);
+		*op++ = (unsigned char)(offset >> 8);
+
+		int extra = matchLength - minMatch;
+		*token |= (unsigned char)(extra >= 15 ? 15 : extra);
+		if (extra >= 15) op = WriteLength(op, extra - 15);
+	}
+	return true;
+}
+
+int CompressBound(int srcSize)
+{
+	return srcSize + srcSize / 255 + 16;
+}
+
+int CompressBlock(const unsigned char* src, int srcSize, unsigned char* dst, int dstCapacity)
+{
+	unsigned char* op = dst;
+	unsigned char* opEnd = dst + dstCapacity;
+
+	int anchor = 0;
+	int ip = 0;
+
+	if (srcSize > matchLimit)
+	{
+		//Last position each hashed 4 byte sequence was seen at
+		std::vector<int> table(1 << hashBits, -1);
+		int limit = srcSize - matchLimit;
+
+		while (ip < limit)
+		{
+			unsigned int sequence = Read32(src + ip);
+			unsigned int h = HashSequence(sequence);
+			int ref = table[h];
+			table[h] = ip;
+
+			if (ref < 0 || ip - ref > maxOffset || Read32(src + ref) != sequence)
+			{
+				ip++;
+				continue;
+			}
+
+			//Extend the match as far as it goes
+			int length = minMatch;
+			while (ip + length < srcSize - lastLiterals && src[ref + length] == src[ip + length])
+				length++;
+
+			if (!WriteSequence(src + anchor, ip - anchor, ip - ref, length, op, opEnd)) return 0;
+
+			ip += length;
+			anchor = ip;
+		}
+	}
+
+	//Whatever is left is written as literals
+	if (!WriteSequence(src + anchor, srcSize - anchor, 0, 0, op, opEnd)) return 0;
+
+	return (int)(op - dst);
+}
+
+int DecompressBlock(const unsigned char* src, int srcSize, unsigned char* dst, int dstSize)
+{
+	int ip = 0;
+	int op = 0;
+
+	while (ip < srcSize)
+	{
+		unsigned char token = src[ip++];
+
+		//Copy the literals
+		int numLiterals = token >> 4;
+		if (numLiterals == 15)
+		{
+			unsigned char b;
+			do
+			{
+				if (ip >= srcSize) return -1;
+				b = src[ip++];
+				numLiterals += b;
+			} while (b == 255);
+		}
+		if (ip + numLiterals > srcSize || op + numLiterals > dstSize) return -1;
+		memcpy(dst + op, src + ip, numLiterals);
+		ip += numLiterals;
+		op += numLiterals;
+
+		//The last sequence has no match
+		if (ip >= srcSize) break;
+
+		//Copy the match
+		if (ip + 2 > srcSize) return -1;
+		int offset = src[ip] | (src[ip + 1] << 8);
+		ip += 2;
+		if (offset == 0 || offset > op) return -1;
+
+		int matchLength = token & 15;
+		if (matchLength == 15)
+		{
+			unsigned char b;
+			do
+			{
+				if (ip >= srcSize) return -1;
+				b = src[ip++];
+				matchLength += b;
+			} while (b == 255);
+		}
+		matchLength += minMatch;
+		if (op + matchLength > dstSize) return -1;
+
+		//Matches may overlap the bytes they produce, so copy one byte at a time
+		for (int i = 0; i < matchLength; i++, op++)
+			dst[op] = dst[op - offset];
+	}
+
+	return op;
+}
+
+#pragma endregion Compression
+
+#pragma region Snapshots
+
+//Fills a header describing the given state
+static SnapshotHeader MakeHeader(const SimulationState &state)
+{
+	SnapshotHeader header;
+	header.magic = snapshotMagic;
+	header.version = snapshotVersion;
+	header.flags = 0;
+	header.numBodies = (unsigned int)state.translations.size();
+	header.numColliders = (unsigned int)state.colliderNormals.size();
+	header.numPairs = (unsigned int)state.pairStates.size();
+	header.selectedBody = state.selectedBody;
+	header.rawSize = (unsigned int)(header.numBodies * 3 * sizeof(glm::mat4)
+		+ header.numColliders * sizeof(glm::vec3)
+		+ header.numPairs);
+	header.storedSize = header.rawSize;
+	return header;
+}
+
+void SerializeState(const SimulationState &state, std::vector<unsigned char> &bytes)
+{
+	SnapshotHeader header = MakeHeader(state);
+	bytes.resize(header.rawSize);
+
+	unsigned char* p = bytes.data();
+	size_t matrixBytes = header.numBodies * sizeof(glm::mat4);
+	if (matrixBytes > 0)
+	{
+		memcpy(p, state.translations.data(), matrixBytes); p += matrixBytes;
+		memcpy(p, state.rotations.data(), matrixBytes); p += matrixBytes;
+		memcpy(p, state.scales.data(), matrixBytes); p += matrixBytes;
+	}
+	if (header.numColliders > 0)
+	{
+		memcpy(p, state.colliderNormals.data(), header.numColliders * sizeof(glm::vec3));
+		p += header.numColliders * sizeof(glm::vec3);
+	}
+	if (header.numPairs > 0)
+		memcpy(p, state.pairStates.data(), header.numPairs);
+}
+
+unsigned long long HashState(const SimulationState &state)
+{
+	std::vector<unsigned char> bytes;
+	SerializeState(state, bytes);
+
+	unsigned long long hash = 14695981039346656037ull;
+	for (size_t i = 0; i < bytes.size(); i++)
+	{
+		hash ^= bytes[i];
+		hash *= 1099511628211ull;
+	}
+	for (size_t i = 0; i < sizeof(state.selectedBody); i++)
+	{
+		hash ^= (unsigned char)(state.selectedBody >> (8 * i));
+		hash *= 1099511628211ull;
+	}
+	return hash;
+}
+
+bool SaveSnapshot(const SimulationState &state, const std::string &fileName, bool compress)
+{
+	if (state.rotations.size() != state.translations.size() || state.scales.size() != state.translations.size())
+	{
+		std::cout << "Can't save snapshot, the transform arrays differ in length" << std::endl;
+		return false;
+	}
+
+	std::ofstream file(fileName, std::ios::out | std::ios::binary);
+	if (!file.good())
+	{
+		std::cout << "Can't write file: " << fileName.data() << std::endl;
+		return false;
+	}
+
+	SnapshotHeader header = MakeHeader(state);
+
+	bool packed = false;
+	if (compress)
+	{
+		std::vector<unsigned char> raw;
+		SerializeState(state, raw);
+
+		std::vector<unsigned char> block(CompressBound((int)raw.size()));
+		int packedSize = CompressBlock(raw.data(), (int)raw.size(), block.data(), (int)block.size());
+
+		//A block which didn't compress is written uncompressed instead
+		if (packedSize > 0 || raw.empty())
+		{
+			header.flags |= snapshotCompressed;
+			header.storedSize = (unsigned int)packedSize;
+			file.write((const char*)&header, sizeof(header));
+			file.write((const char*)block.data(), packedSize);
+			packed = true;
+		}
+		else
+			std::cout << "Can't compress snapshot, writing it uncompressed: " << fileName.data() << std::endl;
+	}
+
+	if (!packed)
+	{
+		//One write per array
+		std::streamsize matrixBytes = header.numBodies * sizeof(glm::mat4);
+		file.write((const char*)&header, sizeof(header));
+		file.write((const char*)state.translations.data(), matrixBytes);
+		file.write((const char*)state.rotations.data(), matrixBytes);
+		file.write((const char*)state.scales.data(), matrixBytes);
+		file.write((const char*)state.colliderNormals.data(), header.numColliders * sizeof(glm::vec3));
+		file.write((const char*)state.pairStates.data(), header.numPairs);
+	}
+
+	bool written = file.good();
+	file.close();
+	if (!written) std::cout << "Failed writing snapshot: " << fileName.data() << std::endl;
+	return written;
+}
+
+bool LoadSnapshot(SimulationState &state, const std::string &fileName)
+{
+	std::ifstream file(fileName, std::ios::in | std::ios::binary);
+	if (!file.good())
+	{
+		std::cout << "Can't read file: " << fileName.data() << std::endl;
+		return false;
+	}
+
+	//Read the whole file at once
+	file.seekg(0, std::ios::end);
+	std::vector<unsigned char> contents((size_t)file.tellg());
+	file.seekg(0, std::ios::beg);
+	file.read((char*)contents.data(), contents.size());
+	file.close();
+
+	SnapshotHeader header;
+	if (contents.size() < sizeof(header))
+	{
+		std::cout << "Snapshot is truncated: " << fileName.data() << std::endl;
+		return false;
+	}
+	memcpy(&header, contents.data(), sizeof(header));
+
+	if (header.magic != snapshotMagic || header.version != snapshotVersion)
+	{
+		std::cout << "Not a snapshot file: " << fileName.data() << std::endl;
+		return false;
+	}
+
+	//Uncompressed arrays are copied straight out of the file, so they must all be there
+	size_t expectedSize = (size_t)header.numBodies * 3 * sizeof(glm::mat4) + (size_t)header.numColliders * sizeof(glm::vec3) + header.numPairs;
+	bool compressed = (header.flags & snapshotCompressed) != 0;
+	if (header.rawSize != expectedSize || contents.size() - sizeof(header) < header.storedSize
+		|| (!compressed && header.storedSize != header.rawSize))
+	{
+		std::cout << "Snapshot is truncated: " << fileName.data() << std::endl;
+		return false;
+	}
+
+	//Find the uncompressed arrays
+	const unsigned char* p = contents.data() + sizeof(header);
+	std::vector<unsigned char> raw;
+	if (compressed)
+	{
+		raw.resize(header.rawSize);
+		if (DecompressBlock(p, (int)header.storedSize, raw.data(), (int)raw.size()) != (int)header.rawSize)
+		{
+			std::cout << "Snapshot is corrupt: " << fileName.data() << std::endl;
+			return false;
+		}
+		p = raw.data();
+	}
+
+	//Copy the arrays out
+	size_t matrixBytes = (size_t)header.numBodies * sizeof(glm::mat4);
+	state.translations.resize(header.numBodies);
+	state.rotations.resize(header.numBodies);
+	state.scales.resize(header.numBodies);
+	state.colliderNormals.resize(header.numColliders);
+	state.pairStates.resize(header.numPairs);
+
+	if (matrixBytes > 0)
+	{
+		memcpy(state.translations.data(), p, matrixBytes); p += matrixBytes;
+		memcpy(state.rotations.data(), p, matrixBytes); p += matrixBytes;
+		memcpy(state.scales.data(), p, matrixBytes); p += matrixBytes;
+	}
+	if (header.numColliders > 0)
+	{
+		memcpy(state.colliderNormals.data(), p, header.numColliders * sizeof(glm::vec3));
+		p += header.numColliders * sizeof(glm::vec3);
+	}
+	if (header.numPairs > 0)
+		memcpy(state.pairStates.data(), p, header.numPairs);
+
+	state.selectedBody = header.selectedBody;
+	return true;
+}
+
+#pragma endregion Snapshots
@@ -0,0 +1,134 @@
+/*
+Title: Point - Plane
+File Name: Snapshot.h
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+Checkpoint and restore of the simulation state. The state is stored as a
+structure of arrays (all translations together, all rotations together, and so on)
+so that every array can be written to disk with a single call and read back
+with a single memcpy. Snapshots can optionally be compressed with a small
+LZ4 style block compressor which lives entirely in this project.
+*/
+
+#ifndef _SNAPSHOT_H
+#define _SNAPSHOT_H
+
+#include "GLIncludes.h"
+
+//Everything needed to resume a simulation, laid out as a structure of arrays
+struct SimulationState
+{
+	//Body transforms, one entry per body
+	std::vector<glm::mat4> translations;
+	std::vector<glm::mat4> rotations;
+	std::vector<glm::mat4> scales;
+
+	//Plane collider normals, one entry per plane collider
+	std::vector<glm::vec3> colliderNormals;
+
+	//Collision state of each tested pair (1 when colliding, else 0)
+	std::vector<unsigned char> pairStates;
+
+	//Index of the selected body
+	int selectedBody;
+
+	SimulationState()
+	{
+		selectedBody = 0;
+	}
+};
+
+///
+//Writes the simulation state to a snapshot file
+//
+//Parameters:
+//	state: The state to save
+//	fileName: The file to write the snapshot to
+//	compress: Whether or not the arrays should be compressed
+//
+//Returns:
+//	true if the snapshot was written, else false
+bool SaveSnapshot(const SimulationState &state, const std::string &fileName, bool compress);
+
+///
+//Reads a snapshot file back into a simulation state
+//
+//Parameters:
+//	state: The state to fill
+//	fileName: The snapshot file to read
+//
+//Returns:
+//	true if the snapshot was read, else false
+bool LoadSnapshot(SimulationState &state, const std::string &fileName);
+
+///
+//Packs the arrays of the simulation state into one contiguous block of memory.
+//This is the payload of a snapshot file before compression.
+//
+//Parameters:
+//	state: The state to serialize
+//	bytes: The buffer to fill, resized to fit
+void SerializeState(const SimulationState &state, std::vector<unsigned char> &bytes);
+
+///
+//Hashes the simulation state so that two runs can be checked for identical results
+//
+//Returns:
+//	A 64 bit FNV-1a hash of the serialized arrays and the selected body
+unsigned long long HashState(const SimulationState &state);
+
+///
+//Compresses a block of memory using the LZ4 block layout
+//
+//Overview:
+//	The block is split into sequences. Each sequence is a run of literal bytes followed by
+//	a match, which is a copy of at least 4 bytes from up to 64KB back in the output.
+//	Matches are found with a hash table of the last position each 4 byte pattern was seen.
+//
+//Parameters:
+//	src: The bytes to compress
+//	srcSize: The number of bytes to compress
+//	dst: The buffer to write the compressed bytes to
+//	dstCapacity: The size of dst in bytes
+//
+//Returns:
+//	The compressed size in bytes, or 0 if dst was too small
+int CompressBlock(const unsigned char* src, int srcSize, unsigned char* dst, int dstCapacity);
+
+///
+//Decompresses a block written by CompressBlock
+//
+//Parameters:
+//	src: The compressed bytes
+//	srcSize: The number of compressed bytes
+//	dst: The buffer to write the original bytes to
+//	dstSize: The size of dst in bytes
+//
+//Returns:
+//	The number of bytes written to dst, or -1 if the block is malformed
+int DecompressBlock(const unsigned char* src, int srcSize, unsigned char* dst, int dstSize);
+
+///
+//Returns the largest size a compressed block of srcSize bytes can have
+int CompressBound(int srcSize);
+
+#endif //_SNAPSHOT_H
@@ -0,0 +1,206 @@
+/*
+Title: Point - Plane
+File Name: Telemetry.cpp
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+Live counters kept in shared memory for monitoring.
+*/
+
+#include "Telemetry.h"
+#include <iostream>
+#include <cstring>
+#include <new>
+#include <cstddef>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <cerrno>
+#endif
+
+//Where the counters live while they are not shared
+static TelemetryCounters localCounters;
+TelemetryCounters* telemetry = &localCounters;
+
+//The block the counters are shared through
+static TelemetrySegment sharedSegment;
+
+//The slot handed to the next thread which records points
+static std::atomic<int> nextPointSlot(0);
+
+int TelemetryThreadSlot()
+{
+	static thread_local int slot = nextPointSlot.fetch_add(1, std::memory_order_relaxed) % telemetryPointSlots;
+	return slot;
+}
+
+bool TelemetrySegment::Create(const std::string &segmentName)
+{
+	Close();
+	size_t bytes = sizeof(TelemetryCounters);
+	void* mapping = nullptr;
+
+#ifdef _WIN32
+	std::string mappingName = "Local\\" + segmentName;
+	HANDLE fileMapping = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, 0, (DWORD)bytes, mappingName.c_str());
+	if (fileMapping != nullptr)
+		mapping = MapViewOfFile(fileMapping, FILE_MAP_ALL_ACCESS, 0, 0, bytes);
+	if (mapping == nullptr)
+	{
+		std::cout << "Can't create telemetry: " << segmentName.data() << " (error " << GetLastError() << ")" << std::endl;
+		if (fileMapping != nullptr) CloseHandle(fileMapping);
+		return false;
+	}
+	handle = fileMapping;
+	unsigned int processId = (unsigned int)GetCurrentProcessId();
+#else
+	std::string shmName = "/" + segmentName;
+	shm_unlink(shmName.c_str());
+	int fd = shm_open(shmName.c_str(), O_RDWR | O_CREAT | O_EXCL, 0644);
+	if (fd >= 0 && ftruncate(fd, bytes) == 0)
+		mapping = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	if (fd >= 0) close(fd);
+	if (mapping == nullptr || mapping == MAP_FAILED)
+	{
+		std::cout << "Can't create telemetry: " << segmentName.data() << " (" << strerror(errno) << ")" << std::endl;
+		if (fd >= 0) shm_unlink(shmName.c_str());
+		return false;
+	}
+	unsigned int processId = (unsigned int)getpid();
+#endif
+
+	//New mappings are zero filled, and the atomics are lock free so they work across processes
+	counters = new (mapping) TelemetryCounters();
+	counters->version = telemetryVersion;
+	counters->size = sizeof(TelemetryCounters);
+	counters->processId = processId;
+	std::atomic_thread_fence(std::memory_order_release);
+	counters->magic = telemetryMagic;
+
+	name = segmentName;
+	created = true;
+	return true;
+}
+
+bool TelemetrySegment::Attach(const std::string &segmentName)
+{
+	Close();
+	void* mapping = nullptr;
+	size_t bytes = 0;
+
+#ifdef _WIN32
+	std::string mappingName = "Local\\" + segmentName;
+	HANDLE fileMapping = OpenFileMappingA(FILE_MAP_READ, FALSE, mappingName.c_str());
+	if (fileMapping != nullptr)
+		mapping = MapViewOfFile(fileMapping, FILE_MAP_READ, 0, 0, 0);
+	if (mapping == nullptr)
+	{
+		std::cout << "Can't open telemetry: " << segmentName.data() << " (error " << GetLastError() << ")" << std::endl;
+		if (fileMapping != nullptr) CloseHandle(fileMapping);
+		return false;
+	}
+	handle = fileMapping;
+	MEMORY_BASIC_INFORMATION info;
+	VirtualQuery(mapping, &info, sizeof(info));
+	bytes = info.RegionSize;
+#else
+	int fd = shm_open(("/" + segmentName).c_str(), O_RDONLY, 0);
+	struct stat info;
+	if (fd >= 0 && fstat(fd, &info) == 0 && info.st_size > 0)
+	{
+		bytes = (size_t)info.st_size;
+		mapping = mmap(nullptr, bytes, PROT_READ, MAP_SHARED, fd, 0);
+	}
+	if (fd >= 0) close(fd);
+	if (mapping == nullptr || mapping == MAP_FAILED)
+	{
+		std::cout << "Can't open telemetry: " << segmentName.data() << " (" << strerror(errno) << ")" << std::endl;
+		return false;
+	}
+#endif
+
+	counters = (TelemetryCounters*)mapping;
+	name = segmentName;
+	created = false;
+
+	//Readers built from an older header only read the fields they know about
+	if (bytes < offsetof(TelemetryCounters, frames) || counters->magic != telemetryMagic || counters->size > bytes || counters->size < sizeof(TelemetryCounters))
+	{
+		std::cout << "Telemetry " << segmentName.data() << " has an unknown layout" << std::endl;
+		Close();
+		return false;
+	}
+	std::atomic_thread_fence(std::memory_order_acquire);
+	return true;
+}
+
+void TelemetrySegment::Close()
+{
+	if (counters == nullptr) return;
+
+#ifdef _WIN32
+	UnmapViewOfFile(counters);
+	CloseHandle((HANDLE)handle);
+	handle = nullptr;
+#else
+	munmap(counters, created ? sizeof(TelemetryCounters) : counters->size);
+	if (created) shm_unlink(("/" + name).c_str());
+#endif
+
+	counters = nullptr;
+	created = false;
+	name.clear();
+}
+
+bool OpenTelemetry(const std::string &name)
+{
+	if (!sharedSegment.Create(name)) return false;
+
+	//Carry over anything counted so far, then switch every writer to the shared block
+	TelemetryCounters* shared = sharedSegment.counters;
+	shared->frames = localCounters.frames.load();
+	shared->totalUpdateTime = localCounters.totalUpdateTime.load();
+	shared->totalRenderTime = localCounters.totalRenderTime.load();
+	shared->totalSwapTime = localCounters.totalSwapTime.load();
+	shared->maxFrameTime = localCounters.maxFrameTime.load();
+	shared->drawCalls = localCounters.drawCalls.load();
+	shared->pairTests = localCounters.pairTests.load();
+	shared->pairCollisions = localCounters.pairCollisions.load();
+	shared->pointsClassified = localCounters.PointsClassified();
+	shared->pointsColliding = localCounters.PointsColliding();
+	shared->queriesAnswered = localCounters.queriesAnswered.load();
+	shared->pairsSkipped = localCounters.pairsSkipped.load();
+	telemetry = shared;
+	return true;
+}
+
+void CloseTelemetry()
+{
+	telemetry = &localCounters;
+	sharedSegment.Close();
+}
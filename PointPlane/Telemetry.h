@@ -0,0 +1,212 @@
+/*
+Title: Point - Plane
+File Name: Telemetry.h
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+Live counters for monitoring a running program without any I/O in its loops.
+
+The counters live in a block of shared memory with a fixed layout. The frame loop,
+the collision tests, the thread pool and the query servers add to them with
+relaxed atomic operations, which cost about as much as an ordinary add, and
+another process (PointPlaneStat) maps the block read only and prints them.
+Counters written from different threads are kept on separate cache lines so the
+writers don't slow each other down. The point counters, which every worker adds
+to after each batch, are split into a slot per thread which readers add up.
+
+Until OpenTelemetry is called the counters live in ordinary memory, so the code
+updating them never needs to check whether monitoring is turned on.
+*/
+
+#ifndef _TELEMETRY_H
+#define _TELEMETRY_H
+
+#include <atomic>
+#include <string>
+
+const unsigned int telemetryMagic = 0x4D4C4554;	//"TELM"
+const unsigned int telemetryVersion = 2;
+
+//Slots the point counters are split into. Threads take them in turn, and share them
+//only when there are more threads than slots.
+const int telemetryPointSlots = 64;
+
+//One thread's share of the point counters, on its own cache line
+struct alignas(64) TelemetryPointSlot
+{
+	std::atomic<unsigned long long> pointsClassified;
+	std::atomic<unsigned long long> pointsColliding;
+};
+
+///
+//Returns the point counter slot of the calling thread
+int TelemetryThreadSlot();
+
+//The shared memory block. Fields are only ever added at the end, and every
+//counter is 64 bits wide so the layout is the same for 32 and 64 bit builds.
+struct TelemetryCounters
+{
+	//Written once when the block is created
+	unsigned int magic;
+	unsigned int version;
+	unsigned int size;		//sizeof(TelemetryCounters) of the writer
+	unsigned int processId;
+
+	//Written by the frame loop. Times are in nanoseconds.
+	alignas(64) std::atomic<unsigned long long> frames;
+	std::atomic<unsigned long long> lastUpdateTime;
+	std::atomic<unsigned long long> lastRenderTime;
+	std::atomic<unsigned long long> lastSwapTime;
+	std::atomic<unsigned long long> totalUpdateTime;
+	std::atomic<unsigned long long> totalRenderTime;
+	std::atomic<unsigned long long> totalSwapTime;
+	std::atomic<unsigned long long> maxFrameTime;
+	std::atomic<unsigned long long> drawCalls;
+
+	//Written by update(), one per point - plane pair tested
+	alignas(64) std::atomic<unsigned long long> pairTests;
+	std::atomic<unsigned long long> pairCollisions;
+
+	//Points counted before the counters were shared. Read with PointsClassified and
+	//PointsColliding, which add the slots at the end of the block.
+	alignas(64) std::atomic<unsigned long long> pointsClassified;
+	std::atomic<unsigned long long> pointsColliding;
+
+	//Queue depths, the latest value seen. The task queue depth is published when a
+	//ParallelFor has queued its tasks and when it finishes, not after every task.
+	alignas(64) std::atomic<unsigned long long> taskQueueDepth;
+	std::atomic<unsigned long long> queryQueueDepth;
+	std::atomic<unsigned long long> queriesAnswered;
+
+	//Pairs whose collision layers don't interact, skipped before any test
+	alignas(64) std::atomic<unsigned long long> pairsSkipped;
+
+	//Written by the batch collision tests, each thread to its own slot
+	TelemetryPointSlot pointSlots[telemetryPointSlots];
+
+	///
+	//Adds one frame's phase times
+	void RecordFrame(unsigned long long updateTime, unsigned long long renderTime, unsigned long long swapTime)
+	{
+		frames.fetch_add(1, std::memory_order_relaxed);
+		lastUpdateTime.store(updateTime, std::memory_order_relaxed);
+		lastRenderTime.store(renderTime, std::memory_order_relaxed);
+		lastSwapTime.store(swapTime, std::memory_order_relaxed);
+		totalUpdateTime.fetch_add(updateTime, std::memory_order_relaxed);
+		totalRenderTime.fetch_add(renderTime, std::memory_order_relaxed);
+		totalSwapTime.fetch_add(swapTime, std::memory_order_relaxed);
+
+		//Only the frame loop writes the maximum, so it needs no compare and swap
+		unsigned long long frameTime = updateTime + renderTime + swapTime;
+		if (frameTime > maxFrameTime.load(std::memory_order_relaxed))
+			maxFrameTime.store(frameTime, std::memory_order_relaxed);
+	}
+
+	///
+	//Adds the result of classifying a batch of points
+	void RecordPoints(unsigned long long count, unsigned long long colliding)
+	{
+		TelemetryPointSlot &slot = pointSlots[TelemetryThreadSlot()];
+		slot.pointsClassified.fetch_add(count, std::memory_order_relaxed);
+		slot.pointsColliding.fetch_add(colliding, std::memory_order_relaxed);
+	}
+
+	///
+	//Returns the points classified by every thread
+	unsigned long long PointsClassified() const
+	{
+		unsigned long long total = pointsClassified.load(std::memory_order_relaxed);
+		for (int i = 0; i < telemetryPointSlots; i++)
+			total += pointSlots[i].pointsClassified.load(std::memory_order_relaxed);
+		return total;
+	}
+
+	///
+	//Returns the colliding points found by every thread
+	unsigned long long PointsColliding() const
+	{
+		unsigned long long total = pointsColliding.load(std::memory_order_relaxed);
+		for (int i = 0; i < telemetryPointSlots; i++)
+			total += pointSlots[i].pointsColliding.load(std::memory_order_relaxed);
+		return total;
+	}
+};
+
+//The counters being updated, in shared memory once OpenTelemetry has succeeded
+extern TelemetryCounters* telemetry;
+
+//A mapping of a telemetry block
+struct TelemetrySegment
+{
+	TelemetryCounters* counters;
+	std::string name;
+	bool created;
+
+	//The file mapping on Windows, unused elsewhere
+	void* handle;
+
+	TelemetrySegment()
+	{
+		counters = nullptr;
+		created = false;
+		handle = nullptr;
+	}
+
+	~TelemetrySegment()
+	{
+		Close();
+	}
+
+	///
+	//Creates a named telemetry block, replacing an old one with the same name
+	//
+	//Returns:
+	//	true if the block was created, else false
+	bool Create(const std::string &segmentName);
+
+	///
+	//Maps another process's telemetry block read only
+	//
+	//Returns:
+	//	true if the block was mapped and has a known layout, else false
+	bool Attach(const std::string &segmentName);
+
+	///
+	//Unmaps the block, removing its name if this segment created it
+	void Close();
+};
+
+///
+//Moves the counters into a new named shared memory block, which other processes can attach to
+//
+//Parameters:
+//	name: The name of the block
+//
+//Returns:
+//	true if the counters are now shared, else false
+bool OpenTelemetry(const std::string &name);
+
+///
+//Moves the counters back into ordinary memory and removes the shared block.
+//No other thread may be updating the counters.
+void CloseTelemetry();
+
+#endif //_TELEMETRY_H
@@ -0,0 +1,188 @@
+/*
+Title: Point - Plane
+File Name: TextOverlay.cpp
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+A minimal text overlay drawn on top of the scene.
+
+The segments of a character cell are numbered as follows, with the cell
+spanning 0 to 1 across and 0 to 2 up:
+
+	 ---0---
+	|\  |  /|
+	5 7 8 9 1
+	|  \|/  |
+	 -6- -15-
+	|  /|\  |
+	4 10 11 12 2
+	|/  |  \|
+	 ---3---   13
+*/
+
+#include "TextOverlay.h"
+
+//Endpoints of each segment within a character cell
+static const float segments[16][4] =
+{
+	{ 0.0f, 2.0f, 1.0f, 2.0f },		//0: top
+	{ 1.0f, 2.0f, 1.0f, 1.0f },		//1: upper right
+	{ 1.0f, 1.0f, 1.0f, 0.0f },		//2: lower right
+	{ 0.0f, 0.0f, 1.0f, 0.0f },		//3: bottom
+	{ 0.0f, 1.0f, 0.0f, 0.0f },		//4: lower left
+	{ 0.0f, 2.0f, 0.0f, 1.0f },		//5: upper left
+	{ 0.0f, 1.0f, 0.5f, 1.0f },		//6: middle left
+	{ 0.0f, 2.0f, 0.5f, 1.0f },		//7: upper left diagonal
+	{ 0.5f, 2.0f, 0.5f, 1.0f },		//8: upper center
+	{ 1.0f, 2.0f, 0.5f, 1.0f },		//9: upper right diagonal
+	{ 0.5f, 1.0f, 0.0f, 0.0f },		//10: lower left diagonal
+	{ 0.5f, 1.0f, 0.5f, 0.0f },		//11: lower center
+	{ 0.5f, 1.0f, 1.0f, 0.0f },		//12: lower right diagonal
+	{ 0.4f, 0.0f, 0.6f, 0.0f },		//13: decimal point
+	{ 0.0f, 0.0f, 0.0f, 0.0f },		//14: unused
+	{ 0.5f, 1.0f, 1.0f, 1.0f }		//15: middle right
+};
+
+#define SEG(n) (1 << (n))
+#define MIDDLE (SEG(6) | SEG(15))
+
+//Returns the segments lit for a character
+static int SegmentsOf(char c)
+{
+	switch (c)
+	{
+	case '0': return SEG(0) | SEG(1) | SEG(2) | SEG(3) | SEG(4) | SEG(5);
+	case '1': return SEG(1) | SEG(2);
+	case '2': return SEG(0) | SEG(1) | MIDDLE | SEG(4) | SEG(3);
+	case '3': return SEG(0) | SEG(1) | MIDDLE | SEG(2) | SEG(3);
+	case '4': return SEG(5) | MIDDLE | SEG(1) | SEG(2);
+	case '5': return SEG(0) | SEG(5) | MIDDLE | SEG(2) | SEG(3);
+	case '6': return SEG(0) | SEG(5) | MIDDLE | SEG(4) | SEG(3) | SEG(2);
+	case '7': return SEG(0) | SEG(1) | SEG(2);
+	case '8': return SEG(0) | SEG(1) | SEG(2) | SEG(3) | SEG(4) | SEG(5) | MIDDLE;
+	case '9': return SEG(0) | SEG(1) | SEG(2) | SEG(3) | SEG(5) | MIDDLE;
+	case 'A': return SEG(0) | SEG(1) | SEG(2) | SEG(4) | SEG(5) | MIDDLE;
+	case 'B': return SEG(0) | SEG(1) | SEG(2) | SEG(3) | SEG(8) | SEG(11) | SEG(15);
+	case 'C': return SEG(0) | SEG(3) | SEG(4) | SEG(5);
+	case 'D': return SEG(0) | SEG(1) | SEG(2) | SEG(3) | SEG(8) | SEG(11);
+	case 'E': return SEG(0) | SEG(3) | SEG(4) | SEG(5) | SEG(6);
+	case 'F': return SEG(0) | SEG(4) | SEG(5) | SEG(6);
+	case 'G': return SEG(0) | SEG(2) | SEG(3) | SEG(4) | SEG(5) | SEG(15);
+	case 'H': return SEG(1) | SEG(2) | SEG(4) | SEG(5) | MIDDLE;
+	case 'I': return SEG(0) | SEG(3) | SEG(8) | SEG(11);
+	case 'K': return SEG(4) | SEG(5) | SEG(6) | SEG(9) | SEG(12);
+	case 'L': return SEG(3) | SEG(4) | SEG(5);
+	case 'M': return SEG(1) | SEG(2) | SEG(4) | SEG(5) | SEG(7) | SEG(9);
+	case 'N': return SEG(1) | SEG(2) | SEG(4) | SEG(5) | SEG(7) | SEG(12);
+	case 'O': return SEG(0) | SEG(1) | SEG(2) | SEG(3) | SEG(4) | SEG(5);
+	case 'P': return SEG(0) | SEG(1) | SEG(4) | SEG(5) | MIDDLE;
+	case 'Q': return SEG(0) | SEG(1) | SEG(2) | SEG(3) | SEG(4) | SEG(5) | SEG(12);
+	case 'R': return SEG(0) | SEG(1) | SEG(4) | SEG(5) | MIDDLE | SEG(12);
+	case 'S': return SEG(0) | SEG(5) | MIDDLE | SEG(2) | SEG(3);
+	case 'T': return SEG(0) | SEG(8) | SEG(11);
+	case 'U': return SEG(1) | SEG(2) | SEG(3) | SEG(4) | SEG(5);
+	case 'V': return SEG(4) | SEG(5) | SEG(9) | SEG(10);
+	case 'W': return SEG(1) | SEG(2) | SEG(4) | SEG(5) | SEG(10) | SEG(12);
+	case 'X': return SEG(7) | SEG(9) | SEG(10) | SEG(12);
+	case 'Y': return SEG(7) | SEG(9) | SEG(11);
+	case 'Z': return SEG(0) | SEG(3) | SEG(9) | SEG(10);
+	case '.': return SEG(13);
+	case '-': return MIDDLE;
+	default: return 0;
+	}
+}
+
+TextOverlay::TextOverlay()
+{
+	charWidth = 0.018f;
+	charHeight = 0.022f;
+
+	//Generate VAO
+	glGenVertexArrays(1, &this->VAO);
+	glBindVertexArray(this->VAO);
+
+	//Generate and configure VBO, the same layout as a Mesh
+	glGenBuffers(1, &this->VBO);
+	glBindBuffer(GL_ARRAY_BUFFER, this->VBO);
+
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(struct Vertex), (void*)0);
+	glEnableVertexAttribArray(1);
+	glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(struct Vertex), (void*)12);
+}
+
+TextOverlay::~TextOverlay()
+{
+	glDeleteVertexArrays(1, &this->VAO);
+	glDeleteBuffers(1, &this->VBO);
+}
+
+void TextOverlay::SetText(const std::vector<std::string> &lines, float x, float y, glm::vec4 color)
+{
+	vertices.clear();
+
+	//Cells leave a gap between characters and between lines
+	float advance = charWidth * 1.5f;
+	float lineHeight = charHeight * 1.6f;
+
+	for (size_t line = 0; line < lines.size(); line++)
+	{
+		//Bottom of this line's characters
+		float baseY = y - lineHeight * line - charHeight;
+
+		for (size_t i = 0; i < lines[line].size(); i++)
+		{
+			float baseX = x + advance * i;
+			int lit = SegmentsOf((char)toupper(lines[line][i]));
+
+			for (int s = 0; s < 16; s++)
+			{
+				if (!(lit & SEG(s))) continue;
+
+				struct Vertex start = { baseX + segments[s][0] * charWidth, baseY + segments[s][1] * charHeight * 0.5f, 0.0f, color.r, color.g, color.b, color.a };
+				struct Vertex end = { baseX + segments[s][2] * charWidth, baseY + segments[s][3] * charHeight * 0.5f, 0.0f, color.r, color.g, color.b, color.a };
+				vertices.push_back(start);
+				vertices.push_back(end);
+			}
+		}
+	}
+
+	glBindBuffer(GL_ARRAY_BUFFER, this->VBO);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(struct Vertex) * vertices.size(), vertices.data(), GL_STREAM_DRAW);
+}
+
+void TextOverlay::Draw(GLuint uniMVP, GLuint uniHue)
+{
+	if (vertices.empty()) return;
+
+	//The text is already in normalized device coordinates and keeps its own color
+	glm::mat4 identity(1.0f);
+	glUniformMatrix4fv(uniMVP, 1, GL_FALSE, glm::value_ptr(identity));
+	glUniformMatrix4fv(uniHue, 1, GL_FALSE, glm::value_ptr(identity));
+
+	//Always draw on top of the scene
+	glDisable(GL_DEPTH_TEST);
+
+	glBindVertexArray(this->VAO);
+	glDrawArrays(GL_LINES, 0, (GLsizei)vertices.size());
+
+	glEnable(GL_DEPTH_TEST);
+}
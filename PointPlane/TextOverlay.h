@@ -0,0 +1,69 @@
+/*
+Title: Point - Plane
+File Name: TextOverlay.h
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+A minimal text overlay drawn on top of the scene. Characters are built from
+the line segments of a fourteen segment display, like the ones found on
+alarm clocks, so no font texture is needed. Every line of text is packed into
+one vertex buffer and drawn with a single draw call.
+*/
+
+#ifndef _TEXT_OVERLAY_H
+#define _TEXT_OVERLAY_H
+
+#include "GLIncludes.h"
+
+struct TextOverlay
+{
+	GLuint VBO;
+	GLuint VAO;
+	std::vector<struct Vertex> vertices;
+
+	//Size of one character in normalized device coordinates
+	float charWidth;
+	float charHeight;
+
+	TextOverlay();
+	~TextOverlay();
+
+	///
+	//Rebuilds the vertex buffer to show the given lines of text.
+	//Supports digits, capital letters, spaces, '.' and '-'.
+	//
+	//Parameters:
+	//	lines: The lines of text, drawn top to bottom
+	//	x: Left edge of the text in normalized device coordinates
+	//	y: Top edge of the text in normalized device coordinates
+	//	color: The color of the text
+	void SetText(const std::vector<std::string> &lines, float x, float y, glm::vec4 color);
+
+	///
+	//Draws the text over whatever has been drawn so far
+	//
+	//Parameters:
+	//	uniMVP: Location of the MVP uniform of the bound program
+	//	uniHue: Location of the hue uniform of the bound program
+	void Draw(GLuint uniMVP, GLuint uniHue);
+};
+
+#endif //_TEXT_OVERLAY_H
@@ -0,0 +1,200 @@
+/*
+Title: Point - Plane
+File Name: ThreadPool.cpp
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+A fixed set of worker threads which split loops between them, stealing queued work from each other.
+*/
+
+#include "ThreadPool.h"
+#include "Telemetry.h"
+#include <algorithm>
+
+//The pool and queue of the calling thread, if it is a worker
+static thread_local const ThreadPool* currentPool = nullptr;
+static thread_local int currentQueue = 0;
+
+ThreadPool::ThreadPool(int numThreads)
+{
+	stopping = false;
+	numQueued = 0;
+	numSteals = 0;
+
+	if (numThreads <= 0)
+		numThreads = std::max((int)std::thread::hardware_concurrency(), 1);
+
+	//Create every queue before starting the workers, since any of them may steal from any queue
+	for (int i = 0; i < numThreads; i++)
+		queues.push_back(new WorkQueue());
+
+	for (int i = 1; i < numThreads; i++)
+		workers.push_back(std::thread(&ThreadPool::WorkerLoop, this, i));
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	wake.notify_all();
+
+	for (size_t i = 0; i < workers.size(); i++)
+		workers[i].join();
+
+	for (size_t i = 0; i < queues.size(); i++)
+		delete queues[i];
+}
+
+int ThreadPool::CurrentQueue() const
+{
+	return currentPool == this ? currentQueue : 0;
+}
+
+void ThreadPool::Push(int queue, std::function<void()> task)
+{
+	{
+		std::lock_guard<std::mutex> lock(queues[queue]->mutex);
+		queues[queue]->tasks.push_back(std::move(task));
+	}
+	numQueued++;
+
+	//Take the lock so a thread about to sleep can't miss the notification
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+	}
+	wake.notify_one();
+
+	//Threads waiting in other loops may pick up this work too
+	progress.notify_all();
+}
+
+bool ThreadPool::RunOne(int queue)
+{
+	if (numQueued == 0) return false;
+
+	std::function<void()> task;
+	int numQueues = (int)queues.size();
+
+	//Our own newest task first, then the oldest task of each other queue in turn
+	for (int i = 0; i < numQueues && !task; i++)
+	{
+		WorkQueue* victim = queues[(queue + i) % numQueues];
+		std::lock_guard<std::mutex> lock(victim->mutex);
+		if (victim->tasks.empty()) continue;
+
+		if (i == 0)
+		{
+			task = std::move(victim->tasks.back());
+			victim->tasks.pop_back();
+		}
+		else
+		{
+			task = std::move(victim->tasks.front());
+			victim->tasks.pop_front();
+			numSteals++;
+		}
+	}
+
+	if (!task) return false;
+
+	numQueued--;
+	task();
+	return true;
+}
+
+void ThreadPool::WorkerLoop(int queue)
+{
+	currentPool = this;
+	currentQueue = queue;
+
+	for (;;)
+	{
+		if (RunOne(queue)) continue;
+
+		std::unique_lock<std::mutex> lock(mutex);
+		wake.wait(lock, [this]() { return stopping || numQueued > 0; });
+		if (stopping && numQueued == 0) return;
+	}
+}
+
+void ThreadPool::ParallelFor(int count, const std::function<void(int)> &body)
+{
+	if (count <= 0) return;
+
+	std::atomic<int> next(0);
+	int numHelpers = std::min((int)workers.size(), count - 1);
+	std::atomic<int> helpersLeft(numHelpers);
+
+	std::function<void()> work = [&]()
+	{
+		for (int i = next++; i < count; i = next++)
+			body(i);
+	};
+
+	//Inside a worker the helpers go on its own queue, for idle threads to steal.
+	//Outside the pool they are dealt out to the workers' queues.
+	int queue = CurrentQueue();
+	for (int i = 0; i < numHelpers; i++)
+	{
+		Push(queue != 0 ? queue : 1 + i % (int)workers.size(), [&]()
+		{
+			work();
+
+			//Take the lock so the waiting thread can't miss the notification
+			std::lock_guard<std::mutex> done(mutex);
+			helpersLeft--;
+			progress.notify_all();
+		});
+	}
+	telemetry->taskQueueDepth.store(numQueued, std::memory_order_relaxed);
+
+	work();
+
+	//Run other queued tasks while waiting, so a nested loop can't starve
+	while (helpersLeft > 0)
+	{
+		if (RunOne(queue)) continue;
+
+		std::unique_lock<std::mutex> lock(mutex);
+		progress.wait(lock, [&]() { return helpersLeft == 0 || numQueued > 0; });
+	}
+	telemetry->taskQueueDepth.store(numQueued, std::memory_order_relaxed);
+}
+
+void ParallelRanges(ThreadPool* pool, int count, int grain, const std::function<void(int, int)> &body)
+{
+	grain = std::max(grain, 1);
+	int numRanges = (count + grain - 1) / grain;
+
+	if (pool == nullptr || numRanges <= 1)
+	{
+		if (count > 0) body(0, count);
+		return;
+	}
+
+	pool->ParallelFor(numRanges, [&](int range)
+	{
+		int begin = range * grain;
+		body(begin, std::min(begin + grain, count));
+	});
+}
@@ -0,0 +1,135 @@
+/*
+Title: Point - Plane
+File Name: ThreadPool.h
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+A fixed set of worker threads which split loops between them.
+
+ParallelFor hands out loop indices one at a time from a shared counter, so
+uneven iterations balance themselves. The calling thread works on the loop
+too, and while it waits for the workers to finish it runs any other queued
+work, so a ParallelFor may be started from inside another one.
+
+Every worker has its own queue of tasks. A loop started on a worker queues its
+helper tasks there, and the worker takes back its newest task first, so nested
+loops stay on the thread whose caches already hold their data. A thread with an
+empty queue steals the oldest task of another thread, which is the biggest piece
+of work left, so one busy loop never leaves the other threads idle.
+*/
+
+#ifndef _THREAD_POOL_H
+#define _THREAD_POOL_H
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+#include <deque>
+#include <vector>
+
+struct ThreadPool
+{
+	//The tasks queued by one thread
+	struct WorkQueue
+	{
+		std::mutex mutex;
+		std::deque<std::function<void()>> tasks;
+	};
+
+	std::vector<std::thread> workers;
+
+	//queues[0] is shared by threads outside the pool, queues[i] belongs to workers[i - 1]
+	std::vector<WorkQueue*> queues;
+
+	//Number of tasks in all queues
+	std::atomic<int> numQueued;
+
+	//Number of tasks taken from another thread's queue
+	std::atomic<long long> numSteals;
+
+	//Guards sleeping, so a thread can't miss a notification
+	std::mutex mutex;
+
+	//Signaled when a task is queued or the pool is stopping
+	std::condition_variable wake;
+
+	//Signaled when a task finishes or is queued, for threads waiting in ParallelFor
+	std::condition_variable progress;
+
+	bool stopping;
+
+	///
+	//Starts the worker threads
+	//
+	//Parameters:
+	//	numThreads: Threads working on each loop, counting the calling thread.
+	//		0 uses one per hardware thread.
+	ThreadPool(int numThreads);
+
+	///
+	//Finishes any queued work and joins the worker threads
+	~ThreadPool();
+
+	///
+	//Returns the number of threads working on each loop, counting the calling thread
+	int NumThreads() const
+	{
+		return (int)workers.size() + 1;
+	}
+
+	///
+	//Calls body(i) for every i in [0, count) across the pool and waits for all of them
+	//
+	//Parameters:
+	//	count: The number of iterations
+	//	body: The loop body. Iterations may run in any order and on any thread.
+	void ParallelFor(int count, const std::function<void(int)> &body);
+
+private:
+	//Runs tasks until the pool stops
+	void WorkerLoop(int queue);
+
+	//Returns the queue of the calling thread
+	int CurrentQueue() const;
+
+	//Adds a task to a queue and wakes the threads which could run it
+	void Push(int queue, std::function<void()> task);
+
+	//Runs the newest task of the given queue, or else steals the oldest task of another queue
+	//
+	//Returns:
+	//	true if a task was run, false if every queue was empty
+	bool RunOne(int queue);
+};
+
+///
+//Calls body(begin, end) for consecutive ranges covering [0, count), across a pool if one is given
+//
+//Parameters:
+//	pool: The pool to run on, or nullptr to run on the calling thread
+//	count: The number of items
+//	grain: The most items handed to one call
+//	body: Processes the items in [begin, end)
+void ParallelRanges(ThreadPool* pool, int count, int grain, const std::function<void(int, int)> &body);
+
+#endif //_THREAD_POOL_H
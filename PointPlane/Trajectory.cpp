@@ -0,0 +1,168 @@
+/*
+Title: Point - Plane
+File Name: Trajectory.cpp
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+Finding where logged trajectories cross planes.
+*/
+
+#include "Trajectory.h"
+#include <random>
+
+//Adds a crossing where the signed distance passes edge between two samples
+static void AddCrossing(const Trajectory &path, const float* dist, int segment, float edge, signed char from, signed char to,
+	int trajectoryIndex, int planeIndex, std::vector<TrajectoryCrossing> &crossings)
+{
+	int a = segment, b = segment + 1;
+
+	//Finite planes can also change side at their border, where the distance doesn't pass an edge
+	float f = dist[b] != dist[a] ? (edge - dist[a]) / (dist[b] - dist[a]) : 1.0f;
+	f = std::min(std::max(f, 0.0f), 1.0f);
+
+	TrajectoryCrossing crossing;
+	crossing.trajectory = trajectoryIndex;
+	crossing.plane = planeIndex;
+	crossing.segment = segment;
+	crossing.time = path.time[a] + (path.time[b] - path.time[a]) * f;
+	crossing.position = glm::mix(glm::vec3(path.x[a], path.y[a], path.z[a]), glm::vec3(path.x[b], path.y[b], path.z[b]), f);
+	crossing.from = from;
+	crossing.to = to;
+	crossings.push_back(crossing);
+}
+
+//Returns true if a segment whose ends are on opposite sides of the plane meets it within its bounds
+static bool PassesThrough(const WorldPlane &plane, const Trajectory &path, const float* dist, int segment)
+{
+	if (plane.halfExtent <= 0.0f) return true;
+
+	int a = segment, b = segment + 1;
+	float f = dist[a] / (dist[a] - dist[b]);
+	glm::vec3 p = glm::mix(glm::vec3(path.x[a], path.y[a], path.z[a]), glm::vec3(path.x[b], path.y[b], path.z[b]), f) - plane.center;
+	return fabs(glm::dot(plane.tangent, p)) <= plane.halfExtent && fabs(glm::dot(plane.bitangent, p)) <= plane.halfExtent;
+}
+
+int FindCrossings(const WorldPlane &plane, const Trajectory &path, float acceptanceRange, int trajectoryIndex, int planeIndex, std::vector<TrajectoryCrossing> &crossings)
+{
+	int count = (int)path.Size();
+	if (count < 2) return 0;
+
+	//Both passes run straight through the sample arrays
+	std::vector<signed char> sides(count);
+	std::vector<float> dist(count);
+	ClassifyPoints(plane, path.x.data(), path.y.data(), path.z.data(), count, acceptanceRange, sides.data());
+
+	float nx = plane.normal.x, ny = plane.normal.y, nz = plane.normal.z;
+	float d = plane.distance;
+	const float* x = path.x.data();
+	const float* y = path.y.data();
+	const float* z = path.z.data();
+	for (int i = 0; i < count; i++)
+		dist[i] = nx * x[i] + ny * y[i] + nz * z[i] - d;
+
+	float range = FLT_EPSILON + acceptanceRange;
+	size_t numBefore = crossings.size();
+
+	for (int i = 0; i + 1 < count; i++)
+	{
+		signed char from = sides[i], to = sides[i + 1];
+		if (from == to) continue;
+
+		if (from != SIDE_ON && to != SIDE_ON && !PassesThrough(plane, path, dist.data(), i))
+		{
+			//Went past the border of a finite plane, so it changed side without touching it
+			AddCrossing(path, dist.data(), i, 0.0f, from, to, trajectoryIndex, planeIndex, crossings);
+		}
+		else if (from != SIDE_ON && to != SIDE_ON)
+		{
+			//Jumped over the range, so it was entered and left within the segment
+			float entry = from == SIDE_BEHIND ? -range : range;
+			AddCrossing(path, dist.data(), i, entry, from, SIDE_ON, trajectoryIndex, planeIndex, crossings);
+			AddCrossing(path, dist.data(), i, -entry, SIDE_ON, to, trajectoryIndex, planeIndex, crossings);
+		}
+		else
+		{
+			signed char outside = from == SIDE_ON ? to : from;
+			float edge = outside == SIDE_BEHIND ? -range : range;
+			AddCrossing(path, dist.data(), i, edge, from, to, trajectoryIndex, planeIndex, crossings);
+		}
+	}
+
+	return (int)(crossings.size() - numBefore);
+}
+
+long long FindAllCrossings(const std::vector<WorldPlane> &planes, const std::vector<Trajectory> &paths, float acceptanceRange, std::vector<TrajectoryCrossing> &crossings, ThreadPool* pool)
+{
+	int numPaths = (int)paths.size();
+
+	//Each trajectory gets its own list so threads never share one, and the
+	//lists are joined in trajectory order so the result doesn't depend on timing
+	std::vector<std::vector<TrajectoryCrossing>> found(numPaths);
+	std::function<void(int)> findPath = [&](int i)
+	{
+		for (size_t j = 0; j < planes.size(); j++)
+			FindCrossings(planes[j], paths[i], acceptanceRange, i, (int)j, found[i]);
+	};
+
+	if (pool)
+		pool->ParallelFor(numPaths, findPath);
+	else
+	{
+		for (int i = 0; i < numPaths; i++)
+			findPath(i);
+	}
+
+	crossings.clear();
+	for (int i = 0; i < numPaths; i++)
+		crossings.insert(crossings.end(), found[i].begin(), found[i].end());
+
+	return (long long)crossings.size();
+}
+
+void GenerateTrajectories(int count, int samples, float extent, float dt, unsigned int seed, std::vector<Trajectory> &paths)
+{
+	std::mt19937 rng(seed);
+	std::uniform_real_distribution<float> position(-extent, extent);
+	std::normal_distribution<float> turn(0.0f, 1.0f);
+
+	paths.resize(count);
+	for (int i = 0; i < count; i++)
+	{
+		Trajectory &path = paths[i];
+		path.Resize(samples);
+
+		glm::vec3 p(position(rng), position(rng), position(rng));
+		glm::vec3 v(turn(rng), turn(rng), turn(rng));
+		v *= 0.1f * extent;
+
+		for (int j = 0; j < samples; j++)
+		{
+			path.x[j] = p.x;
+			path.y[j] = p.y;
+			path.z[j] = p.z;
+			path.time[j] = j * dt;
+
+			//Wander a little each sample
+			v += glm::vec3(turn(rng), turn(rng), turn(rng)) * (0.5f * extent * dt);
+			p += v * dt;
+		}
+	}
+}
@@ -0,0 +1,117 @@
+/*
+Title: Point - Plane
+File Name: Trajectory.h
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+Finding where logged trajectories cross planes.
+
+A trajectory is a polyline of timestamped samples. Every sample is first
+classified against the plane in one pass over the sample arrays, exactly as
+ClassifyPoints classifies points, and its signed distance is kept alongside.
+A second pass looks for neighbouring samples on different sides. Each change
+is reported at the moment the polyline passes the edge of the acceptance
+range, found by interpolating the signed distance along the segment. A
+segment which jumps from behind the plane to in front of it without a sample
+inside the range reports both the entry and the exit.
+
+Trajectories are independent, so many of them are split between threads.
+*/
+
+#ifndef _TRAJECTORY_H
+#define _TRAJECTORY_H
+
+#include "Collision.h"
+#include "ThreadPool.h"
+
+//Samples of one object's path, in increasing time order
+struct Trajectory
+{
+	std::vector<float> x, y, z;
+	std::vector<float> time;
+
+	size_t Size() const
+	{
+		return x.size();
+	}
+
+	void Resize(size_t count)
+	{
+		x.resize(count);
+		y.resize(count);
+		z.resize(count);
+		time.resize(count);
+	}
+};
+
+//A trajectory moving from one side of a plane to another
+struct TrajectoryCrossing
+{
+	int trajectory;
+	int plane;
+	int segment;			//The crossing lies between samples segment and segment + 1
+	float time;				//Interpolated time of the crossing
+	glm::vec3 position;		//Interpolated position of the crossing
+	signed char from;		//The PlaneSide before the crossing
+	signed char to;			//The PlaneSide after the crossing
+};
+
+///
+//Finds every crossing of one trajectory with one plane
+//
+//Parameters:
+//	plane: The plane to test
+//	path: The trajectory to test
+//	acceptanceRange: Points this close to the plane are considered colliding
+//	trajectoryIndex, planeIndex: Written into the crossings found
+//	crossings: The crossings found are added to it, in time order
+//
+//Returns:
+//	The number of crossings found
+int FindCrossings(const WorldPlane &plane, const Trajectory &path, float acceptanceRange, int trajectoryIndex, int planeIndex, std::vector<TrajectoryCrossing> &crossings);
+
+///
+//Finds every crossing of many trajectories with many planes
+//
+//Parameters:
+//	planes: The planes to test
+//	paths: The trajectories to test
+//	acceptanceRange: Points this close to a plane are considered colliding
+//	crossings: Filled with the crossings found, by trajectory and then by plane
+//	pool: Threads to split the trajectories between, or nullptr to run on the calling thread
+//
+//Returns:
+//	The number of crossings found
+long long FindAllCrossings(const std::vector<WorldPlane> &planes, const std::vector<Trajectory> &paths, float acceptanceRange, std::vector<TrajectoryCrossing> &crossings, ThreadPool* pool);
+
+///
+//Generates random walks through a scene
+//
+//Parameters:
+//	count: Number of trajectories
+//	samples: Samples in each trajectory
+//	extent: Trajectories start within [-extent, extent] on each axis
+//	dt: Time between samples
+//	seed: Seed for the random walks
+//	paths: Filled with the trajectories
+void GenerateTrajectories(int count, int samples, float extent, float dt, unsigned int seed, std::vector<Trajectory> &paths);
+
+#endif //_TRAJECTORY_H
@@ -0,0 +1,325 @@
+/*
+Title: Point - Plane
+File Name: World.cpp
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+One independent copy of the simulation, which can be stepped on any thread.
+*/
+
+#include "World.h"
+#include "Telemetry.h"
+#include <chrono>
+#include <cstring>
+
+//Steps longer than this are clamped in the histogram
+static const long long longestStepTime = 10000000000LL;
+
+void WorldStats::Record(long long nanoseconds)
+{
+	//Sub buckets of 64 keep every step time within about 3%, in under 8KB
+	if (stepTimes == nullptr)
+		stepTimes = new HdrHistogram(longestStepTime, 6);
+
+	stepTimes->Record(nanoseconds);
+	numSteps++;
+	totalTime += nanoseconds;
+	maxTime = std::max(maxTime, nanoseconds);
+}
+
+World::World()
+{
+	movementSpeed = 0.02f;
+	rotationSpeed = 0.01f;
+	scene = nullptr;
+	sceneCollisions = 0;
+	pairsSkipped = 0;
+	warmStart = true;
+	pairsReused = 0;
+	Reset();
+}
+
+World::~World()
+{
+	delete scene;
+}
+
+void World::Reset()
+{
+	for (int i = 0; i < NUM_BODIES; i++)
+	{
+		CollisionFilter filter = bodies[i].filter;
+		bodies[i] = Body();
+		bodies[i].filter = filter;
+	}
+
+	//Start the plane and the point on either side of the origin
+	bodies[BODY_PLANE].translation = glm::translate(glm::mat4(1.0f), glm::vec3(0.15f, 0.0f, 0.0f));
+	bodies[BODY_POINT].translation = glm::translate(glm::mat4(1.0f), glm::vec3(-0.15f, 0.0f, 0.0f));
+	selectedBody = BODY_PLANE;
+
+	//The plane mesh lies in the YZ plane, so its normal is the X axis
+	planeCollider = Plane(glm::vec3(1.0f, 0.0f, 0.0f));
+	colliding = false;
+
+	isMousePressed = false;
+	prevMouseX = 0.0;
+	prevMouseY = 0.0;
+
+	//The bodies' versions start again, so nothing cached matches them any more
+	InvalidatePairs();
+}
+
+void World::InvalidatePairs()
+{
+	pairCache.Clear();
+	lastPlanes.clear();
+	planeClassified.clear();
+}
+
+void World::ProcessKey(int key, int action)
+{
+	if (action != GLFW_PRESS && action != GLFW_REPEAT) return;
+
+	//This selects the active shape
+	if (key == GLFW_KEY_SPACE)
+		selectedBody = selectedBody == BODY_PLANE ? BODY_POINT : BODY_PLANE;
+
+	//This set of controls are used to move the selected shape.
+	Body &selected = bodies[selectedBody];
+	glm::mat4 previous = selected.translation;
+	if (key == GLFW_KEY_W)
+		selected.translation = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, movementSpeed, 0.0f)) * selected.translation;
+	if (key == GLFW_KEY_A)
+		selected.translation = glm::translate(glm::mat4(1.0f), glm::vec3(-movementSpeed, 0.0f, 0.0f)) * selected.translation;
+	if (key == GLFW_KEY_S)
+		selected.translation = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, -movementSpeed, 0.0f)) * selected.translation;
+	if (key == GLFW_KEY_D)
+		selected.translation = glm::translate(glm::mat4(1.0f), glm::vec3(movementSpeed, 0.0f, 0.0f)) * selected.translation;
+	if (key == GLFW_KEY_LEFT_CONTROL)
+		selected.translation = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, movementSpeed)) * selected.translation;
+	if (key == GLFW_KEY_LEFT_SHIFT)
+		selected.translation = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, -movementSpeed)) * selected.translation;
+	if (selected.translation != previous) selected.version++;
+}
+
+void World::ProcessMouseButton(int button, int action, double x, double y)
+{
+	//Set the boolean indicating whether or not the mouse is pressed
+	isMousePressed = button == GLFW_MOUSE_BUTTON_LEFT && action == GLFW_PRESS;
+
+	//Update the previous mouse position
+	prevMouseX = x;
+	prevMouseY = y;
+}
+
+void World::Update(double cursorX, double cursorY)
+{
+	//Check if the mouse button is being pressed
+	if (isMousePressed)
+	{
+		//Get the difference in mouse position from last frame
+		float deltaMouseX = (float)(cursorX - prevMouseX);
+		float deltaMouseY = (float)(cursorY - prevMouseY);
+
+		glm::mat4 yaw;
+		glm::mat4 pitch;
+
+		//Rotate the selected shape by an angle equal to the mouse movement
+		if (deltaMouseX != 0.0f)
+			yaw = glm::rotate(glm::mat4(1.0f), deltaMouseX * rotationSpeed, glm::vec3(0.0f, 1.0f, 0.0f));
+		if (deltaMouseY != 0.0f)
+			pitch = glm::rotate(glm::mat4(1.0f), deltaMouseY * rotationSpeed, glm::vec3(1.0f, 0.0f, 0.0f));
+
+		bodies[selectedBody].rotation = yaw * pitch * bodies[selectedBody].rotation;
+		bodies[selectedBody].version++;
+
+		//Update previous positions
+		prevMouseX = cursorX;
+		prevMouseY = cursorY;
+	}
+
+	//A single check of the layers, before the pair is tested at all
+	if (!bodies[BODY_PLANE].filter.Interacts(bodies[BODY_POINT].filter))
+	{
+		colliding = false;
+		pairsSkipped++;
+		telemetry->pairsSkipped.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+
+	//Neither body has moved since the last test, so its answer still holds
+	PairContact* cached = pairCache.Find(BODY_PLANE, BODY_POINT);
+	if (warmStart && cached != nullptr && cached->versions[0] == bodies[BODY_PLANE].version && cached->versions[1] == bodies[BODY_POINT].version)
+	{
+		cached->lastStep = pairCache.step;
+		colliding = cached->side == SIDE_ON;
+		pairsReused++;
+		return;
+	}
+
+	const glm::mat4 &pointTranslation = bodies[BODY_POINT].translation;
+	glm::vec3 point(pointTranslation[3][0], pointTranslation[3][1], pointTranslation[3][2]);
+	glm::mat4 modelMatrix = bodies[BODY_PLANE].GetModelMatrix();
+	colliding = TestCollision(planeCollider, modelMatrix, point);
+
+	telemetry->pairTests.fetch_add(1, std::memory_order_relaxed);
+	telemetry->pairCollisions.fetch_add(colliding ? 1 : 0, std::memory_order_relaxed);
+
+	//Remember the result, and where the point touches the plane
+	PairContact &entry = pairCache.Touch(BODY_PLANE, BODY_POINT, nullptr);
+	WorldPlane plane = MakeWorldPlane(planeCollider, modelMatrix);
+	float lengthSquared = glm::dot(plane.normal, plane.normal);
+	entry.distance = glm::dot(plane.normal, point) - plane.distance;
+	entry.side = (signed char)(colliding ? SIDE_ON : entry.distance > 0.0f ? SIDE_FRONT : SIDE_BEHIND);
+	entry.contactPoint = lengthSquared > 0.0f ? point - plane.normal * (entry.distance / lengthSquared) : point;
+	entry.versions[0] = bodies[BODY_PLANE].version;
+	entry.versions[1] = bodies[BODY_POINT].version;
+}
+
+void World::Step(double cursorX, double cursorY, float dt, ThreadPool* pool)
+{
+	std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+
+	pairCache.NextStep();
+	Update(cursorX, cursorY);
+
+	if (scene != nullptr)
+	{
+		StepScene(*scene, dt);
+
+		int numPoints = (int)scene->points.Size();
+		int numPlanes = (int)scene->planes.size();
+		sceneSides.resize((size_t)numPoints * numPlanes);
+		planeCollisions.resize(numPlanes);
+
+		if (lastPlanes.size() != (size_t)numPlanes)
+		{
+			lastPlanes.resize(numPlanes);
+			planeClassified.assign(numPlanes, 0);
+		}
+		bool pointsMoved = scene->motion != MOTION_STATIC;
+
+		//One plane per task, so idle threads can steal the planes of a large scene
+		std::atomic<long long> sceneSkipped(0);
+		std::atomic<long long> sceneReused(0);
+		ParallelRanges(pool, numPlanes, 1, [&](int begin, int end)
+		{
+			long long skipped = 0;
+			long long reused = 0;
+			for (int i = begin; i < end; i++)
+			{
+				//Neither the plane nor the points have moved since the plane was last classified
+				const WorldPlane &plane = scene->planes[i];
+				if (warmStart && !pointsMoved && planeClassified[i] && memcmp(&plane, &lastPlanes[i], sizeof(WorldPlane)) == 0)
+				{
+					reused += numPoints;
+					continue;
+				}
+
+				signed char* sides = sceneSides.data() + (size_t)i * numPoints;
+				planeCollisions[i] = ClassifyFiltered(plane, scene->points, 0, numPoints, pointAcceptanceRange, sides, skipped);
+				lastPlanes[i] = plane;
+				planeClassified[i] = 1;
+			}
+			sceneSkipped += skipped;
+			sceneReused += reused;
+		});
+		pairsSkipped += sceneSkipped;
+		pairsReused += sceneReused;
+
+		sceneCollisions = 0;
+		for (int i = 0; i < numPlanes; i++)
+			sceneCollisions += planeCollisions[i];
+	}
+
+	//Pairs which have stopped touching are let go once they have been apart for a while
+	pairCache.Recycle(pairStaleSteps);
+
+	stats.Record(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::high_resolution_clock::now() - start).count());
+}
+
+void World::CaptureState(SimulationState &state) const
+{
+	state.translations.resize(NUM_BODIES);
+	state.rotations.resize(NUM_BODIES);
+	state.scales.resize(NUM_BODIES);
+	for (int i = 0; i < NUM_BODIES; i++)
+	{
+		state.translations[i] = bodies[i].translation;
+		state.rotations[i] = bodies[i].rotation;
+		state.scales[i] = bodies[i].scale;
+	}
+	state.selectedBody = selectedBody;
+
+	state.colliderNormals.assign(1, planeCollider.normal);
+	state.pairStates.assign(1, colliding ? 1 : 0);
+}
+
+bool World::RestoreState(const SimulationState &state)
+{
+	if (state.translations.size() != NUM_BODIES || state.colliderNormals.size() != 1 || state.pairStates.size() != 1)
+	{
+		std::cout << "The snapshot does not match this scene" << std::endl;
+		return false;
+	}
+
+	for (int i = 0; i < NUM_BODIES; i++)
+	{
+		bodies[i].translation = state.translations[i];
+		bodies[i].rotation = state.rotations[i];
+		bodies[i].scale = state.scales[i];
+	}
+	if (state.selectedBody >= 0 && state.selectedBody < NUM_BODIES)
+		selectedBody = state.selectedBody;
+
+	planeCollider.normal = state.colliderNormals[0];
+	colliding = state.pairStates[0] != 0;
+
+	//The bodies jumped without their versions changing
+	InvalidatePairs();
+	return true;
+}
+
+size_t World::MemoryUsed() const
+{
+	size_t bytes = sizeof(World);
+	bytes += sceneSides.capacity() * sizeof(signed char);
+	bytes += planeCollisions.capacity() * sizeof(long long);
+	bytes += pairCache.MemoryUsed();
+	bytes += lastPlanes.capacity() * sizeof(WorldPlane);
+	bytes += planeClassified.capacity() * sizeof(char);
+
+	if (scene != nullptr)
+	{
+		const PointSet &points = scene->points;
+		bytes += sizeof(Scene);
+		bytes += (points.x.capacity() + points.y.capacity() + points.z.capacity()) * sizeof(float);
+		bytes += (points.vx.capacity() + points.vy.capacity() + points.vz.capacity()) * sizeof(float);
+		bytes += points.filters.capacity() * sizeof(CollisionFilter);
+		bytes += scene->planes.capacity() * sizeof(WorldPlane);
+	}
+
+	if (stats.stepTimes != nullptr)
+		bytes += sizeof(HdrHistogram) + stats.stepTimes->counts.capacity() * sizeof(long long);
+
+	return bytes;
+}
@@ -0,0 +1,240 @@
+/*
+Title: Point - Plane
+File Name: World.h
+Copyright  2015
+Original authors: Nicholas Gallagher
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Description:
+One independent copy of the simulation: the plane and point bodies, which
+one is selected, the plane's collider and whether the two are colliding.
+Nothing here is global, so a process can host as many worlds as it has memory
+for, and each can be stepped on any thread.
+
+A world may also own a generated scene of points and planes which is moved and
+classified every step, splitting the planes over a shared thread pool. Worlds
+without one hold only their transforms and input state, a few hundred bytes,
+and their step time histogram is not allocated until they are first stepped.
+
+What each step finds about a pair of bodies is kept in a pair cache. The
+plane and point pair is only tested again once one of them has moved. A scene
+plane is only classified again once it or the points have moved, and otherwise
+keeps its sides from the last step. Scene pairs are not put in the cache: the
+scene's points all move together, so a pair can't be skipped on its own.
+*/
+
+#ifndef _WORLD_H
+#define _WORLD_H
+
+#include "Scene.h"
+#include "Snapshot.h"
+#include "FrameStats.h"
+#include "ThreadPool.h"
+#include "PairCache.h"
+
+//Steps a cached pair may go untouched before its entry is recycled
+const unsigned int pairStaleSteps = 8;
+
+//The bodies of a world, in the order they are stored in snapshots
+enum WorldBody
+{
+	BODY_PLANE,
+	BODY_POINT,
+	NUM_BODIES
+};
+
+//The transform of a body
+struct Body
+{
+	glm::mat4 translation;
+	glm::mat4 rotation;
+	glm::mat4 scale;
+
+	//Which bodies this one is tested against
+	CollisionFilter filter;
+
+	//Counts the moves of the body, so cached pairs know to test it again
+	unsigned int version;
+
+	glm::mat4 GetModelMatrix() const
+	{
+		return translation * rotation * scale;
+	}
+};
+
+//How long a world's steps took
+struct WorldStats
+{
+	long long numSteps;
+	long long totalTime;	//Nanoseconds
+	long long maxTime;		//Nanoseconds
+
+	//Nanoseconds per step, allocated by the first step
+	HdrHistogram* stepTimes;
+
+	WorldStats()
+	{
+		numSteps = 0;
+		totalTime = 0;
+		maxTime = 0;
+		stepTimes = nullptr;
+	}
+
+	~WorldStats()
+	{
+		delete stepTimes;
+	}
+
+	///
+	//Adds the time of one step
+	void Record(long long nanoseconds);
+
+	double MeanTime() const
+	{
+		return numSteps > 0 ? (double)totalTime / numSteps : 0.0;
+	}
+
+private:
+	WorldStats(const WorldStats &);
+	WorldStats &operator=(const WorldStats &);
+};
+
+struct World
+{
+	Body bodies[NUM_BODIES];
+	int selectedBody;
+
+	struct Plane planeCollider;
+	bool colliding;
+
+	float movementSpeed;
+	float rotationSpeed;
+
+	//Mouse drag state
+	bool isMousePressed;
+	double prevMouseX;
+	double prevMouseY;
+
+	//Points and planes moved and classified every step, or nullptr
+	Scene* scene;
+	std::vector<signed char> sceneSides;
+	std::vector<long long> planeCollisions;
+	long long sceneCollisions;
+
+	//Pairs never tested because their collision layers don't interact, over every step
+	long long pairsSkipped;
+
+	//What was found about each pair of bodies, by their WorldBody handles
+	PairCache pairCache;
+
+	//Whether pairs whose bodies haven't moved reuse their cached result instead of being tested
+	bool warmStart;
+
+	//Pairs whose cached result was reused, over every step
+	long long pairsReused;
+
+	//The scene's planes as of their last classification, and whether each has been classified
+	std::vector<WorldPlane> lastPlanes;
+	std::vector<char> planeClassified;
+
+	WorldStats stats;
+
+	///
+	//Creates a world with the plane and point in their starting positions
+	World();
+
+	///
+	//Deletes the world's scene
+	~World();
+
+	///
+	//Moves the bodies back to their starting positions and releases the mouse.
+	//The bodies keep their collision layers.
+	void Reset();
+
+	///
+	//Forgets every cached pair. Needed after changing the bodies, the plane collider or
+	//the scene's points other than through the world's own functions.
+	void InvalidatePairs();
+
+	///
+	//Applies a key press to the world
+	//
+	//Parameters:
+	//	key: The GLFW key which was pressed
+	//	action: GLFW_PRESS, GLFW_RELEASE or GLFW_REPEAT
+	void ProcessKey(int key, int action);
+
+	///
+	//Applies a mouse click to the world
+	//
+	//Parameters:
+	//	button: The mouse button which was pressed
+	//	action: GLFW_PRESS or GLFW_RELEASE
+	//	x: The cursor x position at the time of the click
+	//	y: The cursor y position at the time of the click
+	void ProcessMouseButton(int button, int action, double x, double y);
+
+	///
+	//Rotates the selected body while the mouse is dragged and tests the point against the plane,
+	//unless their collision layers keep them apart. The cached result is used while neither
+	//body has moved since the last test.
+	//
+	//Parameters:
+	//	cursorX: The cursor x position, only read while the mouse is pressed
+	//	cursorY: The cursor y position, only read while the mouse is pressed
+	void Update(double cursorX, double cursorY);
+
+	///
+	//Updates the world, moves and classifies its scene, and records how long it took
+	//
+	//Parameters:
+	//	cursorX: The cursor x position, only read while the mouse is pressed
+	//	cursorY: The cursor y position, only read while the mouse is pressed
+	//	dt: The time step of the scene
+	//	pool: Splits the scene's planes between threads, or nullptr to classify them on the calling thread
+	void Step(double cursorX, double cursorY, float dt, ThreadPool* pool);
+
+	///
+	//Copies the world into a snapshot. The scene is not included.
+	//
+	//Parameters:
+	//	state: The state to fill
+	void CaptureState(SimulationState &state) const;
+
+	///
+	//Overwrites the world with a snapshot
+	//
+	//Parameters:
+	//	state: The state to restore
+	//
+	//Returns:
+	//	true if the snapshot matches this world and was restored, else false
+	bool RestoreState(const SimulationState &state);
+
+	///
+	//Returns the bytes of memory held by the world, including its scene and statistics
+	size_t MemoryUsed() const;
+
+private:
+	World(const World &);
+	World &operator=(const World &);
+};
+
+#endif //_WORLD_H
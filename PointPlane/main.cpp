@@ -34,6 +34,78 @@ You can also move the shape along the Z axis with left shift and left control. Y
 swap which shape is selected with spacebar. Lastly, you can rotate the objects 
 by clicking the left mouse button and dragging the mouse. 
 
+Running with --record <file> saves every input to a log, and --replay <file>
+feeds a saved log back in on the same frames. Both print per frame timings and a
+hash of the final state so two builds can be compared on an identical workload.
+
+For scaling studies the program can also run without a window:
+	--sweep                  times the collision tests over a range of point and plane counts
+	--generate <file>        writes a generated scene to a binary scene file
+	--scene <file>           times the collision tests on a saved scene
+	--translation-sweep      slides planes through still points, comparing the batch test
+	                         against a sorted projection index
+	--rotation-sweep         spins planes through still points, comparing the batch test
+	                         against projection indices for 81 fixed directions
+	--tree-sweep             moves planes to random orientations every step, comparing
+	                         the batch test against a bounding volume tree over the points
+	--threads N              threads used by the tree sweep, all hardware threads by default
+	--packet-sweep           splits the points into packets of nearby points and tests each
+	                         packet's bounds before its points (--packet-size N, 1024 by default)
+	--event-sweep            drifts points through still planes, comparing testing every frame
+	                         against jumping between predicted crossing times
+	--trajectory-sweep       finds every plane crossing of random walk trajectories, on one
+	                         thread and on --threads threads (--samples N per trajectory, 1000 by default)
+	--shape-sweep            times spheres, boxes, oriented boxes and capsules against the planes
+	                         (--shape sphere, box, obb or capsule times only one of them)
+	--hull-sweep             finds the extreme vertices of convex hulls along a plane normal,
+	                         scanning every vertex against hill climbing from the last answer
+	--nearest-sweep          finds the k points nearest each plane, a full sort against bounded
+	                         heaps on --threads threads (--k N, 100 by default)
+	--numa-sweep             splits the points between the NUMA nodes, in each node's memory with
+	                         threads pinned to its cores, and compares every node against one
+	                         pool of --threads threads
+	--page-sweep             times the points on ordinary, transparent huge and explicit huge pages,
+	                         with the data TLB misses of each
+	--streaming-sweep        compares the cached and streaming classification kernels, and how
+	                         much of the other data in the caches each one pushes out
+	--layer-sweep            splits the points and planes into collision layers (--layers N, 8 by
+	                         default) and compares testing every pair against skipping the pairs
+	                         whose layers don't interact, linearly, in packets and in a point tree
+	--pair-cache-sweep       steps a world which reuses the cached results of pairs that haven't
+	                         moved against one which tests every pair, on --threads threads
+	--kernel <name>          the loop used to classify large batches: cached (the default), or
+	                         streaming, which prefetches the points and writes the sides around the caches
+	--huge-pages <mode>      puts large point, index and result arrays on huge pages: off (the
+	                         default), transparent or explicit, which falls back to transparent
+	--worlds N               steps N independent worlds, each with its own generated scene, on one
+	                         pool of --threads threads and prints every world's step times
+	                         (--frames N, 600 by default, --idle-worlds M adds worlds never stepped)
+	--serve <socket>         answers classification queries from other processes on a UNIX domain
+	                         socket, on --threads threads, until interrupted (Linux only)
+	--query <socket>         sends the generated scenes to a running server in queries of
+	                         --query-points N points (1000 by default) and checks the answers
+	--serve-shm <name>       answers queries written into a named shared memory region, waking
+	                         on futexes, until interrupted (Linux only)
+	--query-shm <name>       the same as --query, through a shared memory server
+Generated scenes are described by --points N, --planes K, --distribution
+(uniform, clustered or nearplane), --motion (static, drift or orbit), --finite,
+--seed S and --layers N, which splits the points into N collision layers.
+
+Frame times of update(), renderScene() and the buffer swap are kept in histograms.
+Their p50/p95/p99/max are shown in the corner of the window (F2 hides them), and
+F3 writes the full histograms to frametimes.hgrm, as does closing the program.
+
+The time from each key press or click until the GPU finishes the first frame showing
+it (input to photon latency) is measured with GL fences and timestamp queries, shown
+on the overlay and summarized on exit. --max-frames-in-flight N keeps the CPU from
+queuing more than N frames ahead of the GPU, which shortens that latency.
+
+--telemetry <name> publishes frame times, collision counts and queue depths in a named
+shared memory block, which PointPlaneStat <name> prints while the program runs.
+
+The simulation can be checkpointed with F5 (or F6 for a compressed snapshot)
+and restored later with F9.
+
 This algorithm tests collisions between a point and a plane by using the
 mathematical definition of a plane. First, we get the normal of the plane in world space.
 Then we must shift both objects such that the plane is at the origin of the coordinate system.
@@ -54,6 +126,16 @@ AABB-2D by Brockton Roth
 */
 
 #include "GLIncludes.h"
+#include "Collision.h"
+#include "Benchmark.h"
+#include "FrameStats.h"
+#include "TextOverlay.h"
+#include "Latency.h"
+#include "Snapshot.h"
+#include "InputLog.h"
+#include "World.h"
+#include "Telemetry.h"
+#include <csignal>
 
 // Global data members
 #pragma region Base_data
@@ -71,32 +153,17 @@ glm::mat4 hue;
 // Reference to the window object being created by GLFW.
 GLFWwindow* window;
 
-struct Vertex
-{
-	float
-		x, y, z,
-		r, g, b, a;
-};
-
 //Struct for rendering
 struct Mesh
 {
 	GLuint VBO;
 	GLuint VAO;
-	glm::mat4 translation;
-	glm::mat4 rotation;
-	glm::mat4 scale;
 	int numVertices;
 	struct Vertex* vertices;
 	GLenum primitive;
 
 	Mesh(int numVert, struct Vertex* vert, GLenum primType)
 	{
-
-		glm::mat4 translation = glm::mat4(1.0f);
-		glm::mat4 rotation = glm::mat4(1.0f);
-		glm::mat4 scale = glm::mat4(1.0f);
-
 		this->numVertices = numVert;
 		this->vertices = new struct Vertex[this->numVertices];
 		memcpy(this->vertices, vert, this->numVertices * sizeof(struct Vertex));
@@ -128,15 +195,10 @@ struct Mesh
 		glDeleteBuffers(1, &this->VBO);
 	}
 
-	glm::mat4 GetModelMatrix()
-	{
-		return translation * rotation * scale;
-	}
-
-	void Draw(void)
+	void Draw(const glm::mat4 &modelMatrix)
 	{
 		//GEnerate the MVP for this model
-		glm::mat4 MVP = VP * this->GetModelMatrix();
+		glm::mat4 MVP = VP * modelMatrix;
 
 		//Bind the VAO being drawn
 		glBindVertexArray(this->VAO);
@@ -150,43 +212,95 @@ struct Mesh
 
 };
 
-//A plane collider struct
-struct Plane
-{
-	glm::vec3 normal;
+struct Mesh* plane;
+struct Mesh* point;
 
-	///
-	//Generates a plane with a normal pointing down the X axis
-	Plane()
-	{
-		normal = glm::vec3(1.0f, 0.0f, 0.0f);
-	}
+//The simulation shown in the window
+struct World* world;
 
-	///
-	//Generates a plane with a given normal
-	Plane(glm::vec3 norm)
-	{
-		normal = norm;
-	}
+float movementSpeed = 0.02f;
+float rotationSpeed = 0.01f;
+
+//File used to checkpoint and restore the simulation
+std::string snapshotFile = "snapshot.bin";
+
+//Frame time histograms and the overlay showing them
+FrameStats frameStats;
+struct TextOverlay* overlay;
+bool showOverlay = true;
+std::string histogramFile = "frametimes.hgrm";
+
+//Input to photon latency measurement
+LatencyTracker latencyTracker;
+
+//Input recording and replay
+enum InputMode
+{
+	INPUT_LIVE,
+	INPUT_RECORD,
+	INPUT_REPLAY
 };
+InputMode inputMode = INPUT_LIVE;
+std::string inputLogFile;
+InputLog inputLog;
+FrameTimings frameTimings;
 
-struct Mesh* plane;
-struct Mesh* point;
+//The frame whose update() runs next
+unsigned int currentFrame = 0;
+double recordStartTime = 0.0;
 
-struct Mesh* selectedShape;
+//Cursor position fed in by a replay, or the last one logged while recording
+double replayCursorX = 0.0;
+double replayCursorY = 0.0;
 
-struct Plane* planeCollider;
+//The query server being run, so an interrupt can stop it
+struct QueryServer* activeServer = nullptr;
+struct SharedQueryServer* activeSharedServer = nullptr;
 
-float movementSpeed = 0.02f;
-float rotationSpeed = 0.01f;
+//Headless benchmark chosen on the command line
+enum HeadlessSweep
+{
+	SWEEP_NONE,
+	SWEEP_SCALING,
+	SWEEP_TRANSLATION,
+	SWEEP_ROTATION,
+	SWEEP_TREE,
+	SWEEP_PACKET,
+	SWEEP_EVENT,
+	SWEEP_TRAJECTORY,
+	SWEEP_SHAPE,
+	SWEEP_HULL,
+	SWEEP_NEAREST,
+	SWEEP_NUMA,
+	SWEEP_PAGE,
+	SWEEP_STREAMING,
+	SWEEP_LAYER,
+	SWEEP_PAIR_CACHE
+};
 
-bool isMousePressed = false;
-double prevMouseX = 0.0f;
-double prevMouseY = 0.0f;
+//How a command line option reads its value
+enum OptionType
+{
+	OPTION_FLAG,		//Takes no value and sets a bool
+	OPTION_INT,			//Reads the next argument into an int
+	OPTION_STRING,		//Reads the next argument into a std::string
+	OPTION_STRING_LIST,	//Appends the next argument to a std::vector<std::string>, so it can be repeated
+	OPTION_CHOICE		//Takes no value and stores the option's choice in an int
+};
+
+//A command line option and the variable it sets
+struct CommandOption
+{
+	const char* name;
+	OptionType type;
+	void* value;
+	int choice;
+};
 
 //Out of order Function declarations
 void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods);
 void mouse_callback(GLFWwindow* window, int button, int action, int mods);
+void cursor_callback(GLFWwindow* window, double x, double y);
 
 #pragma endregion Base_data								  
 
@@ -275,6 +389,7 @@ void init()
 	//Set glfw event callbacks to handle input
 	glfwSetMouseButtonCallback(window, mouse_callback);
 	glfwSetKeyCallback(window, key_callback);
+	glfwSetCursorPosCallback(window, cursor_callback);
 
 	glPointSize(3.0f);
 
@@ -286,95 +401,43 @@ void init()
 #pragma region util_functions
 
 ///
-//Tests for collisions between a point and a plane
-//
-//Overview:
-//	This algorithm tests collisions between a point and a plane by using the
-//	mathematical definition of a plane. First, we get the normal of the plane in world space.
-//	Then we must shift both objects such that the plane is at the origin of the coordinate system.
-//	Finally, we can perform a dot product of the point with the normal. If the dot product is zero
-//	then we have a collision.
+//Gets the cursor position used by the simulation. While recording, changes in
+//the position are logged, and while replaying, the logged position is returned.
 //
 //Parameters:
-//	pCollider: The plane's collider
-//	pModelMatrix: The plane's model to world transformation matrix
-//	point: The point in worldspace
-//
-//Returns:
-//	true if a collision is detected, else false
-bool TestCollision(const Plane &pCollider, const glm::mat4 &pModelMatrix, glm::vec3 point)
+//	x: Filled with the cursor x position
+//	y: Filled with the cursor y position
+void GetCursor(double* x, double* y)
 {
-	//Points represent ifinitesimal volumes and are supposed to indicate exact positions instead.
-	//Therefore, because a point would theoretically have no volume (or the smallest measurable amount)
-	//it is very difficult for a point to exactly intersect a plane (which is infinitely thin).
-	//
-	//The point being drawn on the screen is a much larger representation of the point which actually exists in that space.
-	//To make the representation of the point accurately display the intersection of the point
-	//and the plane, we must accept all non-collisions within a certain range.
-	//This range we will call our acceptance range. It is a number I made up that makes our representation of a point
-	//appear to be more accurately colliding with our plane. This should be set (Or not set) depending on your application.
-	float acceptanceRange = 0.002f;
-
-	//Step 1: Get the plane normal in world space
-	glm::vec3 worldNormal = glm::vec3(pModelMatrix * glm::vec4(pCollider.normal, 0.0f));
-
-	//Step 2: Translate the plane and the point to a system where the plane is the origin
-	glm::vec3 planePos = glm::vec3(pModelMatrix[3][0], pModelMatrix[3][1], pModelMatrix[3][2]);
-	point -= planePos;
-
-	//Step 3: Take the dot product of the point and the plane normal
-	if (fabs(glm::dot(point, worldNormal)) <= FLT_EPSILON + acceptanceRange) return true;
-
-	return false;
+	if (inputMode == INPUT_REPLAY)
+	{
+		*x = replayCursorX;
+		*y = replayCursorY;
+		return;
+	}
+
+	glfwGetCursorPos(window, x, y);
+
+	if (inputMode == INPUT_RECORD && (*x != replayCursorX || *y != replayCursorY))
+	{
+		inputLog.Record(currentFrame, (float)(glfwGetTime() - recordStartTime), INPUT_CURSOR, 0, 0, *x, *y);
+		replayCursorX = *x;
+		replayCursorY = *y;
+	}
 }
 
 // This runs once every physics timestep.
 void update()
 {
-	//Check if the mouse button is being pressed
-	if (isMousePressed)
-	{
-		//Get the current mouse position
-		double currentMouseX, currentMouseY;
-		glfwGetCursorPos(window, &currentMouseX, &currentMouseY);
-
-		//Get the difference in mouse position from last frame
-		float deltaMouseX = (float)(currentMouseX - prevMouseX);
-		float deltaMouseY = (float)(currentMouseY - prevMouseY);
-
-		glm::mat4 yaw;
-		glm::mat4 pitch;
-
-		//Rotate the selected shape by an angle equal to the mouse movement
-		if (deltaMouseX != 0.0f)
-		{
-			yaw = glm::rotate(glm::mat4(1.0f), deltaMouseX * rotationSpeed, glm::vec3(0.0f, 1.0f, 0.0f));
-			
-		}
-		if (deltaMouseY != 0.0f)
-		{
-			pitch = glm::rotate(glm::mat4(1.0f), deltaMouseY * rotationSpeed, glm::vec3(1.0f, 0.0f, 0.0f));
-			
-		}
-
-		selectedShape->rotation = yaw * pitch * selectedShape->rotation;
+	//The cursor is only read while dragging, so idle frames log nothing
+	double currentMouseX = 0.0, currentMouseY = 0.0;
+	if (world->isMousePressed)
+		GetCursor(&currentMouseX, &currentMouseY);
 
-		//Update previous positions
-		prevMouseX = currentMouseX;
-		prevMouseY = currentMouseY;
+	world->Update(currentMouseX, currentMouseY);
 
-	}
-
-	if (TestCollision(*planeCollider, plane->GetModelMatrix(), glm::vec3(point->translation[3][0], point->translation[3][1], point->translation[3][2])))
-	{
-		//Turn red on
-		hue[0][0] = 1.0f;
-	}
-	else
-	{
-		//Turn red off
-		hue[0][0] = 0.0f;
-	}
+	//Turn red on while the point and plane collide
+	hue[0][0] = world->colliding ? 1.0f : 0.0f;
 }
 
 // This function runs every frame
@@ -393,36 +456,112 @@ void renderScene()
 	glUniformMatrix4fv(uniHue, 1, GL_FALSE, glm::value_ptr(hue));
 
 	// Draw the Gameobjects
-	plane->Draw();
-	point->Draw();
+	telemetry->drawCalls.fetch_add(showOverlay ? 3 : 2, std::memory_order_relaxed);
+	plane->Draw(world->bodies[BODY_PLANE].GetModelMatrix());
+	point->Draw(world->bodies[BODY_POINT].GetModelMatrix());
+
+	// Draw the frame time overlay
+	if (showOverlay)
+		overlay->Draw(uniMVP, uniHue);
 }
 
 
+///
+//Applies a key press to the simulation
+//
+//Parameters:
+//	key: The key which was pressed
+//	action: GLFW_PRESS, GLFW_RELEASE or GLFW_REPEAT
+void ProcessKey(int key, int action)
+{
+	world->ProcessKey(key, action);
+
+	if (action == GLFW_PRESS)
+	{
+		//Checkpoint the simulation, F6 compresses the snapshot
+		if (key == GLFW_KEY_F5 || key == GLFW_KEY_F6)
+		{
+			SimulationState state;
+			world->CaptureState(state);
+			if (SaveSnapshot(state, snapshotFile, key == GLFW_KEY_F6))
+				std::cout << "Saved snapshot to " << snapshotFile << std::endl;
+		}
+
+		//Show or hide the frame time overlay
+		if (key == GLFW_KEY_F2)
+			showOverlay = !showOverlay;
+
+		//Write the frame time histograms
+		if (key == GLFW_KEY_F3 && frameStats.Dump(histogramFile))
+			std::cout << "Wrote frame time histograms to " << histogramFile << std::endl;
+
+		//Restore the last checkpoint
+		if (key == GLFW_KEY_F9)
+		{
+			SimulationState state;
+			if (LoadSnapshot(state, snapshotFile) && world->RestoreState(state))
+				std::cout << "Restored snapshot from " << snapshotFile << std::endl;
+		}
+	}
+
+}
+
+///
+//Applies a mouse click to the simulation
+//
+//Parameters:
+//	button: The mouse button which was pressed
+//	action: GLFW_PRESS or GLFW_RELEASE
+//	x: The cursor x position at the time of the click
+//	y: The cursor y position at the time of the click
+void ProcessMouseButton(int button, int action, double x, double y)
+{
+	world->ProcessMouseButton(button, action, x, y);
+}
+
+///
+//Feeds the recorded events belonging to the current frame into the simulation
+void ReplayInput()
+{
+	const InputEvent* e;
+	while ((e = inputLog.NextEvent(currentFrame)) != nullptr)
+	{
+		//Replayed events are timed like live ones. Cursor events are only logged while dragging.
+		switch (e->type)
+		{
+		case INPUT_KEY:
+			if (e->action == GLFW_PRESS || e->action == GLFW_REPEAT)
+				latencyTracker.OnInput();
+			ProcessKey(e->code, e->action);
+			break;
+		case INPUT_MOUSE_BUTTON:
+			if (e->action == GLFW_PRESS)
+				latencyTracker.OnInput();
+			ProcessMouseButton(e->code, e->action, e->x, e->y);
+			break;
+		case INPUT_CURSOR:
+			latencyTracker.OnInput();
+			replayCursorX = e->x;
+			replayCursorY = e->y;
+			break;
+		}
+	}
+}
+
 // This function is used to handle key inputs.
 // It is a callback funciton. i.e. glfw takes the pointer to this function (via function pointer) and calls this function every time a key is pressed in the during event polling.
 void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods)
 {
+	//Live input is ignored while a recording is replayed
+	if (inputMode == INPUT_REPLAY) return;
+
+	if (inputMode == INPUT_RECORD)
+		inputLog.Record(currentFrame, (float)(glfwGetTime() - recordStartTime), INPUT_KEY, action, key, 0.0, 0.0);
+
 	if (action == GLFW_PRESS || action == GLFW_REPEAT)
-	{
-		//This selects the active shape
-		if (key == GLFW_KEY_SPACE)
-			selectedShape = selectedShape == plane ? point : plane;
-
-		//This set of controls are used to move the selectedShape.
-		if (key == GLFW_KEY_W)
-			selectedShape->translation = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, movementSpeed, 0.0f)) * selectedShape->translation;
-		if (key == GLFW_KEY_A)
-			selectedShape->translation = glm::translate(glm::mat4(1.0f), glm::vec3(-movementSpeed, 0.0f, 0.0f)) * selectedShape->translation;
-		if (key == GLFW_KEY_S)
-			selectedShape->translation = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, -movementSpeed, 0.0f)) * selectedShape->translation;
-		if (key == GLFW_KEY_D)
-			selectedShape->translation = glm::translate(glm::mat4(1.0f), glm::vec3(movementSpeed, 0.0f, 0.0f)) * selectedShape->translation;
-		if (key == GLFW_KEY_LEFT_CONTROL)
-			selectedShape->translation = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, movementSpeed)) * selectedShape->translation;
-		if (key == GLFW_KEY_LEFT_SHIFT)
-			selectedShape->translation = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, -movementSpeed)) * selectedShape->translation;
-	}
+		latencyTracker.OnInput();
 
+	ProcessKey(key, action);
 }
 
 ///
@@ -435,20 +574,359 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
 //	mods: The modifier keys which were pressed during the mouse click event
 void mouse_callback(GLFWwindow* window, int button, int action, int mods)
 {
-	//Set the boolean indicating whether or not the mouse is pressed
-	isMousePressed = button == GLFW_MOUSE_BUTTON_LEFT ?
-		(action == GLFW_PRESS ? true : false)
-		: false;
+	//Live input is ignored while a recording is replayed
+	if (inputMode == INPUT_REPLAY) return;
+
+	double x, y;
+	glfwGetCursorPos(window, &x, &y);
 
-	//Update the previous mouse position
-	glfwGetCursorPos(window, &prevMouseX, &prevMouseY);
+	if (inputMode == INPUT_RECORD)
+		inputLog.Record(currentFrame, (float)(glfwGetTime() - recordStartTime), INPUT_MOUSE_BUTTON, action, button, x, y);
+
+	if (action == GLFW_PRESS)
+		latencyTracker.OnInput();
+
+	ProcessMouseButton(button, action, x, y);
+}
+
+///
+//Callback triggered by the cursor moving. The position itself is read by update(),
+//this only times the input while a drag is rotating the selected shape.
+//
+//Parameters:
+//	window: The window the cursor moved over
+//	x: The new cursor x position
+//	y: The new cursor y position
+void cursor_callback(GLFWwindow* window, double x, double y)
+{
+	//Live input is ignored while a recording is replayed
+	if (inputMode == INPUT_REPLAY) return;
+
+	if (world->isMousePressed)
+		latencyTracker.OnInput();
+}
+
+///
+//Stops the query servers when the program is interrupted
+//
+//Parameters:
+//	signal: The signal which was raised
+void StopServer(int signal)
+{
+	if (activeServer != nullptr)
+		activeServer->stopping = true;
+	if (activeSharedServer != nullptr)
+		activeSharedServer->stopping = true;
+}
+
+///
+//Reads the command line into the variables named by a table of options
+//
+//Parameters:
+//	argc: The number of arguments
+//	argv: The arguments, starting with the program name
+//	options: The options which can be given
+//	numOptions: The number of options in the table
+void ParseCommandLine(int argc, char** argv, const CommandOption* options, int numOptions)
+{
+	for (int i = 1; i < argc; i++)
+	{
+		const CommandOption* option = nullptr;
+		for (int j = 0; j < numOptions && option == nullptr; j++)
+			if (strcmp(argv[i], options[j].name) == 0)
+				option = &options[j];
+
+		if (option == nullptr)
+		{
+			std::cout << "Unknown argument: " << argv[i] << std::endl;
+			continue;
+		}
+
+		if (option->type == OPTION_FLAG)
+		{
+			*(bool*)option->value = true;
+			continue;
+		}
+		if (option->type == OPTION_CHOICE)
+		{
+			*(int*)option->value = option->choice;
+			continue;
+		}
+
+		if (i + 1 >= argc)
+		{
+			std::cout << "Missing value for " << argv[i] << std::endl;
+			continue;
+		}
+		const char* value = argv[++i];
+		if (option->type == OPTION_INT)
+			*(int*)option->value = atoi(value);
+		else if (option->type == OPTION_STRING)
+			*(std::string*)option->value = value;
+		else
+			((std::vector<std::string>*)option->value)->push_back(value);
+	}
 }
 
 #pragma endregion util_Functions
 
 
-void main()
+int main(int argc, char** argv)
 {
+	//Headless options
+	int sweepChoice = SWEEP_NONE;
+	int numThreads = 0;
+	int packetSize = 1024;
+	int samplesPerTrajectory = 1000;
+	int nearestCount = 100;
+	int numWorlds = 0;
+	int numIdleWorlds = 0;
+	int numFrames = 600;
+	std::string serveSocket;
+	std::string querySocket;
+	int queryPoints = 1000;
+	std::string serveRegion;
+	std::string telemetryName;
+	std::string queryRegion;
+	std::string generateFile;
+	std::string sceneFile;
+	std::string recordFile;
+	std::string replayFile;
+	std::string kernelName;
+	std::string pageMode;
+	std::string distributionName;
+	std::string motionName;
+	std::vector<std::string> shapeNames;
+	SweepSettings sweep;
+	ScenarioSettings &scenario = sweep.scenario;
+
+	//A point or plane count given on the command line replaces that axis of a sweep
+	int numPoints = -1;
+	int numPlanes = -1;
+	int seed = (int)scenario.seed;
+
+	CommandOption options[] =
+	{
+		{ "--record", OPTION_STRING, &recordFile, 0 },
+		{ "--replay", OPTION_STRING, &replayFile, 0 },
+		{ "--max-frames-in-flight", OPTION_INT, &latencyTracker.maxFramesInFlight, 0 },
+		{ "--sweep", OPTION_CHOICE, &sweepChoice, SWEEP_SCALING },
+		{ "--translation-sweep", OPTION_CHOICE, &sweepChoice, SWEEP_TRANSLATION },
+		{ "--rotation-sweep", OPTION_CHOICE, &sweepChoice, SWEEP_ROTATION },
+		{ "--tree-sweep", OPTION_CHOICE, &sweepChoice, SWEEP_TREE },
+		{ "--packet-sweep", OPTION_CHOICE, &sweepChoice, SWEEP_PACKET },
+		{ "--event-sweep", OPTION_CHOICE, &sweepChoice, SWEEP_EVENT },
+		{ "--trajectory-sweep", OPTION_CHOICE, &sweepChoice, SWEEP_TRAJECTORY },
+		{ "--shape-sweep", OPTION_CHOICE, &sweepChoice, SWEEP_SHAPE },
+		{ "--hull-sweep", OPTION_CHOICE, &sweepChoice, SWEEP_HULL },
+		{ "--nearest-sweep", OPTION_CHOICE, &sweepChoice, SWEEP_NEAREST },
+		{ "--numa-sweep", OPTION_CHOICE, &sweepChoice, SWEEP_NUMA },
+		{ "--page-sweep", OPTION_CHOICE, &sweepChoice, SWEEP_PAGE },
+		{ "--streaming-sweep", OPTION_CHOICE, &sweepChoice, SWEEP_STREAMING },
+		{ "--layer-sweep", OPTION_CHOICE, &sweepChoice, SWEEP_LAYER },
+		{ "--pair-cache-sweep", OPTION_CHOICE, &sweepChoice, SWEEP_PAIR_CACHE },
+		{ "--threads", OPTION_INT, &numThreads, 0 },
+		{ "--packet-size", OPTION_INT, &packetSize, 0 },
+		{ "--samples", OPTION_INT, &samplesPerTrajectory, 0 },
+		{ "--k", OPTION_INT, &nearestCount, 0 },
+		{ "--kernel", OPTION_STRING, &kernelName, 0 },
+		{ "--huge-pages", OPTION_STRING, &pageMode, 0 },
+		{ "--worlds", OPTION_INT, &numWorlds, 0 },
+		{ "--idle-worlds", OPTION_INT, &numIdleWorlds, 0 },
+		{ "--frames", OPTION_INT, &numFrames, 0 },
+		{ "--serve", OPTION_STRING, &serveSocket, 0 },
+		{ "--query", OPTION_STRING, &querySocket, 0 },
+		{ "--telemetry", OPTION_STRING, &telemetryName, 0 },
+		{ "--serve-shm", OPTION_STRING, &serveRegion, 0 },
+		{ "--query-shm", OPTION_STRING, &queryRegion, 0 },
+		{ "--query-points", OPTION_INT, &queryPoints, 0 },
+		{ "--shape", OPTION_STRING_LIST, &shapeNames, 0 },
+		{ "--generate", OPTION_STRING, &generateFile, 0 },
+		{ "--scene", OPTION_STRING, &sceneFile, 0 },
+		{ "--points", OPTION_INT, &numPoints, 0 },
+		{ "--planes", OPTION_INT, &numPlanes, 0 },
+		{ "--distribution", OPTION_STRING, &distributionName, 0 },
+		{ "--motion", OPTION_STRING, &motionName, 0 },
+		{ "--finite", OPTION_FLAG, &scenario.finitePlanes, 0 },
+		{ "--seed", OPTION_INT, &seed, 0 },
+		{ "--layers", OPTION_INT, &scenario.numLayers, 0 }
+	};
+	ParseCommandLine(argc, argv, options, sizeof(options) / sizeof(options[0]));
+
+	//Check for input recording or replay
+	if (!recordFile.empty())
+	{
+		inputMode = INPUT_RECORD;
+		inputLogFile = recordFile;
+	}
+	if (!replayFile.empty())
+	{
+		inputMode = INPUT_REPLAY;
+		inputLogFile = replayFile;
+	}
+
+	//Apply the options which name a setting
+	if (!kernelName.empty())
+	{
+		ClassifyKernel kernel;
+		if (ParseClassifyKernel(kernelName, kernel)) SetClassifyKernel(kernel);
+		else std::cout << "Unknown kernel: " << kernelName << std::endl;
+	}
+	if (!pageMode.empty())
+	{
+		LargePageMode mode;
+		if (ParseLargePages(pageMode.c_str(), mode)) SetLargePages(mode);
+		else std::cout << "Unknown page mode: " << pageMode << std::endl;
+	}
+
+	if (!distributionName.empty() && !ParseDistribution(distributionName, scenario.distribution))
+		std::cout << "Unknown distribution: " << distributionName << std::endl;
+	if (!motionName.empty() && !ParseMotion(motionName, scenario.motion))
+		std::cout << "Unknown motion: " << motionName << std::endl;
+
+	std::vector<ShapeType> shapeTypes;
+	for (size_t i = 0; i < shapeNames.size(); i++)
+	{
+		ShapeType type;
+		if (ParseShapeType(shapeNames[i], type)) shapeTypes.push_back(type);
+		else std::cout << "Unknown shape: " << shapeNames[i] << std::endl;
+	}
+
+	scenario.seed = (unsigned int)seed;
+	if (numPoints >= 0)
+	{
+		scenario.numPoints = numPoints;
+		sweep.pointCounts.assign(1, numPoints);
+	}
+	if (numPlanes >= 0)
+	{
+		scenario.numPlanes = numPlanes;
+		sweep.planeCounts.assign(1, numPlanes);
+	}
+
+	//Share the live counters before anything starts counting
+	if (!telemetryName.empty() && OpenTelemetry(telemetryName))
+		std::cout << "Publishing telemetry as " << telemetryName << std::endl;
+
+	//Headless runs never open a window
+	if (!generateFile.empty())
+	{
+		Scene scene;
+		GenerateScene(scenario, scene);
+		return SaveScene(scene, generateFile) ? 0 : 1;
+	}
+	if (!sceneFile.empty())
+	{
+		Scene scene;
+		if (!LoadScene(scene, sceneFile)) return 1;
+		PrintTimingHeader(std::cout);
+		PrintSceneTiming(std::cout, scene, TimeScene(scene, sweep.numSteps, sweep.dt));
+		return 0;
+	}
+	if (sweepChoice == SWEEP_HULL)
+	{
+		RunHullSweep(10000, rotationSpeed, scenario.seed, std::cout);
+		return 0;
+	}
+	if (!serveSocket.empty())
+	{
+		ThreadPool pool(numThreads);
+		QueryServer server;
+		if (!server.Start(serveSocket, &pool)) return 1;
+
+		//Ctrl+C stops the server cleanly, so the socket file is removed
+		activeServer = &server;
+		signal(SIGINT, StopServer);
+		std::cout << "Serving queries on " << serveSocket << std::endl;
+		server.Run();
+		server.PrintSummary(std::cout);
+		server.Stop();
+		return 0;
+	}
+	if (!serveRegion.empty())
+	{
+		//Up to 16 clients, each with 64MB of queries in flight
+		ThreadPool pool(numThreads);
+		SharedQueryServer server;
+		if (!server.Create(serveRegion, 16, 64 << 20, &pool)) return 1;
+
+		activeSharedServer = &server;
+		signal(SIGINT, StopServer);
+		std::cout << "Serving queries in shared memory " << serveRegion << std::endl;
+		server.Run();
+		server.PrintSummary(std::cout);
+		server.Stop();
+		return 0;
+	}
+	if (!queryRegion.empty())
+		return RunSharedQuerySweep(sweep, queryRegion, queryPoints, std::cout) ? 0 : 1;
+	if (!querySocket.empty())
+		return RunQuerySweep(sweep, querySocket, queryPoints, std::cout) ? 0 : 1;
+	if (numWorlds > 0)
+	{
+		ThreadPool pool(numThreads);
+		RunWorldSweep(sweep, numWorlds, numIdleWorlds, numFrames, &pool, std::cout);
+		return 0;
+	}
+	if (sweepChoice != SWEEP_NONE)
+	{
+		switch (sweepChoice)
+		{
+		case SWEEP_SCALING:
+			RunScalingSweep(sweep, std::cout);
+			break;
+		case SWEEP_TRANSLATION:
+			RunTranslationSweep(sweep, movementSpeed, std::cout);
+			break;
+		case SWEEP_ROTATION:
+			RunRotationSweep(sweep, rotationSpeed, 2, std::cout);
+			break;
+		case SWEEP_PACKET:
+			RunPacketSweep(sweep, packetSize, std::cout);
+			break;
+		case SWEEP_EVENT:
+			RunEventSweep(sweep, std::cout);
+			break;
+		case SWEEP_PAGE:
+			RunPageSweep(sweep, std::cout);
+			break;
+		case SWEEP_STREAMING:
+			RunStreamingSweep(sweep, std::cout);
+			break;
+		case SWEEP_LAYER:
+			RunLayerSweep(sweep, std::cout);
+			break;
+		case SWEEP_SHAPE:
+			if (shapeTypes.empty())
+			{
+				ShapeType allTypes[] = { SHAPE_SPHERE, SHAPE_BOX, SHAPE_ORIENTED_BOX, SHAPE_CAPSULE };
+				shapeTypes.assign(allTypes, allTypes + 4);
+			}
+			RunShapeSweep(sweep, shapeTypes, std::cout);
+			break;
+		default:
+		{
+			//Only the sweeps which split their work between threads start a pool
+			ThreadPool pool(numThreads);
+			if (sweepChoice == SWEEP_TREE)
+				RunTreeSweep(sweep, &pool, std::cout);
+			else if (sweepChoice == SWEEP_TRAJECTORY)
+				RunTrajectorySweep(sweep, samplesPerTrajectory, &pool, std::cout);
+			else if (sweepChoice == SWEEP_NUMA)
+				RunNumaSweep(sweep, &pool, std::cout);
+			else if (sweepChoice == SWEEP_PAIR_CACHE)
+				RunPairCacheSweep(sweep, &pool, std::cout);
+			else
+				RunNearestSweep(sweep, nearestCount, &pool, std::cout);
+			break;
+		}
+		}
+		return 0;
+	}
+
+	if (inputMode == INPUT_REPLAY && !inputLog.Load(inputLogFile))
+		return 1;
+
 	glfwInit();
 
 	// Creates a window
@@ -458,6 +936,7 @@ void main()
 
 	// Initializes most things needed before the main loop
 	init();
+	latencyTracker.Init();
 
 
 
@@ -472,19 +951,15 @@ void main()
 
 	plane = new struct Mesh(6, planeVerts, GL_TRIANGLES);
 
-	//Translate the plane
-	plane->translation = glm::translate(plane->translation, glm::vec3(0.15f, 0.0f, 0.0f));
-
 	//Generate point mesh
 	struct Vertex pointVert = { 0.0f, 0.0f, 0.0f, 1.0f, 1.0f, 0.0f, 1.0f };
 
 	point = new struct Mesh(1, &pointVert, GL_POINTS);
 
-	//Translate the plane
-	point->translation = glm::translate(point->translation, glm::vec3(-0.15f, 0.0f, 0.0f));
-
-	//Set the selected shape
-	selectedShape = plane;
+	//Create the world, which translates the plane and point apart and selects the plane
+	world = new struct World();
+	world->movementSpeed = movementSpeed;
+	world->rotationSpeed = rotationSpeed;
 
 	//Generate plane collider
 
@@ -495,28 +970,106 @@ void main()
 
 	glm::vec3 normal = glm::normalize(glm::cross(edge1, edge2));
 
-	planeCollider = new struct Plane(normal);
+	world->planeCollider = Plane(normal);
 
 	//Print controls
 	std::cout << "Use WASD to move the selected shape in the XY plane.\nUse left CTRL & left shift to move the selected shape along Z axis.\n";
 	std::cout << "Left click and drag the mouse to rotate the selected shape.\nUse spacebar to swap the selected shape.\n";
+	std::cout << "Press F2 to toggle the frame time overlay and F3 to write the frame time histograms.\n";
+	std::cout << "Press F5 to save a snapshot (F6 to save it compressed) and F9 to restore it.\n";
+
+	//Create the frame time overlay
+	overlay = new struct TextOverlay();
+	std::vector<std::string> overlayLines;
+
+	recordStartTime = glfwGetTime();
 
 	// Enter the main loop.
 	while (!glfwWindowShouldClose(window))
 	{
+		//A replay runs one fixed step per recorded frame, then stops
+		if (inputMode == INPUT_REPLAY)
+		{
+			if (currentFrame >= inputLog.numFrames) break;
+			ReplayInput();
+		}
+
+		//Tag this frame with any pending input, and wait for the GPU if it is too far behind
+		latencyTracker.BeginFrame();
+
+		std::chrono::high_resolution_clock::time_point frameStart = std::chrono::high_resolution_clock::now();
+
 		// Call to update() which will update the gameobjects.
 		update();
 
+		std::chrono::high_resolution_clock::time_point updateEnd = std::chrono::high_resolution_clock::now();
+
 		// Call the render function.
 		renderScene();
 
+		std::chrono::high_resolution_clock::time_point renderEnd = std::chrono::high_resolution_clock::now();
+
 		// Swaps the back buffer to the front buffer
 		glfwSwapBuffers(window);
 
+		std::chrono::high_resolution_clock::time_point swapEnd = std::chrono::high_resolution_clock::now();
+
+		//Mark when the GPU finishes this frame
+		latencyTracker.EndFrame();
+
+		frameStats.Record(SecondsBetween(frameStart, updateEnd), SecondsBetween(updateEnd, renderEnd), SecondsBetween(renderEnd, swapEnd));
+		telemetry->RecordFrame(NanosecondsBetween(frameStart, updateEnd), NanosecondsBetween(updateEnd, renderEnd), NanosecondsBetween(renderEnd, swapEnd));
+
+		//Refresh the overlay a few times a second so it can be read
+		if (showOverlay && currentFrame % 30 == 0)
+		{
+			frameStats.OverlayLines(overlayLines);
+			if (latencyTracker.available)
+				overlayLines.push_back(OverlayLine("LAT", latencyTracker.latency));
+			overlay->SetText(overlayLines, -0.97f, 0.97f, glm::vec4(1.0f, 1.0f, 1.0f, 1.0f));
+		}
+
+		if (inputMode != INPUT_LIVE)
+		{
+			frameTimings.update.push_back(SecondsBetween(frameStart, updateEnd));
+			frameTimings.render.push_back(SecondsBetween(updateEnd, renderEnd));
+			frameTimings.swap.push_back(SecondsBetween(renderEnd, swapEnd));
+		}
+
+		//Events polled now are consumed by the next frame
+		currentFrame++;
+
 		// Checks to see if any events are pending and then processes them.
 		glfwPollEvents();
 	}
 
+	//Report how the recorded or replayed session performed
+	if (inputMode != INPUT_LIVE)
+	{
+		if (inputMode == INPUT_RECORD)
+		{
+			inputLog.numFrames = currentFrame;
+			if (inputLog.Save(inputLogFile))
+				std::cout << "Recorded " << inputLog.events.size() << " events over " << currentFrame << " frames to " << inputLogFile << std::endl;
+		}
+
+		SimulationState finalState;
+		world->CaptureState(finalState);
+
+		frameTimings.PrintSummary();
+		frameTimings.SaveCSV(inputLogFile + ".frames.csv");
+		std::cout << "Final state hash: " << std::hex << HashState(finalState) << std::dec << std::endl;
+	}
+
+	frameStats.PrintSummary(std::cout);
+	frameStats.Dump(histogramFile);
+
+	//Measure the frames still on the GPU before reporting latency
+	while (!latencyTracker.inFlight.empty())
+		latencyTracker.Poll(true);
+	latencyTracker.PrintSummary(std::cout);
+	latencyTracker.Shutdown();
+
 	// After the program is over, cleanup your data!
 	glDeleteShader(vertex_shader);
 	glDeleteShader(fragment_shader);
@@ -525,8 +1078,13 @@ void main()
 	delete plane;
 	delete point;
 
-	delete planeCollider;
+	delete world;
+	delete overlay;
+
+	CloseTelemetry();
 
 	// Frees up GLFW memory
 	glfwTerminate();
+
+	return 0;
 }
\ No newline at end of file